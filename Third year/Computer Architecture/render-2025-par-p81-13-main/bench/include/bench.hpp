@@ -0,0 +1,50 @@
+#ifndef RENDER_BENCH_HPP
+#define RENDER_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <vector>
+
+namespace bench {
+
+  // Mide el tiempo de pared (en segundos) que tarda en ejecutarse f()
+  template <typename F>
+  double time_seconds(F && f) {
+    auto const start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  // Semilado del cubo centrado en el origen que ocupan las escenas sintéticas
+  constexpr double scene_extent = 10.0;
+
+  // Escena sintética con n objetos (2/3 esferas, 1/3 cilindros) en el cubo de la escena. El
+  // tamaño de los objetos decrece con n para que la fracción de volumen ocupada sea constante.
+  void random_scene(Scene & scene, std::size_t n, std::uint64_t seed);
+  // Escena de ejemplo: esferas mate y metálica sobre un suelo grande y un cilindro metálico
+  void example_scene(Scene & scene);
+  // Rayos que parten de puntos alejados de la escena (como una cámara) hacia puntos aleatorios
+  // del cubo
+  std::vector<render::ray> random_rays(std::size_t n, std::uint64_t seed);
+
+  // Benchmarks disponibles
+  void bench_adaptive();
+  void bench_bounces();
+  void bench_bvh();
+  void bench_bvh_build();
+  void bench_bvh4();
+  void bench_image();
+  void bench_kernels();
+  void bench_packets();
+  void bench_postprocess();
+  void bench_rng();
+  void bench_sampler();
+  void bench_shading();
+
+}  // namespace bench
+
+#endif
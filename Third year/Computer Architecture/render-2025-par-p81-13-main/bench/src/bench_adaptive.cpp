@@ -0,0 +1,83 @@
+#include <bench.hpp>
+#include <camera.hpp>
+#include <cmath>
+#include <config.hpp>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <pixel.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+
+namespace bench {
+
+  namespace {
+
+    // Error cuadrático medio (raíz) de dos imágenes en valores de 0 a 255
+    double rmse(ImageSOA const & a, ImageSOA const & b, int ancho, int alto) {
+      double suma = 0.0;
+      for (int fila = 0; fila < alto; ++fila) {
+        for (int col = 0; col < ancho; ++col) {
+          Pixel const p  = a.get_pixel(col, fila);
+          Pixel const q  = b.get_pixel(col, fila);
+          suma          += (p.r - q.r) * (p.r - q.r) + (p.g - q.g) * (p.g - q.g) +
+                  (p.b - q.b) * (p.b - q.b);
+        }
+      }
+      return std::sqrt(suma / (3.0 * ancho * alto));
+    }
+
+  }  // namespace
+
+  // Muestras por píxel, tiempo y error (frente a una referencia de 1024 muestras, en la imagen
+  // final de 8 bits) de la escena de ejemplo con todas las muestras y con muestreo adaptativo
+  // de distintos umbrales, y error sin muestreo adaptativo con las mismas muestras de media
+  void bench_adaptive() {
+    Scene scene;
+    example_scene(scene);
+    Config cfg;
+    cfg.image_width       = 160;
+    cfg.max_depth         = 5;
+    cfg.samples_per_pixel = 1'024;
+    render::Camera cam(cfg);
+    ImageSOA referencia(cam.ancho_imagen, cam.alto_imagen);
+    (void) render::render_image_soa(scene, cfg, cam, referencia);
+
+    cfg.samples_per_pixel    = 128;
+    cfg.adaptive_min_samples = 8;
+    // otras semillas, independientes de la referencia
+    cfg.ray_rng_seed      = 1'001;
+    cfg.material_rng_seed = 1'003;
+    double const pixeles  = static_cast<double>(cam.ancho_imagen) * cam.alto_imagen;
+    std::cout << cam.ancho_imagen << "x" << cam.alto_imagen << ", máximo "
+              << cfg.samples_per_pixel << " spp, pasadas de " << cfg.adaptive_min_samples
+              << "\n";
+    std::cout << std::setw(8) << "umbral" << std::setw(14) << "muestras/px" << std::setw(10)
+              << "s" << std::setw(10) << "RMSE" << std::setw(12) << "reducción" << std::setw(18)
+              << "RMSE spp fijas\n";
+    for (double const umbral : {0.0, 0.2, 0.1, 0.05, 0.02}) {
+      cfg.adaptive_threshold = umbral;
+      ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+      render::RenderStats stats;
+      double const t =
+          time_seconds([&] { (void) render::render_image_soa(scene, cfg, cam, img, &stats); });
+      double const spp = static_cast<double>(stats.muestras) / pixeles;
+
+      Config fijas             = cfg;
+      fijas.adaptive_threshold = 0.0;
+      fijas.samples_per_pixel  = static_cast<int>(std::lround(spp));
+      ImageSOA img_fijas(cam.ancho_imagen, cam.alto_imagen);
+      (void) render::render_image_soa(scene, fijas, cam, img_fijas);
+
+      std::cout << std::setw(8) << umbral << std::setw(14) << std::fixed << std::setprecision(1)
+                << spp << std::setw(10) << std::setprecision(3) << t << std::setw(10)
+                << rmse(img, referencia, cam.ancho_imagen, cam.alto_imagen) << std::setw(11)
+                << std::setprecision(1) << cfg.samples_per_pixel / spp << "x" << std::setw(17)
+                << std::setprecision(3)
+                << rmse(img_fijas, referencia, cam.ancho_imagen, cam.alto_imagen) << '\n';
+      std::cout.unsetf(std::ios::fixed);
+    }
+  }
+
+}  // namespace bench
@@ -0,0 +1,63 @@
+#include <bench.hpp>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector.hpp>
+
+namespace bench {
+
+  // Rebotes por muestra, tiempo y color medio de una imagen (un hilo) con la cámara dentro de la
+  // escena sintética, sin ruleta rusa y con ruleta rusa desde distintas profundidades
+  void bench_bounces() {
+    Scene scene;
+    random_scene(scene, 2'000, 11);
+    scene.build_bvh();
+    Config cfg;
+    cfg.image_width       = 160;
+    cfg.samples_per_pixel = 8;
+    cfg.max_depth         = 16;
+    cfg.camera_position   = render::vector{0.0, 0.0, -0.5 * scene_extent};
+    render::Camera cam(cfg);
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    auto const samples = static_cast<double>(cam.ancho_imagen) *
+                         static_cast<double>(cam.alto_imagen) * cfg.samples_per_pixel;
+
+    std::cout << cam.ancho_imagen << "x" << cam.alto_imagen << ", " << cfg.samples_per_pixel
+              << " spp, max_depth " << cfg.max_depth << "\n";
+    std::cout << std::setw(12) << "ruleta" << std::setw(16) << "rebotes/muestra" << std::setw(10)
+              << "s" << std::setw(12) << "color medio" << std::setw(10) << "speedup\n";
+    double base = 0.0;
+    for (int const rr : {0, 1, 2, 4}) {
+      cfg.russian_roulette_depth = rr;
+      render::RenderContext ctx{scene, cfg, cam, img};
+      render::vector suma{0.0, 0.0, 0.0};
+      double const t = time_seconds([&] {
+        for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+          for (int col = 0; col < cam.ancho_imagen; ++col) {
+            for (int s = 0; s < cfg.samples_per_pixel; ++s) {
+              render::ray const r = cam.generar_ray(fila, col, 0.0, 0.0);
+              ctx.empezar_muestra(render::indice_pixel(fila, col, cam),
+                                  static_cast<std::uint32_t>(s));
+              suma = render::vector::add(suma, render::soa_calcular_color(r, cfg.max_depth, ctx));
+            }
+          }
+        }
+      });
+      if (rr == 0) {
+        base = t;
+      }
+      std::cout << std::setw(12) << (rr == 0 ? std::string("no") : std::to_string(rr))
+                << std::setw(16) << std::fixed << std::setprecision(3)
+                << static_cast<double>(ctx.rebotes) / samples << std::setw(10) << t
+                << std::setw(12) << (suma.x + suma.y + suma.z) / (3.0 * samples) << std::setw(9)
+                << std::setprecision(2) << base / t << '\n';
+    }
+  }
+
+}  // namespace bench
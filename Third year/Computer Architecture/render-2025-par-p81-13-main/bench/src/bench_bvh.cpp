@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <array>
+#include <bench.hpp>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <vector>
+
+namespace bench {
+
+  // Coste por rayo del recorrido lineal frente a la BVH al crecer la escena: el lineal crece con
+  // N y la BVH con log(N), por eso se muestran ambos normalizados
+  void bench_bvh() {
+    std::array<std::size_t, 5> const sizes{100, 1'000, 10'000, 100'000, 1'000'000};
+    std::cout << std::setw(9) << "N" << std::setw(12) << "build ms" << std::setw(14)
+              << "lineal ns" << std::setw(12) << "ns/N" << std::setw(12) << "bvh ns"
+              << std::setw(14) << "ns/log2(N)" << std::setw(9) << "hits\n";
+    for (std::size_t const n : sizes) {
+      Scene scene;
+      random_scene(scene, n, 2'025);
+      double const build_s = time_seconds([&] { scene.build_bvh(); });
+
+      auto const rays = random_rays(20'000, 7);
+      std::size_t hits_bvh = 0;
+      double const bvh_s   = time_seconds([&] {
+        for (auto const & r : rays) {
+          hits_bvh += scene.intersect(r).has_value() ? 1U : 0U;
+        }
+      });
+      double const bvh_ns = 1e9 * bvh_s / static_cast<double>(rays.size());
+
+      // el recorrido lineal se limita a pocos rayos en las escenas grandes
+      std::size_t const linear_rays = std::max<std::size_t>(20, 2'000'000 / n);
+      double const lin_s            = time_seconds([&] {
+        for (std::size_t i = 0; i < linear_rays and i < rays.size(); ++i) {
+          (void) scene.intersect_linear(rays[i]);
+        }
+      });
+      double const lin_ns =
+          1e9 * lin_s / static_cast<double>(std::min(linear_rays, rays.size()));
+
+      std::cout << std::setw(9) << n << std::setw(12) << std::fixed << std::setprecision(2)
+                << 1e3 * build_s << std::setw(14) << std::setprecision(0) << lin_ns
+                << std::setw(12) << std::setprecision(3) << lin_ns / static_cast<double>(n)
+                << std::setw(12) << std::setprecision(0) << bvh_ns << std::setw(14)
+                << std::setprecision(1) << bvh_ns / std::log2(static_cast<double>(n))
+                << std::setw(8) << hits_bvh << '\n';
+    }
+  }
+
+}  // namespace bench
@@ -0,0 +1,53 @@
+#include <accelerator.hpp>
+#include <array>
+#include <bench.hpp>
+#include <bvh.hpp>
+#include <bvh4.hpp>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <utility>
+
+namespace bench {
+
+  // BVH binaria frente a BVH4: nodos visitados y primitivas probadas por rayo, y rayos por
+  // segundo. La BVH4 visita menos nodos (más anchos) y prueba sus cuatro cajas con una sola
+  // pasada SIMD.
+  void bench_bvh4() {
+    std::array<std::size_t, 3> const sizes{10'000, 100'000, 1'000'000};
+    std::array<std::pair<char const *, render::Accelerator>, 2> const accels = {
+      {{"bvh2", render::Accelerator::bvh2}, {"bvh4", render::Accelerator::bvh4}}
+    };
+    std::cout << "Test de hijos AVX2: " << (render::BVH4::uses_avx2() ? "sí" : "no") << '\n';
+    std::cout << std::setw(9) << "N" << std::setw(7) << "accel" << std::setw(12) << "nodos/rayo"
+              << std::setw(12) << "prims/rayo" << std::setw(10) << "Mrayos/s\n";
+    for (std::size_t const n : sizes) {
+      Scene scene;
+      random_scene(scene, n, 2'025);
+      scene.build_bvh();
+      auto const rays = random_rays(200'000, 7);
+      for (auto const & [name, accel] : accels) {
+        scene.accelerator = accel;
+        render::TraversalStats stats;
+        for (auto const & r : rays) {
+          (void) scene.intersect(r, &stats);
+        }
+        std::size_t hits = 0;
+        double const s   = time_seconds([&] {
+          for (auto const & r : rays) {
+            hits += scene.intersect(r).has_value() ? 1U : 0U;
+          }
+        });
+        auto const num_rays = static_cast<double>(rays.size());
+        std::cout << std::setw(9) << n << std::setw(7) << name << std::setw(12) << std::fixed
+                  << std::setprecision(1) << static_cast<double>(stats.nodes) / num_rays
+                  << std::setw(12) << static_cast<double>(stats.primitives) / num_rays
+                  << std::setw(9) << std::setprecision(2) << num_rays / s / 1e6 << '\n';
+        (void) hits;
+      }
+    }
+  }
+
+}  // namespace bench
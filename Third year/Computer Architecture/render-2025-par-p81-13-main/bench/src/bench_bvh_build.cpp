@@ -0,0 +1,50 @@
+#include <aabb.hpp>
+#include <algorithm>
+#include <array>
+#include <bench.hpp>
+#include <bvh.hpp>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <scene.hpp>
+#include <thread>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/global_control.h>
+
+namespace bench {
+
+  // Escalado de la construcción de la BVH con el número de hilos, frente a la construcción en
+  // serie (sin TBB)
+  void bench_bvh_build() {
+    std::array<std::size_t, 2> const sizes{100'000, 1'000'000};
+    unsigned const hw = std::max(1U, std::thread::hardware_concurrency());
+    std::cout << std::setw(9) << "N" << std::setw(9) << "hilos" << std::setw(12) << "build ms"
+              << std::setw(10) << "speedup" << '\n';
+    for (std::size_t const n : sizes) {
+      Scene scene;
+      random_scene(scene, n, 2'025);
+      std::vector<render::AABB> bounds;
+      bounds.reserve(n);
+      for (auto const & obj : scene.objects) {
+        bounds.push_back(obj->bounds());
+      }
+      render::BVH bvh;
+      bvh.build(bounds, false);
+      double const serial = bvh.build_seconds();
+      std::cout << std::setw(9) << n << std::setw(9) << "serie" << std::setw(12) << std::fixed
+                << std::setprecision(1) << 1e3 * serial << std::setw(10) << std::setprecision(2)
+                << 1.0 << '\n';
+      for (unsigned threads = 1; threads <= hw; threads *= 2) {
+        oneapi::tbb::global_control const control(
+            oneapi::tbb::global_control::max_allowed_parallelism, threads);
+        bvh.build(bounds, true);
+        std::cout << std::setw(9) << n << std::setw(9) << threads << std::setw(12)
+                  << std::setprecision(1) << 1e3 * bvh.build_seconds() << std::setw(10)
+                  << std::setprecision(2) << serial / bvh.build_seconds() << '\n';
+      }
+    }
+  }
+
+}  // namespace bench
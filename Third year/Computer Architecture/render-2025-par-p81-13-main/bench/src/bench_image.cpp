@@ -0,0 +1,68 @@
+#include <bench.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <pixel.hpp>
+#include <random>
+#include <streambuf>
+
+namespace bench {
+
+  namespace {
+
+    // Salida que descarta los bytes y sólo los cuenta, para medir el formateo sin el disco
+    class Contador : public std::streambuf {
+    public:
+      [[nodiscard]] std::size_t bytes() const noexcept { return bytes_; }
+
+    protected:
+      int_type overflow(int_type c) override {
+        ++bytes_;
+        return c;
+      }
+
+      std::streamsize xsputn(char const *, std::streamsize n) override {
+        bytes_ += static_cast<std::size_t>(n);
+        return n;
+      }
+
+    private:
+      std::size_t bytes_ = 0;
+    };
+
+  }  // namespace
+
+  // Caudal de escritura (MB/s de fichero generado, sin contar el disco) de una imagen 4K con
+  // valores aleatorios en P3 con operator<<, en P3 formateado en paralelo y en P6
+  void bench_image() {
+    constexpr int ancho = 3'840;
+    constexpr int alto  = 2'160;
+    ImageSOA img(ancho, alto);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> canal(0, 255);
+    for (int y = 0; y < alto; ++y) {
+      for (int x = 0; x < ancho; ++x) {
+        img.set_pixel(x, y, Pixel{canal(rng), canal(rng), canal(rng)});
+      }
+    }
+    std::cout << ancho << "x" << alto << '\n';
+    std::cout << std::setw(14) << "formato" << std::setw(10) << "MB" << std::setw(10) << "s"
+              << std::setw(10) << "MB/s" << '\n';
+    auto medir = [&](char const * nombre, auto escribir) {
+      Contador salida;
+      std::ostream os(&salida);
+      double const t  = time_seconds([&] { escribir(os); });
+      double const mb = static_cast<double>(salida.bytes()) / 1e6;
+      std::cout << std::setw(14) << nombre << std::fixed << std::setprecision(1) << std::setw(10)
+                << mb << std::setprecision(3) << std::setw(10) << t << std::setprecision(1)
+                << std::setw(10) << mb / t << '\n';
+      std::cout.unsetf(std::ios::fixed);
+    };
+    medir("P3", [&](std::ostream & os) { img.write_ppm_p3(os); });
+    medir("P3 paralelo", [&](std::ostream & os) { img.write_ppm_p3_parallel(os); });
+    medir("P6", [&](std::ostream & os) { img.write_ppm_p6(os); });
+  }
+
+}  // namespace bench
@@ -0,0 +1,58 @@
+#include <array>
+#include <bench.hpp>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <primitive_kernels.hpp>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <simd.hpp>
+
+namespace bench {
+
+  // Coste de los kernels de intersección por tipo de primitiva en cada nivel SIMD soportado:
+  // un rayo contra todas las primitivas del array, en ns por par rayo-primitiva
+  void bench_kernels() {
+    Scene scene;
+    random_scene(scene, 3'000, 2'025);
+    scene.compiled.build(scene.objects);
+    auto const & spheres   = scene.compiled.spheres();
+    auto const & cylinders = scene.compiled.cylinders();
+    auto const rays        = random_rays(5'000, 7);
+    std::array<render::SimdLevel, 3> const levels{
+      render::SimdLevel::scalar, render::SimdLevel::avx2, render::SimdLevel::avx512};
+
+    std::cout << std::setw(10) << "primitiva" << std::setw(9) << "nivel" << std::setw(12)
+              << "ns/prueba" << std::setw(10) << "speedup" << std::setw(8) << "hits\n";
+    auto run = [&](char const * name, std::size_t count, auto && nearest) {
+      double scalar_ns = 0.0;
+      for (auto const level : levels) {
+        if (not render::simd_supported(level)) {
+          continue;
+        }
+        std::size_t hits = 0;
+        double const s   = time_seconds([&] {
+          for (auto const & r : rays) {
+            hits += nearest(r, level).found() ? 1U : 0U;
+          }
+        });
+        double const ns = 1e9 * s / static_cast<double>(rays.size() * count);
+        if (level == render::SimdLevel::scalar) {
+          scalar_ns = ns;
+        }
+        std::cout << std::setw(10) << name << std::setw(9) << render::simd_level_name(level)
+                  << std::setw(12) << std::fixed << std::setprecision(3) << ns << std::setw(9)
+                  << std::setprecision(2) << scalar_ns / ns << "x" << std::setw(7) << hits
+                  << '\n';
+      }
+    };
+    run("esfera", spheres.size(), [&](render::ray const & r, render::SimdLevel level) {
+      return render::nearest_sphere(spheres, r, level);
+    });
+    run("cilindro", cylinders.size(), [&](render::ray const & r, render::SimdLevel level) {
+      return render::nearest_cylinder(cylinders, r, level);
+    });
+  }
+
+}  // namespace bench
@@ -0,0 +1,100 @@
+#include <accelerator.hpp>
+#include <algorithm>
+#include <bench.hpp>
+#include <bvh.hpp>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <intersection.hpp>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <ray.hpp>
+#include <ray_packet.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+  namespace {
+
+    // Primer impacto de todos los píxeles de la imagen, rayo a rayo
+    std::size_t first_hits_per_pixel(Scene const & scene, render::Camera & cam) {
+      std::size_t hits = 0;
+      for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+        for (int col = 0; col < cam.ancho_imagen; ++col) {
+          hits += scene.intersect(cam.generar_ray(fila, col, 0.0, 0.0)).has_value() ? 1U : 0U;
+        }
+      }
+      return hits;
+    }
+
+    // Primer impacto de todos los píxeles de la imagen por paquetes de lado x lado
+    std::size_t first_hits_packets(Scene const & scene, render::Camera & cam, int lado) {
+      std::size_t hits = 0;
+      std::vector<render::ray> rays;
+      std::vector<std::optional<render::Intersection>> out;
+      for (int fila0 = 0; fila0 < cam.alto_imagen; fila0 += lado) {
+        for (int col0 = 0; col0 < cam.ancho_imagen; col0 += lado) {
+          rays.clear();
+          for (int fila = fila0; fila < std::min(fila0 + lado, cam.alto_imagen); ++fila) {
+            for (int col = col0; col < std::min(col0 + lado, cam.ancho_imagen); ++col) {
+              rays.push_back(cam.generar_ray(fila, col, 0.0, 0.0));
+            }
+          }
+          out.resize(rays.size());
+          scene.intersect_packet(rays, out);
+          hits += static_cast<std::size_t>(
+              std::ranges::count_if(out, [](auto const & h) { return h.has_value(); }));
+        }
+      }
+      return hits;
+    }
+
+  }  // namespace
+
+  // Rayos primarios por paquetes frente a píxel a píxel: millones de primeros impactos por
+  // segundo (un hilo) de una imagen completa a 1080p y 4K
+  void bench_packets() {
+    Scene scene;
+    random_scene(scene, 100'000, 2'025);
+    scene.build_bvh();
+    Config cfg;
+    cfg.camera_position = render::vector{0.0, 0.0, -3.0 * scene_extent};
+    cfg.field_of_view   = 45.0;
+    std::cout << std::setw(7) << "imagen" << std::setw(14) << "modo" << std::setw(12)
+              << "Mrayos/s" << std::setw(10) << "speedup\n";
+    for (int const ancho : {1'920, 3'840}) {
+      cfg.image_width = ancho;
+      render::Camera cam(cfg);
+      auto const num_rays =
+          static_cast<double>(cam.ancho_imagen) * static_cast<double>(cam.alto_imagen);
+      char const * const label = ancho == 1'920 ? "1080p" : "4K";
+      auto report = [&](char const * modo, double s, double base) {
+        std::cout << std::setw(7) << label << std::setw(14) << modo << std::setw(12) << std::fixed
+                  << std::setprecision(2) << num_rays / s / 1e6 << std::setw(9) << base / s
+                  << '\n';
+      };
+      std::size_t ref_hits = 0;
+      scene.accelerator    = render::Accelerator::bvh2;
+      double const base =
+          time_seconds([&] { ref_hits = first_hits_per_pixel(scene, cam); });
+      report("pixel bvh2", base, base);
+      scene.accelerator = render::Accelerator::bvh4;
+      report("pixel bvh4", time_seconds([&] { (void) first_hits_per_pixel(scene, cam); }), base);
+      scene.accelerator = render::Accelerator::bvh2;
+      for (int const lado : {2, 4, 8}) {
+        std::size_t hits = 0;
+        double const s   = time_seconds([&] { hits = first_hits_packets(scene, cam, lado); });
+        std::string const modo = "paquete " + std::to_string(lado) + "x" + std::to_string(lado);
+        report(modo.c_str(), s, base);
+        if (hits != ref_hits) {
+          std::cout << "  distinto número de impactos: " << hits << " frente a " << ref_hits
+                    << '\n';
+        }
+      }
+    }
+  }
+
+}  // namespace bench
@@ -0,0 +1,100 @@
+#include <array>
+#include <bench.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <pixel.hpp>
+#include <postprocess.hpp>
+#include <random>
+#include <render-par.hpp>
+#include <simd.hpp>
+#include <tone_map.hpp>
+#include <vector>
+
+namespace bench {
+
+  // Coste por etapa del postproceso (exposición, tone mapping ACES y gamma con cuantización)
+  // de un canal de una imagen 4K con radiancias aleatorias, con un hilo y en cada nivel SIMD
+  // soportado: speedup de cada etapa frente a la escalar y de las tres juntas frente a
+  // color_pixel píxel a píxel con std::pow. Al final, quantize de la imagen en paralelo.
+  void bench_postprocess() {
+    constexpr int ancho = 3'840;
+    constexpr int alto  = 2'160;
+    constexpr auto n    = static_cast<std::size_t>(ancho) * static_cast<std::size_t>(alto);
+    AccumImageSOA acum(ancho, alto);
+    {
+      std::mt19937 rng(3);
+      std::uniform_real_distribution<float> radiancia(0.0F, 64.0F);
+      std::vector<float> r(n);
+      std::vector<float> g(n);
+      std::vector<float> b(n);
+      std::vector<std::uint32_t> const muestras(n, 32);
+      for (std::size_t i = 0; i < n; ++i) {
+        r[i] = radiancia(rng);
+        g[i] = radiancia(rng);
+        b[i] = radiancia(rng);
+      }
+      acum.set_block(0, 0, ancho, alto, ancho, r, g, b, muestras);
+    }
+    Config cfg;
+    cfg.exposure = 0.5;
+    cfg.tone_map = render::ToneMap::aces;
+    std::vector<float> color(n);
+    std::vector<std::uint8_t> niveles(n);
+
+    std::cout << ancho << "x" << alto << ", un canal, tone mapping aces\n";
+    std::cout << std::setw(12) << "etapa" << std::setw(9) << "nivel" << std::setw(12)
+              << "ns/valor" << std::setw(10) << "speedup\n";
+    auto fila = [](char const * etapa, char const * nivel, double ns, double base) {
+      std::cout << std::setw(12) << etapa << std::setw(9) << nivel << std::setw(12) << std::fixed
+                << std::setprecision(3) << ns << std::setw(9) << std::setprecision(2)
+                << base / ns << "x\n";
+      std::cout.unsetf(std::ios::fixed);
+    };
+    double const valores = static_cast<double>(n);
+    // referencia: color_pixel calcula los tres canales de cada píxel, así que se divide entre 3
+    int suma           = 0;
+    double const t_pow = time_seconds([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        Pixel const p =
+            render::color_pixel(acum.r()[i], acum.g()[i], acum.b()[i], acum.samples()[i], cfg);
+        suma += p.r + p.g + p.b;
+      }
+    });
+    double const ns_pow = 1e9 * t_pow / (3.0 * valores);
+    fila("color_pixel", "pow", ns_pow, ns_pow);
+
+    std::array<double, 3> escalar{};
+    for (auto const level :
+         {render::SimdLevel::scalar, render::SimdLevel::avx2, render::SimdLevel::avx512}) {
+      if (not render::simd_supported(level)) {
+        continue;
+      }
+      render::PostProcess const post(cfg, level);
+      std::array<double, 4> const ns{
+        1e9 * time_seconds([&] { post.expose(acum.r(), acum.samples(), color); }) / valores,
+        1e9 * time_seconds([&] { post.tone_map(color); }) / valores,
+        1e9 * time_seconds([&] { post.quantize(color, niveles); }) / valores,
+        1e9 * time_seconds([&] { post.apply(acum.r(), acum.samples(), color, niveles); }) /
+            valores};
+      if (level == render::SimdLevel::scalar) {
+        escalar = {ns[0], ns[1], ns[2]};
+      }
+      char const * nombre = render::simd_level_name(level);
+      fila("exposición", nombre, ns[0], escalar[0]);
+      fila("tone map", nombre, ns[1], escalar[1]);
+      fila("gamma", nombre, ns[2], escalar[2]);
+      fila("total", nombre, ns[3], ns_pow);
+    }
+
+    ImageSOA img(ancho, alto);
+    double const t = time_seconds([&] { render::quantize(acum, cfg, img); });
+    std::cout << "quantize (3 canales, todos los hilos): " << std::fixed << std::setprecision(1)
+              << 1e3 * t << " ms, " << 1e-6 * valores / t << " Mpx/s (suma " << suma << ")\n";
+    std::cout.unsetf(std::ios::fixed);
+  }
+
+}  // namespace bench
@@ -0,0 +1,78 @@
+#include <bench.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <philox.hpp>
+#include <random>
+#include <sampler.hpp>
+
+namespace bench {
+
+  // Coste de los generadores: números uniformes seguidos de un mismo flujo y creación de un
+  // flujo por muestra con sus dos desplazamientos de anti-aliasing, como en el render. Sobol
+  // recorre las dimensiones de una misma muestra.
+  void bench_rng() {
+    constexpr std::size_t n = std::size_t{1} << 24;
+    auto dist               = [](auto & rng) { return render::uniform_double(rng, -0.5, 0.5); };
+    double sink             = 0.0;
+
+    std::mt19937_64 mt(19);
+    double const mt_stream = time_seconds([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        sink += dist(mt);
+      }
+    });
+    render::Philox philox(19, 0, 0);
+    double const philox_stream = time_seconds([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        sink += dist(philox);
+      }
+    });
+
+    render::Sampler sobol(render::SamplerKind::sobol, 19, 0, 0);
+    double const sobol_stream = time_seconds([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        sink += dist(sobol);
+      }
+    });
+
+    constexpr std::size_t samples = n / 16;
+    double const mt_sample = time_seconds([&] {
+      for (std::size_t i = 0; i < samples; ++i) {
+        std::mt19937_64 rng(i);
+        sink += dist(rng) + dist(rng);
+      }
+    });
+    double const philox_sample = time_seconds([&] {
+      for (std::size_t i = 0; i < samples; ++i) {
+        render::Philox rng(19, i, 0);
+        sink += dist(rng) + dist(rng);
+      }
+    });
+
+    double const sobol_sample = time_seconds([&] {
+      for (std::size_t i = 0; i < samples; ++i) {
+        render::Sampler rng(render::SamplerKind::sobol, 19, i, 0);
+        sink += dist(rng) + dist(rng);
+      }
+    });
+
+    std::cout << "tamaño del estado: mt19937_64 " << sizeof(std::mt19937_64) << " B, Philox "
+              << sizeof(render::Philox) << " B, Sampler " << sizeof(render::Sampler) << " B\n";
+    std::cout << std::setw(14) << "generador" << std::setw(16) << "ns/número" << std::setw(16)
+              << "ns/muestra\n";
+    std::cout << std::setw(14) << "mt19937_64" << std::setw(15) << std::fixed
+              << std::setprecision(2) << mt_stream / n * 1e9 << std::setw(15)
+              << mt_sample / samples * 1e9 << '\n';
+    std::cout << std::setw(14) << "Philox" << std::setw(15) << philox_stream / n * 1e9
+              << std::setw(15) << philox_sample / samples * 1e9 << '\n';
+    std::cout << std::setw(14) << "Sobol" << std::setw(15) << sobol_stream / n * 1e9
+              << std::setw(15) << sobol_sample / samples * 1e9 << '\n';
+    // evita que el compilador elimine los bucles
+    if (sink == 0.123) {
+      std::cout << sink << '\n';
+    }
+  }
+
+}  // namespace bench
@@ -0,0 +1,152 @@
+#include <array>
+#include <bench.hpp>
+#include <camera.hpp>
+#include <cmath>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <ray.hpp>
+#include <render-par.hpp>
+#include <sampler.hpp>
+#include <scene.hpp>
+#include <string>
+#include <utility>
+#include <vector.hpp>
+#include <vector>
+
+namespace bench {
+
+  namespace {
+
+    // Color lineal (sin gamma ni cuantización) de cada píxel con un hilo, con las mismas
+    // muestras que calcular_pixel_soa
+    std::vector<render::vector> render_lineal(Scene const & scene, Config const & cfg) {
+      render::Camera cam(cfg);
+      ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+      render::RenderContext ctx{scene, cfg, cam, img};
+      std::vector<render::vector> pixeles;
+      for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+        for (int col = 0; col < cam.ancho_imagen; ++col) {
+          std::uint64_t const pixel = render::indice_pixel(fila, col, cam);
+          render::vector suma{0.0, 0.0, 0.0};
+          for (int s = 0; s < cfg.samples_per_pixel; ++s) {
+            auto const muestra = static_cast<std::uint32_t>(s);
+            double u           = 0.0;
+            double v           = 0.0;
+            render::desplazamiento_muestra(pixel, muestra, cfg, u, v);
+            ctx.empezar_muestra(pixel, muestra);
+            suma = render::vector::add(
+                suma, render::soa_calcular_color(cam.generar_ray(fila, col, u, v), cfg.max_depth,
+                                                 ctx));
+          }
+          pixeles.push_back(render::vector::divd(suma, cfg.samples_per_pixel));
+        }
+      }
+      return pixeles;
+    }
+
+    // Error cuadrático medio (raíz) entre dos imágenes lineales
+    double rmse(std::vector<render::vector> const & a, std::vector<render::vector> const & b) {
+      double suma = 0.0;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+        render::vector const d = render::vector::sub(a[i], b[i]);
+        suma                  += render::vector::dotp(d, d);
+      }
+      return std::sqrt(suma / (3.0 * static_cast<double>(a.size())));
+    }
+
+    struct Medida {
+      double t;
+      double error;
+    };
+
+    // Error de la curva (tiempo, error) interpolado en escala logarítmica en el tiempo t, o -1 si
+    // t queda fuera de la curva
+    double error_en(std::vector<Medida> const & curva, double t) {
+      for (std::size_t i = 0; i + 1 < curva.size(); ++i) {
+        if (curva[i].t <= t and t <= curva[i + 1].t) {
+          double const f = std::log(t / curva[i].t) / std::log(curva[i + 1].t / curva[i].t);
+          return std::exp(std::log(curva[i].error) +
+                          f * (std::log(curva[i + 1].error) - std::log(curva[i].error)));
+        }
+      }
+      return -1.0;
+    }
+
+    void escena_ejemplo(Scene & scene, Config & cfg) {
+      example_scene(scene);
+      cfg.max_depth = 5;
+    }
+
+    // Escena sintética con la cámara dentro, como en bench_bounces
+    void escena_sintetica(Scene & scene, Config & cfg) {
+      random_scene(scene, 2'000, 11);
+      scene.build_bvh();
+      cfg.max_depth       = 8;
+      cfg.camera_position = render::vector{0.0, 0.0, -0.5 * scene_extent};
+    }
+
+  }  // namespace
+
+  // Comparación a igual tiempo de los muestreadores aleatorio y Sobol: error (RMSE del color
+  // lineal) frente a una referencia de 4096 muestras por píxel, con las dos curvas de error
+  // interpoladas al tiempo de cada render aleatorio
+  void bench_sampler() {
+    constexpr std::array<int, 7> muestras{1, 2, 4, 8, 16, 32, 64};
+    constexpr int muestras_referencia = 4'096;
+    using Preparar                    = void (*)(Scene &, Config &);
+    std::array<std::pair<char const *, Preparar>, 2> const escenas{
+      {{"ejemplo", escena_ejemplo}, {"sintética", escena_sintetica}}
+    };
+    for (auto const & [nombre, preparar] : escenas) {
+      Scene scene;
+      Config cfg;
+      cfg.image_width = 32;
+      preparar(scene, cfg);
+      // referencia con otras semillas, independiente de las imágenes medidas
+      Config ref_cfg            = cfg;
+      ref_cfg.sampler           = render::SamplerKind::sobol;
+      ref_cfg.samples_per_pixel = muestras_referencia;
+      ref_cfg.ray_rng_seed      = 1'001;
+      ref_cfg.material_rng_seed = 1'003;
+      std::vector<render::vector> const referencia = render_lineal(scene, ref_cfg);
+
+      std::array<std::vector<Medida>, 2> curvas;
+      for (auto const kind : {render::SamplerKind::random, render::SamplerKind::sobol}) {
+        for (int const spp : muestras) {
+          cfg.sampler           = kind;
+          cfg.samples_per_pixel = spp;
+          std::vector<render::vector> img;
+          double const t = time_seconds([&] { img = render_lineal(scene, cfg); });
+          curvas.at(static_cast<std::size_t>(kind)).push_back({t, rmse(img, referencia)});
+        }
+      }
+
+      std::cout << nombre << " (" << cfg.image_width << " px de ancho, referencia "
+                << muestras_referencia << " spp)\n";
+      std::cout << std::setw(6) << "spp" << std::setw(10) << "s rand" << std::setw(12)
+                << "RMSE rand" << std::setw(10) << "s sobol" << std::setw(12) << "RMSE sobol"
+                << std::setw(20) << "RMSE sobol mismo t" << std::setw(10) << "ganancia\n";
+      for (std::size_t i = 0; i < muestras.size(); ++i) {
+        Medida const & r   = curvas[0][i];
+        Medida const & s   = curvas[1][i];
+        double const igual = error_en(curvas[1], r.t);
+        std::cout << std::setw(6) << muestras.at(i) << std::fixed << std::setprecision(4)
+                  << std::setw(10) << r.t << std::setprecision(5) << std::setw(12) << r.error
+                  << std::setprecision(4) << std::setw(10) << s.t << std::setprecision(5)
+                  << std::setw(12) << s.error;
+        if (igual > 0.0) {
+          // cociente de errores cuadráticos: cuántas veces más muestras necesita el aleatorio
+          std::cout << std::setw(20) << igual << std::setprecision(2) << std::setw(9)
+                    << (r.error * r.error) / (igual * igual) << '\n';
+        } else {
+          std::cout << std::setw(20) << "-" << std::setw(9) << "-" << '\n';
+        }
+      }
+    }
+  }
+
+}  // namespace bench
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <bench.hpp>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <iomanip>
+#include <iostream>
+#include <material.hpp>
+#include <memory>
+#include <pixel.hpp>
+#include <random>
+#include <sampler.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <string>
+#include <vector.hpp>
+#include <vector>
+#include <wavefront.hpp>
+
+namespace bench {
+
+  namespace {
+
+    // Materiales de los tres tipos, 16 de cada uno
+    std::vector<std::unique_ptr<Material>> many_materials() {
+      std::vector<std::unique_ptr<Material>> materials;
+      for (int i = 0; i < 16; ++i) {
+        double const k = 0.3 + 0.04 * i;
+        materials.push_back(std::make_unique<Matte>("matte" + std::to_string(i),
+                                                    render::vector{k, 0.5, 1.0 - k}));
+        materials.push_back(std::make_unique<Metal>("metal" + std::to_string(i),
+                                                    render::vector{0.9, k, 0.5}, 0.05 * i));
+        materials.push_back(
+            std::make_unique<Refractive>("glass" + std::to_string(i), 1.1 + 0.05 * i));
+      }
+      return materials;
+    }
+
+    // Imagen completa con el motor wavefront y cada etapa de sombreado, con la cámara dentro de
+    // una escena de esferas con un material cualquiera de many_materials cada una
+    void render_many_materials() {
+      Scene scene;
+      std::vector<std::string> names;
+      for (auto & m : many_materials()) {
+        names.push_back(m->name);
+        scene.materials[names.back()] = std::move(m);
+      }
+      std::mt19937_64 gen(7);
+      std::uniform_real_distribution<double> pos(-scene_extent, scene_extent);
+      std::uniform_real_distribution<double> rad(0.3, 1.2);
+      std::uniform_int_distribution<std::size_t> pick(0, names.size() - 1);
+      for (int i = 0; i < 600; ++i) {
+        scene.objects.push_back(std::make_unique<render::Sphere>(
+            render::vector{pos(gen), pos(gen), pos(gen)}, rad(gen), names[pick(gen)]));
+      }
+      scene.build_bvh();
+      Config cfg;
+      cfg.image_width       = 320;
+      cfg.samples_per_pixel = 8;
+      cfg.max_depth         = 8;
+      cfg.camera_position   = render::vector{0.0, 0.0, -0.5 * scene_extent};
+      render::Camera cam(cfg);
+      ImageSOA binned(cam.ancho_imagen, cam.alto_imagen);
+      ImageSOA per_hit(cam.ancho_imagen, cam.alto_imagen);
+      render::RenderStats stats;
+      double const t_per_hit = time_seconds([&] {
+        render::render_image_wavefront(scene, cfg, cam, per_hit, nullptr,
+                                       render::Shading::per_hit);
+      });
+      double const t_binned = time_seconds([&] {
+        render::render_image_wavefront(scene, cfg, cam, binned, &stats, render::Shading::binned);
+      });
+      bool iguales = true;
+      for (int y = 0; y < cam.alto_imagen; ++y) {
+        for (int x = 0; x < cam.ancho_imagen; ++x) {
+          iguales = iguales and binned.get_pixel(x, y) == per_hit.get_pixel(x, y);
+        }
+      }
+
+      std::cout << "\nrender wavefront de " << scene.objects.size() << " esferas con "
+                << names.size() << " materiales, " << cam.ancho_imagen << "x" << cam.alto_imagen
+                << ", " << cfg.samples_per_pixel << " spp, " << stats.rebotes.load()
+                << " rebotes\n";
+      std::cout << std::setw(22) << "sombreado" << std::setw(12) << "s" << std::setw(10)
+                << "speedup\n";
+      std::cout << std::setw(22) << "impacto a impacto" << std::setw(12) << std::fixed
+                << std::setprecision(3) << t_per_hit << std::setw(9) << std::setprecision(2)
+                << 1.0 << '\n';
+      std::cout << std::setw(22) << "agrupado por material" << std::setw(12)
+                << std::setprecision(3) << t_binned << std::setw(9) << std::setprecision(2)
+                << t_per_hit / t_binned << '\n';
+      std::cout << "imágenes iguales: " << (iguales ? "sí" : "no") << '\n';
+    }
+
+  }  // namespace
+
+  // Sombreado impacto a impacto (una llamada virtual por impacto, materiales mezclados) frente a
+  // agrupado por material (ordenación por recuento y un scatter_batch por grupo): primero sólo la
+  // dispersión sobre impactos sintéticos con muchos materiales de los tres tipos y después una
+  // imagen completa con el motor wavefront
+  void bench_shading() {
+    constexpr std::size_t num_hits = std::size_t{1} << 20;
+    std::vector<std::unique_ptr<Material>> const materials = many_materials();
+    std::mt19937_64 gen(2'025);
+    std::uniform_int_distribution<std::uint32_t> pick(
+        0, static_cast<std::uint32_t>(materials.size() - 1));
+    std::uniform_real_distribution<double> ud(-1.0, 1.0);
+    std::vector<std::uint32_t> mat(num_hits);
+    ScatterBatch hits;
+    hits.resize(num_hits);
+    for (std::size_t i = 0; i < num_hits; ++i) {
+      mat[i]        = pick(gen);
+      hits.in_x[i]  = ud(gen);
+      hits.in_y[i]  = ud(gen);
+      hits.in_z[i]  = 1.5;
+      hits.n_x[i]   = ud(gen);
+      hits.n_y[i]   = ud(gen);
+      hits.n_z[i]   = -1.5;
+    }
+
+    double const per_hit = time_seconds([&] {
+      for (std::size_t i = 0; i < num_hits; ++i) {
+        render::Sampler rng(render::SamplerKind::random, 1, i, 0);
+        auto const [dir, att] = materials[mat[i]]->scatter(
+            render::vector{hits.in_x[i], hits.in_y[i], hits.in_z[i]},
+            render::vector{hits.n_x[i], hits.n_y[i], hits.n_z[i]}, rng);
+        hits.out_x[i] = dir.x;
+        hits.out_y[i] = dir.y;
+        hits.out_z[i] = dir.z;
+        hits.att_r[i] = att.x;
+        hits.att_g[i] = att.y;
+        hits.att_b[i] = att.z;
+      }
+    });
+
+    // agrupado por bloques de impactos, como en la etapa de sombreado del motor wavefront
+    constexpr std::size_t chunk = 4'096;
+    std::vector<std::size_t> start(materials.size() + 1);
+    std::vector<std::uint32_t> order(chunk);
+    ScatterBatch batch;
+    double const binned = time_seconds([&] {
+      for (std::size_t b = 0; b < num_hits; b += chunk) {
+        std::size_t const e = std::min(num_hits, b + chunk);
+        // ordenación por recuento de los impactos del bloque por material
+        std::ranges::fill(start, 0);
+        for (std::size_t i = b; i < e; ++i) {
+          start[mat[i] + 1]++;
+        }
+        for (std::size_t m = 0; m < materials.size(); ++m) {
+          start[m + 1] += start[m];
+        }
+        std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+        for (std::size_t i = b; i < e; ++i) {
+          order[pos[mat[i]]++] = static_cast<std::uint32_t>(i);
+        }
+        // un lote por material: reunir, dispersar y devolver a su sitio
+        for (std::size_t m = 0; m < materials.size(); ++m) {
+          batch.resize(start[m + 1] - start[m]);
+          for (std::size_t j = 0; j < batch.size(); ++j) {
+            std::uint32_t const i = order[start[m] + j];
+            batch.in_x[j]         = hits.in_x[i];
+            batch.in_y[j]         = hits.in_y[i];
+            batch.in_z[j]         = hits.in_z[i];
+            batch.n_x[j]          = hits.n_x[i];
+            batch.n_y[j]          = hits.n_y[i];
+            batch.n_z[j]          = hits.n_z[i];
+            batch.rng[j]          = render::Sampler(render::SamplerKind::random, 1, i, 0);
+          }
+          materials[m]->scatter_batch(batch);
+          for (std::size_t j = 0; j < batch.size(); ++j) {
+            std::uint32_t const i = order[start[m] + j];
+            hits.out_x[i]         = batch.out_x[j];
+            hits.out_y[i]         = batch.out_y[j];
+            hits.out_z[i]         = batch.out_z[j];
+            hits.att_r[i]         = batch.att_r[j];
+            hits.att_g[i]         = batch.att_g[j];
+            hits.att_b[i]         = batch.att_b[j];
+          }
+        }
+      }
+    });
+
+    auto const n = static_cast<double>(num_hits);
+    std::cout << materials.size() << " materiales, " << num_hits << " impactos\n";
+    std::cout << std::setw(22) << "modo" << std::setw(12) << "ns/impacto" << std::setw(10)
+              << "speedup\n";
+    std::cout << std::setw(22) << "impacto a impacto" << std::setw(12) << std::fixed
+              << std::setprecision(1) << per_hit / n * 1e9 << std::setw(9) << 1.0 << '\n';
+    std::cout << std::setw(22) << "agrupado por material" << std::setw(12) << binned / n * 1e9
+              << std::setw(9) << std::setprecision(2) << per_hit / binned << '\n';
+
+    render_many_materials();
+  }
+
+}  // namespace bench
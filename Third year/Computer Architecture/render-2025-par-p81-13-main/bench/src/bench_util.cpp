@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <bench.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <material.hpp>
+#include <memory>
+#include <random>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+
+namespace bench {
+
+  void random_scene(Scene & scene, std::size_t n, std::uint64_t seed) {
+    scene.materials["bench_matte"] =
+        std::make_unique<Matte>("bench_matte", render::vector{0.6, 0.6, 0.6});
+    double const scale = std::cbrt(1'000.0 / static_cast<double>(std::max<std::size_t>(n, 1)));
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-scene_extent, scene_extent);
+    std::uniform_real_distribution<double> rad(0.1 * scale, 0.8 * scale);
+    std::uniform_real_distribution<double> axis(-1.0, 1.0);
+    scene.objects.reserve(scene.objects.size() + n);
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const c{pos(rng), pos(rng), pos(rng)};
+      if (i % 3 == 2) {
+        scene.objects.push_back(std::make_unique<render::Cylinder>(
+            c, rad(rng), render::vector::muld({axis(rng), axis(rng), axis(rng)}, 2.0 * scale),
+            "bench_matte"));
+      } else {
+        scene.objects.push_back(std::make_unique<render::Sphere>(c, rad(rng), "bench_matte"));
+      }
+    }
+  }
+
+  void example_scene(Scene & scene) {
+    scene.materials["m1"] = std::make_unique<Matte>("m1", render::vector{0.7, 0.5, 0.3});
+    scene.materials["m2"] = std::make_unique<Metal>("m2", render::vector{0.9, 0.9, 0.9}, 0.1);
+    scene.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{-2.0, 0.0, 0.0}, 3.0, "m1"));
+    scene.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{3.0, 0.0, 1.0}, 2.5, "m2"));
+    scene.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{0.0, -104.0, 0.0}, 100.0, "m1"));
+    scene.objects.push_back(std::make_unique<render::Cylinder>(
+        render::vector{0.0, 3.0, 2.0}, 1.0, render::vector{0.0, 2.0, 0.0}, "m2"));
+    scene.build_bvh();
+  }
+
+  std::vector<render::ray> random_rays(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-scene_extent, scene_extent);
+    std::uniform_real_distribution<double> eye(-2.0 * scene_extent, 2.0 * scene_extent);
+    std::vector<render::ray> rays;
+    rays.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const origin{eye(rng), eye(rng), -3.0 * scene_extent};
+      render::vector const target{pos(rng), pos(rng), pos(rng)};
+      rays.emplace_back(origin, render::vector::sub(target, origin));
+    }
+    return rays;
+  }
+
+}  // namespace bench
@@ -0,0 +1,50 @@
+#include <array>
+#include <bench.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Programa de benchmarks: ejecuta los benchmarks indicados por nombre, o todos si no se indica
+// ninguno
+int main(int argc, char * argv[]) {
+  using Bench = void (*)();
+  static std::array<std::pair<char const *, Bench>, 12> const benches = {
+    {
+     {"adaptive", bench::bench_adaptive},
+     {"bounces", bench::bench_bounces},
+     {"bvh", bench::bench_bvh},
+     {"bvh_build", bench::bench_bvh_build},
+     {"bvh4", bench::bench_bvh4},
+     {"image", bench::bench_image},
+     {"kernels", bench::bench_kernels},
+     {"packets", bench::bench_packets},
+     {"postprocess", bench::bench_postprocess},
+     {"rng", bench::bench_rng},
+     {"sampler", bench::bench_sampler},
+     {"shading", bench::bench_shading},
+     }
+  };
+  std::vector<std::string> const args(argv + 1, argv + argc);
+  bool ran = false;
+  for (auto const & [name, fn] : benches) {
+    bool selected = args.empty();
+    for (auto const & a : args) {
+      selected = selected or a == name;
+    }
+    if (selected) {
+      std::cout << "== " << name << " ==\n";
+      fn();
+      ran = true;
+    }
+  }
+  if (not ran) {
+    std::cerr << "Uso: " << argv[0] << " [benchmark...]\nBenchmarks:";
+    for (auto const & b : benches) {
+      std::cerr << ' ' << b.first;
+    }
+    std::cerr << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef RENDER_AABB_HPP
+#define RENDER_AABB_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector.hpp>
+
+namespace render {
+
+  // Caja envolvente alineada con los ejes (vacía por defecto)
+  struct AABB {
+    vector min{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+               std::numeric_limits<double>::infinity()};
+    vector max{-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+               -std::numeric_limits<double>::infinity()};
+
+    AABB() = default;
+
+    AABB(vector const & lo, vector const & hi) : min{lo}, max{hi} { }
+
+    void expand(vector const & p) noexcept {
+      min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+      max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+    }
+
+    void expand(AABB const & b) noexcept {
+      expand(b.min);
+      expand(b.max);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+      return min.x > max.x or min.y > max.y or min.z > max.z;
+    }
+
+    [[nodiscard]] vector centroid() const noexcept {
+      return {0.5 * (min.x + max.x), 0.5 * (min.y + max.y), 0.5 * (min.z + max.z)};
+    }
+
+    // Copia ensanchada con un margen relativo, para que los puntos de corte calculados con
+    // redondeo por las primitivas nunca queden fuera de su caja
+    [[nodiscard]] AABB padded() const noexcept {
+      double const scale = std::max({std::fabs(min.x), std::fabs(min.y), std::fabs(min.z),
+                                     std::fabs(max.x), std::fabs(max.y), std::fabs(max.z)});
+      double const eps   = 1e-9 * (1.0 + scale);
+      return AABB{
+        {min.x - eps, min.y - eps, min.z - eps},
+        {max.x + eps, max.y + eps, max.z + eps}
+      };
+    }
+
+    // Área de la superficie, usada como probabilidad relativa en la SAH
+    [[nodiscard]] double surface_area() const noexcept {
+      if (empty()) {
+        return 0.0;
+      }
+      double const dx = max.x - min.x;
+      double const dy = max.y - min.y;
+      double const dz = max.z - min.z;
+      return 2.0 * (dx * dy + dy * dz + dz * dx);
+    }
+
+    // Test de slabs: devuelve la distancia de entrada en [t_min, t_max] o infinito si el rayo no
+    // corta la caja. Un NaN (rayo paralelo contenido en el plano de una cara) no recorta el
+    // intervalo, así que el test es conservador.
+    [[nodiscard]] double entry(vector const & origin, vector const & inv_dir, double t_min,
+                               double t_max) const noexcept {
+      std::array<double, 3> const lo{min.x, min.y, min.z};
+      std::array<double, 3> const hi{max.x, max.y, max.z};
+      std::array<double, 3> const org{origin.x, origin.y, origin.z};
+      std::array<double, 3> const inv{inv_dir.x, inv_dir.y, inv_dir.z};
+      for (std::size_t i = 0; i < 3; ++i) {
+        double t0 = (lo[i] - org[i]) * inv[i];
+        double t1 = (hi[i] - org[i]) * inv[i];
+        if (t0 > t1) {
+          std::swap(t0, t1);
+        }
+        t_min = t0 > t_min ? t0 : t_min;
+        t_max = t1 < t_max ? t1 : t_max;
+      }
+      return t_min <= t_max ? t_min : std::numeric_limits<double>::infinity();
+    }
+  };
+
+}  // namespace render
+
+#endif
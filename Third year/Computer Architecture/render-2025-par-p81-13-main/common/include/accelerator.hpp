@@ -0,0 +1,15 @@
+#ifndef RENDER_ACCELERATOR_HPP
+#define RENDER_ACCELERATOR_HPP
+
+namespace render {
+
+  // Estructura usada por Scene::intersect para buscar el impacto más cercano
+  enum class Accelerator {
+    linear,  // recorrido de todos los objetos
+    bvh2,    // BVH binaria
+    bvh4,    // BVH de aridad 4 con test de cajas SIMD
+  };
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef RENDER_BVH_HPP
+#define RENDER_BVH_HPP
+
+#include <aabb.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ray.hpp>
+#include <vector.hpp>
+#include <vector>
+
+namespace render {
+
+  // Contadores opcionales de un recorrido, para comparar estructuras de aceleración
+  struct TraversalStats {
+    std::uint64_t nodes      = 0;
+    std::uint64_t primitives = 0;
+  };
+
+  // Nodo de la BVH aplanado en preorden: el hijo izquierdo de un nodo interior es siempre el
+  // nodo siguiente y `first` guarda el índice del hijo derecho. En las hojas `first` es el
+  // primer índice dentro de BVH::indices() y `count` el número de primitivas.
+  struct BVHNode {
+    AABB bounds;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+
+    [[nodiscard]] bool is_leaf() const noexcept { return count > 0; }
+  };
+
+  // Jerarquía de volúmenes envolventes construida con la heurística de área de superficie
+  // (SAH) sobre particiones por bins
+  class BVH {
+  public:
+    static constexpr int num_bins          = 16;
+    static constexpr std::uint32_t max_leaf = 4;
+    // a partir de esta profundidad se parte por la mediana para acotar la pila de recorrido
+    static constexpr int max_sah_depth = 64;
+
+    // Construye la jerarquía a partir de las cajas de las primitivas (el índice de cada caja es
+    // el identificador que se pasa luego al visitante de traverse). En paralelo se usan
+    // reducciones de TBB para cajas y bins y tareas para los subárboles; el árbol resultante es
+    // idéntico al de la construcción en serie.
+    void build(std::vector<AABB> const & prim_bounds, bool parallel = true);
+    void clear() noexcept;
+
+    // Tiempo de pared de la última construcción, en segundos
+    [[nodiscard]] double build_seconds() const noexcept { return build_seconds_; }
+
+    // Número de primitivas indexadas
+    [[nodiscard]] std::size_t size() const noexcept { return indices_.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+
+    [[nodiscard]] std::vector<BVHNode> const & nodes() const noexcept { return nodes_; }
+
+    [[nodiscard]] std::vector<std::uint32_t> const & indices() const noexcept { return indices_; }
+
+    // Coste SAH de la jerarquía construida (nodos interiores + primitivas), útil para comparar
+    // árboles
+    [[nodiscard]] double sah_cost() const;
+
+    // Recorre los nodos que corta el rayo en orden de cercanía y llama a visit(indice) por cada
+    // primitiva de las hojas alcanzadas. `t_max` lo actualiza el visitante con el impacto más
+    // cercano encontrado, de modo que las cajas más lejanas se descartan.
+    template <typename Visitor>
+    void traverse(ray const & r, double const & t_max, Visitor && visit,
+                  TraversalStats * stats = nullptr) const;
+
+  private:
+    std::vector<BVHNode> nodes_;
+    std::vector<std::uint32_t> indices_;
+    double build_seconds_ = 0.0;
+  };
+
+  template <typename Visitor>
+  void BVH::traverse(ray const & r, double const & t_max, Visitor && visit,
+                     TraversalStats * stats) const {
+    if (nodes_.empty()) {
+      return;
+    }
+    vector const inv_dir{1.0 / r.direction.x, 1.0 / r.direction.y, 1.0 / r.direction.z};
+    if (nodes_[0].bounds.entry(r.origin, inv_dir, 0.0, t_max) ==
+        std::numeric_limits<double>::infinity()) {
+      return;
+    }
+    // pila de nodos pendientes; la profundidad está acotada por la construcción
+    std::array<std::uint32_t, 128> stack{};
+    std::size_t top    = 0;
+    std::uint32_t node = 0;
+    while (true) {
+      BVHNode const & n = nodes_[node];
+      if (stats != nullptr) {
+        stats->nodes++;
+      }
+      if (n.is_leaf()) {
+        for (std::uint32_t i = n.first; i < n.first + n.count; ++i) {
+          visit(indices_[i]);
+        }
+        if (stats != nullptr) {
+          stats->primitives += n.count;
+        }
+      } else {
+        std::uint32_t near_child = node + 1;
+        std::uint32_t far_child  = n.first;
+        double t_near            = nodes_[near_child].bounds.entry(r.origin, inv_dir, 0.0, t_max);
+        double t_far             = nodes_[far_child].bounds.entry(r.origin, inv_dir, 0.0, t_max);
+        if (t_far < t_near) {
+          std::swap(near_child, far_child);
+          std::swap(t_near, t_far);
+        }
+        if (t_near != std::numeric_limits<double>::infinity()) {
+          if (t_far != std::numeric_limits<double>::infinity()) {
+            stack[top++] = far_child;
+          }
+          node = near_child;
+          continue;
+        }
+      }
+      // siguiente nodo pendiente que siga por delante del impacto más cercano
+      bool found = false;
+      while (top > 0) {
+        node = stack[--top];
+        if (nodes_[node].bounds.entry(r.origin, inv_dir, 0.0, t_max) !=
+            std::numeric_limits<double>::infinity()) {
+          found = true;
+          break;
+        }
+      }
+      if (not found) {
+        return;
+      }
+    }
+  }
+
+}  // namespace render
+
+#endif
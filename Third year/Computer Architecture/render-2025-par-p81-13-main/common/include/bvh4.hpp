@@ -0,0 +1,153 @@
+#ifndef RENDER_BVH4_HPP
+#define RENDER_BVH4_HPP
+
+#include <array>
+#include <bvh.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ray.hpp>
+#include <vector.hpp>
+#include <vector>
+
+namespace render {
+
+  // Nodo de una BVH de aridad 4. Las cajas de los hijos se guardan por componentes (SoA) para
+  // que un rayo se pueda probar contra los cuatro a la vez con registros AVX2 de 4 doubles.
+  // Los hijos ocupan las primeras `num_children` posiciones; cada uno es un nodo interior
+  // (count == 0) o una hoja con `count` primitivas a partir de `child` en BVH4::indices().
+  struct alignas(64) BVH4Node {
+    std::array<double, 4> min_x;
+    std::array<double, 4> min_y;
+    std::array<double, 4> min_z;
+    std::array<double, 4> max_x;
+    std::array<double, 4> max_y;
+    std::array<double, 4> max_z;
+    std::array<std::uint32_t, 4> child;
+    std::array<std::uint32_t, 4> count;
+    std::uint32_t num_children;
+  };
+
+  // Datos del rayo precalculados para el test de slabs
+  struct RayBoxData {
+    vector origin;
+    vector inv_dir;
+  };
+
+  // BVH ancha obtenida colapsando la BVH binaria, aplanada en un vector de nodos alineados
+  // a línea de caché
+  class BVH4 {
+  public:
+    static constexpr std::size_t width = 4;
+
+    void build(BVH const & binary);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return indices_.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+
+    [[nodiscard]] std::vector<BVH4Node> const & nodes() const noexcept { return nodes_; }
+
+    [[nodiscard]] std::vector<std::uint32_t> const & indices() const noexcept { return indices_; }
+
+    // Igual que BVH::traverse
+    template <typename Visitor>
+    void traverse(ray const & r, double const & t_max, Visitor && visit,
+                  TraversalStats * stats = nullptr) const;
+
+    // Prueba el rayo contra las cuatro cajas de un nodo. Devuelve una máscara con los hijos
+    // cortados en [0, t_max] y sus distancias de entrada en `t_entry`. Usa AVX2 si la CPU lo
+    // soporta y una versión escalar en otro caso.
+    static unsigned intersect_children(BVH4Node const & node, RayBoxData const & ray_data,
+                                       double t_max, std::array<double, 4> & t_entry);
+    // Indica si intersect_children usa la ruta AVX2
+    [[nodiscard]] static bool uses_avx2() noexcept;
+
+  private:
+    std::vector<BVH4Node> nodes_;
+    std::vector<std::uint32_t> indices_;
+    // raíz de un único elemento: la BVH binaria era una sola hoja
+    BVHNode root_leaf_{};
+    AABB root_bounds_{};
+
+    std::uint32_t collapse(BVH const & binary, std::uint32_t node);
+  };
+
+  template <typename Visitor>
+  void BVH4::traverse(ray const & r, double const & t_max, Visitor && visit,
+                      TraversalStats * stats) const {
+    if (nodes_.empty()) {
+      if (root_leaf_.count > 0) {
+        // la jerarquía es una sola hoja
+        for (std::uint32_t i = root_leaf_.first; i < root_leaf_.first + root_leaf_.count; ++i) {
+          visit(indices_[i]);
+        }
+        if (stats != nullptr) {
+          stats->primitives += root_leaf_.count;
+        }
+      }
+      return;
+    }
+    RayBoxData const rd{
+      r.origin, {1.0 / r.direction.x, 1.0 / r.direction.y, 1.0 / r.direction.z}
+    };
+    if (root_bounds_.entry(rd.origin, rd.inv_dir, 0.0, t_max) ==
+        std::numeric_limits<double>::infinity()) {
+      return;
+    }
+    // pila de nodos interiores pendientes con su distancia de entrada
+    std::array<std::uint32_t, 384> stack{};
+    std::array<double, 384> stack_t{};
+    std::size_t top = 0;
+    stack[top]      = 0;
+    stack_t[top++]  = 0.0;
+    std::array<double, 4> t_entry{};
+    while (top > 0) {
+      --top;
+      if (stack_t[top] > t_max) {
+        continue;
+      }
+      BVH4Node const & n = nodes_[stack[top]];
+      if (stats != nullptr) {
+        stats->nodes++;
+      }
+      unsigned const mask = intersect_children(n, rd, t_max, t_entry);
+      // hijos cortados ordenados de lejos a cerca para apilar el más cercano el último
+      std::array<std::size_t, 4> order{};
+      std::size_t hits = 0;
+      for (std::size_t i = 0; i < width; ++i) {
+        if ((mask & (1U << i)) != 0U) {
+          std::size_t k = hits++;
+          while (k > 0 and t_entry[order[k - 1]] < t_entry[i]) {
+            order[k] = order[k - 1];
+            --k;
+          }
+          order[k] = i;
+        }
+      }
+      for (std::size_t k = 0; k < hits; ++k) {
+        std::size_t const i = order[k];
+        if (n.count[i] == 0) {
+          stack[top]     = n.child[i];
+          stack_t[top++] = t_entry[i];
+        }
+      }
+      // las hojas se visitan de cerca a lejos
+      for (std::size_t k = hits; k > 0; --k) {
+        std::size_t const i = order[k - 1];
+        if (n.count[i] > 0 and t_entry[i] <= t_max) {
+          for (std::uint32_t p = n.child[i]; p < n.child[i] + n.count[i]; ++p) {
+            visit(indices_[p]);
+          }
+          if (stats != nullptr) {
+            stats->primitives += n.count[i];
+          }
+        }
+      }
+    }
+  }
+
+}  // namespace render
+
+#endif
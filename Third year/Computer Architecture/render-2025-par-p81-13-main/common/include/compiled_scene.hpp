@@ -0,0 +1,95 @@
+#ifndef RENDER_COMPILED_SCENE_HPP
+#define RENDER_COMPILED_SCENE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <intersection.hpp>
+#include <limits>
+#include <memory>
+#include <object.hpp>
+#include <optional>
+#include <ray.hpp>
+#include <vector>
+
+namespace render {
+
+  // Esferas por componentes (SoA). `obj_id` es el índice del objeto en Scene::objects y `mat_id`
+  // el de su material en Scene::material_table.
+  struct SphereSoA {
+    std::vector<double> cx, cy, cz;
+    std::vector<double> r2;
+    std::vector<std::uint32_t> mat_id;
+    std::vector<std::uint32_t> obj_id;
+
+    [[nodiscard]] std::size_t size() const noexcept { return obj_id.size(); }
+  };
+
+  // Cilindros por componentes: centro, eje unitario, semialtura, radio y centros de las tapas
+  // (la tapa inferior con su normal ya invertida)
+  struct CylinderSoA {
+    std::vector<double> cx, cy, cz;
+    std::vector<double> ex, ey, ez;
+    std::vector<double> half_h;
+    std::vector<double> r, r2;
+    std::vector<double> top_x, top_y, top_z;
+    std::vector<double> bot_x, bot_y, bot_z;
+    std::vector<double> bot_nx, bot_ny, bot_nz;
+    std::vector<std::uint32_t> mat_id;
+    std::vector<std::uint32_t> obj_id;
+
+    [[nodiscard]] std::size_t size() const noexcept { return obj_id.size(); }
+  };
+
+  enum class PrimKind : std::uint8_t { sphere, cylinder };
+
+  // Dónde está cada objeto de la escena dentro de los arrays de su tipo
+  struct PrimRef {
+    PrimKind kind;
+    std::uint32_t slot;
+  };
+
+  // Superficie del impacto, necesaria para reconstruir la normal del cilindro
+  enum class HitSurface : std::uint8_t { body, top_cap, bottom_cap };
+
+  // Mejor impacto encontrado hasta el momento; sólo guarda lo necesario para compararlo
+  struct PrimHit {
+    double lambda      = std::numeric_limits<double>::infinity();
+    std::uint32_t obj  = std::numeric_limits<std::uint32_t>::max();
+    HitSurface surface = HitSurface::body;
+  };
+
+  // Representación compilada de la escena para el render: primitivas separadas por tipo en
+  // arrays contiguos con el identificador de su material. Los objetos de Scene::objects quedan
+  // como la descripción de carga; las intersecciones dan exactamente los mismos valores que
+  // Object3D::collision.
+  class CompiledScene {
+  public:
+    // Distancia mínima de un impacto válido (igual que en Scene::intersect_linear)
+    static constexpr double min_lambda = 1e-3;
+
+    void build(std::vector<std::unique_ptr<Object3D>> const & objects);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return refs_.size(); }
+
+    [[nodiscard]] SphereSoA const & spheres() const noexcept { return spheres_; }
+
+    [[nodiscard]] CylinderSoA const & cylinders() const noexcept { return cylinders_; }
+
+    // Prueba el objeto `obj` y actualiza `best` si el impacto es más cercano (o igual de cercano
+    // y de menor índice)
+    void test(std::uint32_t obj, ray const & r, PrimHit & best) const;
+    // Impacto más cercano recorriendo todas las primitivas, un bucle (vectorial) por tipo
+    [[nodiscard]] PrimHit closest_all(ray const & r) const;
+    // Intersección completa (punto, normal, material) del impacto `hit`
+    [[nodiscard]] std::optional<Intersection> resolve(ray const & r, PrimHit const & hit) const;
+
+  private:
+    SphereSoA spheres_;
+    CylinderSoA cylinders_;
+    std::vector<PrimRef> refs_;
+  };
+
+}  // namespace render
+
+#endif
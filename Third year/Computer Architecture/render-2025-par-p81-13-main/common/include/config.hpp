@@ -1,8 +1,12 @@
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
+#include <accelerator.hpp>
 #include <cstdint>
+#include <partitioner.hpp>
+#include <sampler.hpp>
 #include <string>
 #include <sys/types.h>
+#include <tone_map.hpp>
 #include <unordered_map>
 #include <vector.hpp>
 
@@ -25,9 +29,39 @@ public:
   render::vector background_dark_color{0.25, 0.5, 1.0};
   render::vector background_light_color{1.0, 1.0, 1.0};
 
+  // Estructura de aceleración usada para intersecar rayos con la escena
+  render::Accelerator accelerator = render::Accelerator::bvh4;
+  // Lado del paquete de píxeles cuyos rayos primarios se trazan juntos (1 = píxel a píxel)
+  int packet_size = 1;
+  // Rebotes a partir de los cuales los caminos terminan por ruleta rusa (0 = sin ruleta rusa)
+  int russian_roulette_depth = 0;
+  // Origen de los números de las muestras (anti-aliasing, dispersión y ruleta rusa)
+  render::SamplerKind sampler = render::SamplerKind::random;
+  // Muestreo adaptativo: samples_per_pixel pasa a ser el máximo y cada píxel deja de muestrearse
+  // cuando la semianchura del intervalo de confianza del 95 % de su luminancia, relativa a la
+  // media, baja de adaptive_threshold (0 = sin muestreo adaptativo). Las muestras se toman en
+  // pasadas de adaptive_min_samples y la condición se comprueba al final de cada pasada.
+  double adaptive_threshold = 0.0;
+  int adaptive_min_samples  = 8;
+  // Hilos del render (0 = los del sistema), lado en píxeles de los bloques de la imagen que
+  // reparte TBB y particionador con el que los reparte
+  int threads                     = 0;
+  int tile_size                   = 8;
+  render::Partitioner partitioner = render::Partitioner::simple;
+  // Render por nodos NUMA: un task_arena por nodo con su parte de las teselas, su copia de la
+  // escena y su parte de la imagen en memoria del nodo (con un solo nodo, un único arena)
+  bool numa = false;
+  // Postproceso de la imagen de 8 bits: exposición en pasos (la radiancia se multiplica por
+  // 2^exposure) y operador de tone mapping, antes de la gamma
+  double exposure          = 0.0;
+  render::ToneMap tone_map = render::ToneMap::none;
+
   Config() = default;
 
   void load_config(std::string const & path);
+  // Aplica una clave como si fuera una línea "key: value" del archivo, con la misma validación;
+  // así las opciones de la línea de órdenes pueden sustituir al archivo
+  void set_option(std::string const & key, std::string const & value);
 
   // Para monitorear las parámetros vistos al parsear el archivo
   [[nodiscard]] std::unordered_map<std::string, int> const & seen_keys() const noexcept {
@@ -35,6 +69,10 @@ public:
   }
 
 private:
+  using Handler = void (Config::*)(std::string const &, std::string const &);
+  // Handler de una clave del archivo (con los dos puntos); nullptr si no existe
+  [[nodiscard]] static Handler find_handler(std::string const & key);
+
   //  metodos auxiliares para setear los valores
   void set_aspect_ratio(std::string const & raw, std::string const & rest);
   void set_image_width(std::string const & raw, std::string const & rest);
@@ -49,6 +87,18 @@ private:
   void set_ray_rng_seed(std::string const & raw, std::string const & rest);
   void set_background_dark_color(std::string const & raw, std::string const & rest);
   void set_background_light_color(std::string const & raw, std::string const & rest);
+  void set_accelerator(std::string const & raw, std::string const & rest);
+  void set_packet_size(std::string const & raw, std::string const & rest);
+  void set_russian_roulette_depth(std::string const & raw, std::string const & rest);
+  void set_sampler(std::string const & raw, std::string const & rest);
+  void set_adaptive_threshold(std::string const & raw, std::string const & rest);
+  void set_adaptive_min_samples(std::string const & raw, std::string const & rest);
+  void set_threads(std::string const & raw, std::string const & rest);
+  void set_tile_size(std::string const & raw, std::string const & rest);
+  void set_partitioner(std::string const & raw, std::string const & rest);
+  void set_numa(std::string const & raw, std::string const & rest);
+  void set_exposure(std::string const & raw, std::string const & rest);
+  void set_tone_map(std::string const & raw, std::string const & rest);
 
   // Para monitorear los parámetros vistos
   std::unordered_map<std::string, int> _seen;
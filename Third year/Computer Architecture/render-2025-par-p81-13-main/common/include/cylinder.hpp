@@ -1,7 +1,9 @@
 #ifndef RENDER_CYLINDER_HPP
 #define RENDER_CYLINDER_HPP
 
+#include <aabb.hpp>
 #include <intersection.hpp>
+#include <memory>
 #include <object.hpp>
 #include <optional>
 #include <string>
@@ -17,6 +19,13 @@ namespace render {
     Cylinder(render::vector const & c, double r, render::vector a, std::string const & m);
 
     [[nodiscard]] std::optional<Intersection> collision(ray const & r) const override;
+    [[nodiscard]] AABB bounds() const override;
+    [[nodiscard]] std::unique_ptr<Object3D> clone() const override;
+
+    // Eje unitario y altura total, usados al compilar la escena
+    [[nodiscard]] vector const & axis() const noexcept { return ejes; }
+
+    [[nodiscard]] double height() const noexcept { return altura; }
 
   private:
     [[nodiscard]] std::optional<Intersection> intersect_lateral(ray const & r) const;
@@ -1,7 +1,8 @@
 #ifndef RENDER_INTERSECTION_HPP
 #define RENDER_INTERSECTION_HPP
 
-#include <string>
+#include <cstdint>
+#include <limits>
 #include <vector.hpp>
 
 namespace render {
@@ -10,10 +11,14 @@ namespace render {
     vector punto_interseccion;
     vector vector_normal;
     double lambda;
-    std::string nombre_material;
+    // índice del material en Scene::material_table
+    std::uint32_t material;
 
-    Intersection(vector p, vector n, double l, std::string m)
-        : punto_interseccion{p}, vector_normal{n}, lambda{l}, nombre_material{std::move(m)} { }
+    // material de los objetos que aún no están en la tabla de materiales de una escena
+    static constexpr std::uint32_t no_material = std::numeric_limits<std::uint32_t>::max();
+
+    Intersection(vector p, vector n, double l, std::uint32_t m)
+        : punto_interseccion{p}, vector_normal{n}, lambda{l}, material{m} { }
   };
 
 }  // namespace render
@@ -1,10 +1,26 @@
 #ifndef MATERIAL_HPP
 #define MATERIAL_HPP
 
-#include <random>
+#include <cstddef>
+#include <sampler.hpp>
 #include <string>
 #include <utility>
 #include <vector.hpp>
+#include <vector>
+
+// Lote de impactos sobre un mismo material, por componentes (SoA): dirección de entrada, normal y
+// generador de cada impacto y, a la salida, la dirección dispersada y la reflectancia
+struct ScatterBatch {
+  std::vector<double> in_x, in_y, in_z;
+  std::vector<double> n_x, n_y, n_z;
+  std::vector<render::Sampler> rng;
+  std::vector<double> out_x, out_y, out_z;
+  std::vector<double> att_r, att_g, att_b;
+
+  [[nodiscard]] std::size_t size() const noexcept { return in_x.size(); }
+
+  void resize(std::size_t n);
+};
 
 class Material {
 public:
@@ -19,7 +35,13 @@ public:
   // in_dir es un vector unitario y el vector normal es la normal de la intersección
   virtual std::pair<render::vector, render::vector> scatter(render::vector const & in_dir,
                                                             render::vector const & normal,
-                                                            std::mt19937_64 & rng) const = 0;
+                                                            render::Sampler & rng) const = 0;
+  // Dispersa todos los impactos del lote con una sola llamada virtual. Cada impacto usa su propio
+  // generador del lote, así que el resultado es el mismo que llamar a scatter impacto a impacto.
+  virtual void scatter_batch(ScatterBatch & batch) const;
+  // Parámetros que definen la dispersión (reflectancia, fuzz o índice de refracción), para
+  // reconocer la escena en un checkpoint
+  [[nodiscard]] virtual std::vector<double> parameters() const = 0;
 
   virtual ~Material() = default;
 
@@ -27,17 +49,19 @@ protected:
   explicit Material(std::string name) : name(std::move(name)) { }  // Constructor base
 };
 
-class Matte : public Material {
+class Matte final : public Material {
   render::vector reflectance;
 
 public:
   Matte(std::string name, render::vector reflectance);
   std::pair<render::vector, render::vector> scatter(render::vector const & in_dir,
                                                     render::vector const & normal,
-                                                    std::mt19937_64 & rng) const override;
+                                                    render::Sampler & rng) const override;
+  void scatter_batch(ScatterBatch & batch) const override;
+  [[nodiscard]] std::vector<double> parameters() const override;
 };
 
-class Metal : public Material {
+class Metal final : public Material {
   render::vector reflectance;
   double fuzz;
 
@@ -45,17 +69,21 @@ public:
   Metal(std::string name, render::vector reflectance, double fuzz);
   std::pair<render::vector, render::vector> scatter(render::vector const & in_dir,
                                                     render::vector const & normal,
-                                                    std::mt19937_64 & rng) const override;
+                                                    render::Sampler & rng) const override;
+  void scatter_batch(ScatterBatch & batch) const override;
+  [[nodiscard]] std::vector<double> parameters() const override;
 };
 
-class Refractive : public Material {
+class Refractive final : public Material {
   double ior;
 
 public:
   Refractive(std::string name, double ior);
   std::pair<render::vector, render::vector> scatter(render::vector const & in_dir,
                                                     render::vector const & normal,
-                                                    std::mt19937_64 & rng) const override;
+                                                    render::Sampler & rng) const override;
+  void scatter_batch(ScatterBatch & batch) const override;
+  [[nodiscard]] std::vector<double> parameters() const override;
 };
 
 #endif
@@ -1,7 +1,10 @@
 #ifndef OBJECT3D_HPP
 #define OBJECT3D_HPP
 
+#include <aabb.hpp>
+#include <cstdint>
 #include <intersection.hpp>
+#include <memory>
 #include <optional>
 #include <ray.hpp>
 #include <string>
@@ -12,6 +15,8 @@ namespace render {
   class Object3D {
   public:
     std::string material_name;
+    // índice de material_name en la tabla de materiales de la escena (lo asigna Scene::build_bvh)
+    std::uint32_t material_id = Intersection::no_material;
     double radius{};
     vector center;
 
@@ -24,6 +29,12 @@ namespace render {
 
     // Método de intersección con un rayo
     [[nodiscard]] virtual std::optional<Intersection> collision(ray const & r) const = 0;
+
+    // Caja envolvente del objeto, usada para construir la BVH de la escena
+    [[nodiscard]] virtual AABB bounds() const = 0;
+
+    // Copia del objeto con su tipo concreto
+    [[nodiscard]] virtual std::unique_ptr<Object3D> clone() const = 0;
   };
 
 }  // namespace render
@@ -0,0 +1,17 @@
+#ifndef RENDER_PARTITIONER_HPP
+#define RENDER_PARTITIONER_HPP
+
+#include <cstdint>
+
+namespace render {
+
+  // Particionador de TBB con el que se reparten los bloques de la imagen entre los hilos
+  enum class Partitioner : std::uint8_t {
+    simple,     // divide hasta el tamaño de bloque
+    automatic,  // divide sólo lo necesario para equilibrar la carga
+    affinity,   // como automatic, pero repite el reparto de la pasada anterior (TileAffinity)
+  };
+
+}  // namespace render
+
+#endif
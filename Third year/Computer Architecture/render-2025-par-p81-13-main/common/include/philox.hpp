@@ -0,0 +1,98 @@
+#ifndef RENDER_PHILOX_HPP
+#define RENDER_PHILOX_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace render {
+
+  // Bloque de Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): 128
+  // bits pseudoaleatorios que sólo dependen del contador y de la clave
+  [[nodiscard]] constexpr std::array<std::uint32_t, 4> philox4x32(
+      std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key) noexcept {
+    std::uint32_t c0 = ctr[0];
+    std::uint32_t c1 = ctr[1];
+    std::uint32_t c2 = ctr[2];
+    std::uint32_t c3 = ctr[3];
+    std::uint32_t k0 = key[0];
+    std::uint32_t k1 = key[1];
+#pragma GCC unroll 10
+    for (int round = 0; round < 10; ++round) {
+      std::uint64_t const p0 = std::uint64_t{0xD251'1F53} * c0;
+      std::uint64_t const p1 = std::uint64_t{0xCD9E'8D57} * c2;
+      c0                     = static_cast<std::uint32_t>(p1 >> 32U) ^ c1 ^ k0;
+      c1                     = static_cast<std::uint32_t>(p1);
+      c2                     = static_cast<std::uint32_t>(p0 >> 32U) ^ c3 ^ k1;
+      c3                     = static_cast<std::uint32_t>(p0);
+      k0                    += 0x9E37'79B9;
+      k1                    += 0xBB67'AE85;
+    }
+    return {c0, c1, c2, c3};
+  }
+
+  // Generador basado en contador: el número `dimension` de la muestra `sample` del píxel `pixel`
+  // es una función de (seed, pixel, sample, dimension), así que no depende de qué hilo ni en qué
+  // orden se calcule. La dimensión d es la mitad d % 2 del bloque de Philox4x32-10 con clave
+  // `seed` y contador (pixel, sample, d / 2). Cumple los requisitos de UniformRandomBitGenerator y
+  // ocupa 48 bytes (mt19937_64, 2,5 KB).
+  class Philox {
+  public:
+    using result_type = std::uint64_t;
+
+    Philox() = default;
+
+    Philox(std::uint64_t seed, std::uint64_t pixel, std::uint32_t sample,
+           std::uint32_t dimension = 0) noexcept
+        : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32U)},
+          ctr_{static_cast<std::uint32_t>(pixel), static_cast<std::uint32_t>(pixel >> 32U), sample,
+               0} {
+      seek(dimension);
+    }
+
+    // El siguiente número devuelto será el de la dimensión dada. Los bloques se calculan al pedir
+    // el primer número, así que crear o reposicionar el generador no cuesta nada.
+    void seek(std::uint32_t dimension) noexcept {
+      ctr_[3] = dimension / outputs;
+      next_   = dimension % outputs;
+      filled_ = false;
+    }
+
+    result_type operator()() noexcept {
+      if (next_ == outputs) {
+        ++ctr_[3];
+        next_   = 0;
+        filled_ = false;
+      }
+      if (not filled_) {
+        refill();
+      }
+      return out_[next_++];
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+  private:
+    // números de 64 bits por bloque
+    static constexpr std::uint32_t outputs = 2;
+
+    void refill() noexcept {
+      std::array<std::uint32_t, 4> const r = philox4x32(ctr_, key_);
+      out_[0] = (std::uint64_t{r[0]} << 32U) | r[1];
+      out_[1] = (std::uint64_t{r[2]} << 32U) | r[3];
+      filled_ = true;
+    }
+
+    std::array<std::uint32_t, 2> key_{};
+    // píxel (dos palabras), muestra y bloque actual
+    std::array<std::uint32_t, 4> ctr_{};
+    std::array<std::uint64_t, outputs> out_{};
+    std::uint32_t next_ = 0;
+    bool filled_        = false;
+  };
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RENDER_PRIMITIVE_KERNELS_HPP
+#define RENDER_PRIMITIVE_KERNELS_HPP
+
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ray.hpp>
+#include <simd.hpp>
+
+namespace render {
+
+  // Impacto más cercano dentro de un array de primitivas de un tipo (`slot` es la posición en
+  // el array)
+  struct NearestHit {
+    double lambda      = std::numeric_limits<double>::infinity();
+    std::uint32_t slot = std::numeric_limits<std::uint32_t>::max();
+    HitSurface surface = HitSurface::body;
+
+    [[nodiscard]] bool found() const noexcept {
+      return slot != std::numeric_limits<std::uint32_t>::max();
+    }
+  };
+
+  // Distancia al impacto del rayo con la esfera `s`, o infinito si no la corta. Mismas
+  // operaciones y en el mismo orden que Sphere::collision.
+  [[nodiscard]] double sphere_lambda(SphereSoA const & spheres, std::size_t s, ray const & r);
+
+  // Esfera más cercana con impacto mayor que CompiledScene::min_lambda; ante empate gana la de
+  // menor posición. Las versiones vectoriales prueban 4 (avx2) u 8 (avx512) esferas a la vez y
+  // dan exactamente el mismo resultado que la escalar. `level` debe estar soportado por la CPU.
+  [[nodiscard]] NearestHit nearest_sphere(SphereSoA const & spheres, ray const & r,
+                                          SimdLevel level);
+  // Igual, con el mejor nivel que soporte la CPU
+  [[nodiscard]] NearestHit nearest_sphere(SphereSoA const & spheres, ray const & r);
+
+  // Distancia al impacto del rayo con el cilindro `s` (lateral o tapas), o infinito si no lo
+  // corta; `surface` indica la superficie alcanzada. Mismas operaciones y en el mismo orden que
+  // Cylinder::collision, con los centros y normales de las tapas ya calculados.
+  [[nodiscard]] double cylinder_lambda(CylinderSoA const & cylinders, std::size_t s, ray const & r,
+                                       HitSurface & surface);
+
+  // Cilindro más cercano, con el mismo criterio y las mismas variantes que nearest_sphere
+  [[nodiscard]] NearestHit nearest_cylinder(CylinderSoA const & cylinders, ray const & r,
+                                            SimdLevel level);
+  [[nodiscard]] NearestHit nearest_cylinder(CylinderSoA const & cylinders, ray const & r);
+
+}  // namespace render
+
+#endif
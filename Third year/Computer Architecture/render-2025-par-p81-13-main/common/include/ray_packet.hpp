@@ -0,0 +1,27 @@
+#ifndef RENDER_RAY_PACKET_HPP
+#define RENDER_RAY_PACKET_HPP
+
+#include <bvh.hpp>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <ray.hpp>
+#include <span>
+
+namespace render {
+
+  // Número máximo de rayos de un paquete (8x8 píxeles); la máscara de rayos activos es de 64 bits
+  inline constexpr std::size_t max_packet_rays = 64;
+
+  // Impactos más cercanos de un paquete de rayos recorriendo juntos la BVH binaria. Si todos los
+  // rayos comparten origen y el signo de la dirección en cada eje (rayos primarios de píxeles
+  // vecinos), cada nodo se prueba primero contra el paquete entero con aritmética de intervalos
+  // sobre las inversas de las direcciones y se descarta sin probar los rayos uno a uno. Da los
+  // mismos impactos que BVH::traverse rayo a rayo con CompiledScene::test.
+  // `rays` y `hits` deben tener el mismo tamaño, como mucho max_packet_rays. En `stats` se cuentan
+  // los nodos visitados por el paquete y las pruebas rayo-primitiva.
+  void closest_hits_packet(BVH const & bvh, CompiledScene const & cs, std::span<ray const> rays,
+                           std::span<PrimHit> hits, TraversalStats * stats = nullptr);
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef RENDER_SAMPLER_HPP
+#define RENDER_SAMPLER_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <philox.hpp>
+
+namespace render {
+
+  // Origen de los números de cada muestra
+  enum class SamplerKind : std::uint8_t {
+    random,  // Philox: números independientes
+    sobol,   // Sobol con barajado de Owen: muestras estratificadas entre sí
+  };
+
+  // Dimensiones de Sobol con números de dirección propios; las demás se repiten por grupos
+  inline constexpr std::uint32_t sobol_dimensions = 4;
+
+  // Números de dirección de las 4 primeras dimensiones de Sobol (Joe y Kuo): polinomios
+  // primitivos de grado s con coeficientes a y números iniciales m
+  [[nodiscard]] constexpr std::array<std::array<std::uint32_t, 32>, sobol_dimensions>
+      sobol_directions() noexcept {
+    struct Polynomial {
+      std::uint32_t s, a;
+      std::array<std::uint32_t, 3> m;
+    };
+
+    constexpr std::array<Polynomial, sobol_dimensions - 1> polys{
+      {{1, 0, {1, 0, 0}}, {2, 1, {1, 3, 0}}, {3, 1, {1, 3, 1}}}
+    };
+    std::array<std::array<std::uint32_t, 32>, sobol_dimensions> v{};
+    for (std::uint32_t k = 0; k < 32; ++k) {
+      v[0][k] = std::uint32_t{1} << (31 - k);
+    }
+    for (std::uint32_t d = 1; d < sobol_dimensions; ++d) {
+      Polynomial const & p = polys[d - 1];
+      for (std::uint32_t k = 0; k < 32; ++k) {
+        if (k < p.s) {
+          v[d][k] = p.m[k] << (31 - k);
+          continue;
+        }
+        std::uint32_t x = v[d][k - p.s] ^ (v[d][k - p.s] >> p.s);
+        for (std::uint32_t j = 1; j < p.s; ++j) {
+          if (((p.a >> (p.s - 1 - j)) & 1U) != 0) {
+            x ^= v[d][k - j];
+          }
+        }
+        v[d][k] = x;
+      }
+    }
+    return v;
+  }
+
+  inline constexpr std::array<std::array<std::uint32_t, 32>, sobol_dimensions> sobol_table =
+      sobol_directions();
+
+  [[nodiscard]] constexpr std::uint32_t reverse_bits(std::uint32_t x) noexcept {
+    x = ((x >> 1U) & 0x5555'5555U) | ((x & 0x5555'5555U) << 1U);
+    x = ((x >> 2U) & 0x3333'3333U) | ((x & 0x3333'3333U) << 2U);
+    x = ((x >> 4U) & 0x0F0F'0F0FU) | ((x & 0x0F0F'0F0FU) << 4U);
+    x = ((x >> 8U) & 0x00FF'00FFU) | ((x & 0x00FF'00FFU) << 8U);
+    return (x >> 16U) | (x << 16U);
+  }
+
+  // Punto `index` de la dimensión `dim` (< sobol_dimensions) de Sobol, en unidades de 2^-32
+  [[nodiscard]] constexpr std::uint32_t sobol_point(std::uint32_t index,
+                                                    std::uint32_t dim) noexcept {
+    // la primera dimensión es la secuencia de van der Corput
+    if (dim == 0) {
+      return reverse_bits(index);
+    }
+    std::uint32_t x = 0;
+    for (; index != 0; index &= index - 1) {
+      x ^= sobol_table[dim][static_cast<std::uint32_t>(std::countr_zero(index))];
+    }
+    return x;
+  }
+
+  // Barajado de Owen por hash (Burley, "Practical Hash-based Owen Scrambling"): cada bit se
+  // invierte según una función de los bits más significativos, así que conserva la
+  // estratificación de los puntos de Sobol
+  [[nodiscard]] constexpr std::uint32_t owen_scramble(std::uint32_t x,
+                                                      std::uint32_t seed) noexcept {
+    x  = reverse_bits(x);
+    x += seed;
+    x ^= x * 0x6C50'B47CU;
+    x ^= x * 0xB82F'1E52U;
+    x ^= x * 0xC7AF'E638U;
+    x ^= x * 0x8D22'F6E6U;
+    return reverse_bits(x);
+  }
+
+  // Mezcla de enteros de 32 bits con buena avalancha (lowbias32 de C. Wellons)
+  [[nodiscard]] constexpr std::uint32_t hash_combine(std::uint32_t seed,
+                                                     std::uint32_t v) noexcept {
+    std::uint32_t x = seed ^ (v + 0x9E37'79B9U + (seed << 6U) + (seed >> 2U));
+    x ^= x >> 16U;
+    x *= 0x7FEB'352DU;
+    x ^= x >> 15U;
+    x *= 0x846C'A68BU;
+    x ^= x >> 16U;
+    return x;
+  }
+
+  // Número de [0, 1) con los 53 bits altos de `x`. std::uniform_real_distribution deja el
+  // algoritmo a cada biblioteca estándar; esta conversión da el mismo valor en cualquiera, así
+  // que la imagen sólo depende de las semillas.
+  [[nodiscard]] constexpr double unit_double(std::uint64_t x) noexcept {
+    return static_cast<double>(x >> 11U) * 0x1p-53;
+  }
+
+  // Número de [lo, hi) con el siguiente número de 64 bits de `rng` (Philox o Sampler)
+  template <typename Generator>
+  [[nodiscard]] double uniform_double(Generator & rng, double lo, double hi) {
+    return lo + (hi - lo) * unit_double(rng());
+  }
+
+  // Números de la muestra `sample` del píxel `pixel`, dimensión a dimensión, con la misma
+  // interfaz que Philox (UniformRandomBitGenerator con seek). Con SamplerKind::random son los
+  // de Philox. Con SamplerKind::sobol las dimensiones se agrupan de sobol_dimensions en
+  // sobol_dimensions: dentro de un grupo son las dimensiones de Sobol de la muestra, con el orden
+  // de las muestras y cada dimensión barajados por píxel y grupo. Las primeras 2^m muestras de un
+  // píxel quedan estratificadas en cada dimensión y forman una red (0, m, 2) en las dos primeras
+  // dimensiones de cada grupo (el desplazamiento del píxel, dos direcciones de un rebote).
+  class Sampler {
+  public:
+    using result_type = std::uint64_t;
+
+    Sampler() = default;
+
+    Sampler(SamplerKind kind, std::uint64_t seed, std::uint64_t pixel, std::uint32_t sample,
+            std::uint32_t dimension = 0) noexcept
+        : kind_(kind), philox_(seed, pixel, sample, dimension),
+          pixel_seed_(hash_combine(hash64(seed), hash64(pixel))), sample_(sample),
+          dimension_(dimension) { }
+
+    [[nodiscard]] SamplerKind kind() const noexcept { return kind_; }
+
+    // El siguiente número devuelto será el de la dimensión dada
+    void seek(std::uint32_t dimension) noexcept {
+      philox_.seek(dimension);
+      dimension_ = dimension;
+    }
+
+    result_type operator()() noexcept {
+      if (kind_ == SamplerKind::sobol) {
+        return next_sobol();
+      }
+      return philox_();
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+  private:
+    [[nodiscard]] static constexpr std::uint32_t hash64(std::uint64_t v) noexcept {
+      return hash_combine(static_cast<std::uint32_t>(v), static_cast<std::uint32_t>(v >> 32U));
+    }
+
+    result_type next_sobol() noexcept {
+      std::uint32_t const d     = dimension_++;
+      std::uint32_t const group = d / sobol_dimensions;
+      // la semilla y la muestra barajada se reutilizan en todo el grupo
+      if (group != group_) {
+        group_      = group;
+        group_seed_ = hash_combine(pixel_seed_, group);
+        index_      = owen_scramble(sample_, group_seed_);
+      }
+      std::uint32_t const dim = d % sobol_dimensions;
+      std::uint32_t const x =
+          owen_scramble(sobol_point(index_, dim), hash_combine(group_seed_, dim + 1));
+      // los 32 bits bajos rellenan el intervalo de 2^-32 del punto
+      return (std::uint64_t{x} << 32U) | hash_combine(x, group_seed_);
+    }
+
+    SamplerKind kind_ = SamplerKind::random;
+    Philox philox_;
+    std::uint32_t pixel_seed_ = 0;
+    std::uint32_t sample_     = 0;
+    std::uint32_t dimension_  = 0;
+    // grupo de dimensiones de Sobol en curso, su semilla y su muestra barajada
+    std::uint32_t group_      = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t group_seed_ = 0;
+    std::uint32_t index_      = 0;
+  };
+
+}  // namespace render
+
+#endif
@@ -1,10 +1,18 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <accelerator.hpp>
+#include <bvh.hpp>
+#include <bvh4.hpp>
+#include <compiled_scene.hpp>
+#include <cstdint>
 #include <intersection.hpp>
 #include <material.hpp>
 #include <memory>
 #include <object.hpp>
+#include <optional>
+#include <ray.hpp>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -12,14 +20,58 @@
 struct Scene {
   // Materiales disponibles en la escena, indexados por nombre
   std::unordered_map<std::string, std::unique_ptr<Material>> materials;
-  // Objetos presentes en la escena
+  // Tabla contigua de materiales por identificador (orden alfabético de nombre), la que usa el
+  // render a partir de Intersection::material, y el identificador de cada nombre
+  std::vector<Material const *> material_table;
+  std::unordered_map<std::string, std::uint32_t> material_ids;
+  // Objetos presentes en la escena (descripción de carga)
   std::vector<std::unique_ptr<render::Object3D>> objects;
+  // Primitivas de `objects` por tipo en arrays contiguos y jerarquías de cajas sobre ellas,
+  // construidas al terminar load_scene
+  render::CompiledScene compiled;
+  render::BVH bvh;
+  render::BVH4 bvh4;
+  // Estructura que usa intersect (seleccionable en tiempo de ejecución)
+  render::Accelerator accelerator = render::Accelerator::bvh4;
 
   void load_scene(std::string const & path);
+  // (Re)construye la tabla de materiales, el identificador de material de cada objeto, la escena
+  // compilada y las BVH; necesario si se añaden objetos o materiales a mano tras load_scene
+  void build_bvh();
+  // Copia de la escena para el render: objetos, escena compilada y BVH copiadas (en la memoria
+  // del hilo que llama, así que sirve para replicarla en cada nodo NUMA) y la misma tabla de
+  // materiales, que apunta a los de esta escena: la copia sólo tiene materialById y esta escena
+  // debe vivir más que ella
+  [[nodiscard]] Scene replica() const;
+  // Copia con lo que haría build_bvh (objetos copiados, tabla de materiales, identificadores,
+  // escena compilada y BVH) sin tocar esta escena, para renderizar una escena que no está al
+  // día. La tabla apunta a los materiales de esta escena, que debe vivir más que la copia.
+  [[nodiscard]] Scene rebuilt() const;
+  // La escena compilada corresponde a `objects` (se ha llamado a build_bvh tras el último
+  // objeto añadido)
+  [[nodiscard]] bool up_to_date() const noexcept { return compiled.size() == objects.size(); }
 
   // Devuelve un puntero al material con el nombre dado, o nullptr si no existe
   Material const * materialByName(std::string const & name) const;
-  std::optional<render::Intersection> intersect(render::ray const & r) const;
+  // Material con el identificador dado, o nullptr si no existe
+  Material const * materialById(std::uint32_t id) const {
+    return id < material_table.size() ? material_table[id] : nullptr;
+  }
+  // Impacto más cercano sobre la escena compilada con la estructura seleccionada; si no está al
+  // día con `objects` los recorre todos (intersect_linear). `stats` acumula los nodos y
+  // primitivas visitados.
+  std::optional<render::Intersection> intersect(render::ray const & r,
+                                                render::TraversalStats * stats = nullptr) const;
+  // Impactos más cercanos de un paquete de rayos coherentes (como mucho
+  // render::max_packet_rays), recorriendo juntos la BVH binaria; mismo resultado que intersect
+  // rayo a rayo. Sin BVH al día o con el recorrido lineal se intersecan uno a uno.
+  void intersect_packet(std::span<render::ray const> rays,
+                        std::span<std::optional<render::Intersection>> out,
+                        render::TraversalStats * stats = nullptr) const;
+  // Recorrido lineal de referencia sobre `objects` (llamadas virtuales a collision). El material
+  // de un objeto sin identificador se busca por nombre en material_ids; si la tabla no tiene ese
+  // nombre (build_bvh no llamado) queda no_material.
+  std::optional<render::Intersection> intersect_linear(render::ray const & r) const;
 };
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef RENDER_SIMD_HPP
+#define RENDER_SIMD_HPP
+
+namespace render {
+
+  // Conjuntos de instrucciones vectoriales para los que hay kernels específicos
+  enum class SimdLevel { scalar, avx2, avx512 };
+
+  // Mayor nivel soportado por la CPU en la que se ejecuta el programa
+  [[nodiscard]] SimdLevel cpu_simd_level() noexcept;
+  // Indica si la CPU puede ejecutar los kernels de `level`
+  [[nodiscard]] bool simd_supported(SimdLevel level) noexcept;
+  [[nodiscard]] char const * simd_level_name(SimdLevel level) noexcept;
+
+}  // namespace render
+
+#endif
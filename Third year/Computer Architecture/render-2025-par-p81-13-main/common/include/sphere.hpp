@@ -1,7 +1,9 @@
 #ifndef RENDER_SPHERE_HPP
 #define RENDER_SPHERE_HPP
 
+#include <aabb.hpp>
 #include <intersection.hpp>
+#include <memory>
 #include <object.hpp>
 #include <optional>
 #include <string>
@@ -15,6 +17,8 @@ namespace render {
 
     // Método de intersección con un rayo
     [[nodiscard]] std::optional<Intersection> collision(ray const & r) const override;
+    [[nodiscard]] AABB bounds() const override;
+    [[nodiscard]] std::unique_ptr<Object3D> clone() const override;
     // necesita el destructor virtual de la clase base
   };
 
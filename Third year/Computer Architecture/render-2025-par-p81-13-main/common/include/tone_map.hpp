@@ -0,0 +1,17 @@
+#ifndef RENDER_TONE_MAP_HPP
+#define RENDER_TONE_MAP_HPP
+
+#include <cstdint>
+
+namespace render {
+
+  // Operador que comprime la radiancia lineal (tras la exposición) a [0, 1] antes de la gamma
+  enum class ToneMap : std::uint8_t {
+    none,      // sin compresión: lo que pase de 1 se satura
+    reinhard,  // x / (1 + x)
+    aces,      // ajuste de la curva ACES de Narkowicz
+  };
+
+}  // namespace render
+
+#endif
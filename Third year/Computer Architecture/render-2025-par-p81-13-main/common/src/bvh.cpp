@@ -0,0 +1,314 @@
+#include <aabb.hpp>
+#include <algorithm>
+#include <array>
+#include <bvh.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector.hpp>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_invoke.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+namespace render {
+
+  namespace {
+
+    // costes relativos de recorrer un nodo y de intersecar una primitiva
+    constexpr double cost_traversal    = 1.0;
+    constexpr double cost_intersection = 1.0;
+
+    // por debajo de estos tamaños el trabajo se hace en serie
+    constexpr std::uint32_t parallel_reduce_min = 16'384;
+    constexpr std::uint32_t parallel_task_min   = 4'096;
+    constexpr std::size_t reduce_grain          = 4'096;
+
+    double axis_value(vector const & v, int axis) {
+      if (axis == 0) {
+        return v.x;
+      }
+      if (axis == 1) {
+        return v.y;
+      }
+      return v.z;
+    }
+
+    struct Bin {
+      AABB bounds;
+      std::uint32_t count = 0;
+    };
+
+    // Bins de los tres ejes; se pueden combinar en cualquier orden con el mismo resultado
+    // (min/max y sumas enteras), por eso la reducción paralela da los mismos bins que la serie
+    struct BinSet {
+      std::array<std::array<Bin, BVH::num_bins>, 3> axes{};
+
+      void join(BinSet const & o) {
+        for (std::size_t a = 0; a < 3; ++a) {
+          for (std::size_t b = 0; b < BVH::num_bins; ++b) {
+            axes[a][b].bounds.expand(o.axes[a][b].bounds);
+            axes[a][b].count += o.axes[a][b].count;
+          }
+        }
+      }
+    };
+
+    struct RangeBounds {
+      AABB bounds;
+      AABB centroids;
+
+      void join(RangeBounds const & o) {
+        bounds.expand(o.bounds);
+        centroids.expand(o.centroids);
+      }
+    };
+
+    // Bin al que pertenece un centroide; se usa la misma fórmula al contar y al particionar
+    int bin_of(double c, double c_min, double scale) {
+      int const b = static_cast<int>((c - c_min) * scale);
+      return std::clamp(b, 0, BVH::num_bins - 1);
+    }
+
+    // Estado compartido de una construcción: las tareas escriben en rangos disjuntos de indices
+    struct Builder {
+      std::vector<AABB> const & prim_bounds;
+      std::vector<vector> centroids;
+      std::vector<std::uint32_t> & indices;
+      bool parallel;
+
+      RangeBounds range_bounds(std::uint32_t begin, std::uint32_t end) const {
+        auto body = [&](oneapi::tbb::blocked_range<std::uint32_t> const & r, RangeBounds acc) {
+          for (std::uint32_t i = r.begin(); i != r.end(); ++i) {
+            acc.bounds.expand(prim_bounds[indices[i]]);
+            acc.centroids.expand(centroids[indices[i]]);
+          }
+          return acc;
+        };
+        if (parallel and end - begin >= parallel_reduce_min) {
+          return oneapi::tbb::parallel_reduce(
+              oneapi::tbb::blocked_range<std::uint32_t>(begin, end, reduce_grain), RangeBounds{},
+              body, [](RangeBounds a, RangeBounds const & b) {
+                a.join(b);
+                return a;
+              });
+        }
+        return body(oneapi::tbb::blocked_range<std::uint32_t>(begin, end), RangeBounds{});
+      }
+
+      BinSet bin_range(std::uint32_t begin, std::uint32_t end, AABB const & cb) const {
+        std::array<double, 3> c_min{};
+        std::array<double, 3> scale{};
+        for (int a = 0; a < 3; ++a) {
+          auto const ai = static_cast<std::size_t>(a);
+          c_min[ai]     = axis_value(cb.min, a);
+          double const extent = axis_value(cb.max, a) - c_min[ai];
+          scale[ai]           = extent > 0.0 ? BVH::num_bins / extent : 0.0;
+        }
+        auto body = [&](oneapi::tbb::blocked_range<std::uint32_t> const & r, BinSet acc) {
+          for (std::uint32_t i = r.begin(); i != r.end(); ++i) {
+            std::uint32_t const p = indices[i];
+            for (int a = 0; a < 3; ++a) {
+              auto const ai = static_cast<std::size_t>(a);
+              if (scale[ai] == 0.0) {
+                continue;
+              }
+              auto const b = static_cast<std::size_t>(
+                  bin_of(axis_value(centroids[p], a), c_min[ai], scale[ai]));
+              acc.axes[ai][b].count++;
+              acc.axes[ai][b].bounds.expand(prim_bounds[p]);
+            }
+          }
+          return acc;
+        };
+        if (parallel and end - begin >= parallel_reduce_min) {
+          return oneapi::tbb::parallel_reduce(
+              oneapi::tbb::blocked_range<std::uint32_t>(begin, end, reduce_grain), BinSet{}, body,
+              [](BinSet a, BinSet const & b) {
+                a.join(b);
+                return a;
+              });
+        }
+        return body(oneapi::tbb::blocked_range<std::uint32_t>(begin, end), BinSet{});
+      }
+
+      // Construye el subárbol de indices[begin, end) al final de `out`. Los índices de hijos son
+      // absolutos dentro de `out`, de modo que un subárbol construido aparte se puede empalmar
+      // desplazándolos (ver splice).
+      void build_node(std::uint32_t begin, std::uint32_t end, int depth,
+                      std::vector<BVHNode> & out) {
+        auto const node_index = static_cast<std::uint32_t>(out.size());
+        out.emplace_back();
+
+        RangeBounds const rb    = range_bounds(begin, end);
+        out[node_index].bounds  = rb.bounds;
+        std::uint32_t const count = end - begin;
+        if (count <= 1) {
+          out[node_index].first = begin;
+          out[node_index].count = count;
+          return;
+        }
+
+        // búsqueda del mejor corte por bins en los tres ejes
+        BinSet const bins        = bin_range(begin, end, rb.centroids);
+        double best_cost         = std::numeric_limits<double>::infinity();
+        int best_axis            = -1;
+        int best_split           = 0;
+        double const parent_area = rb.bounds.surface_area();
+        for (int axis = 0; axis < 3; ++axis) {
+          auto const & ab = bins.axes[static_cast<std::size_t>(axis)];
+          if (axis_value(rb.centroids.max, axis) - axis_value(rb.centroids.min, axis) <= 0.0) {
+            continue;
+          }
+          // barrido de derecha a izquierda para acumular las áreas de la parte derecha
+          std::array<double, BVH::num_bins - 1> right_area{};
+          std::array<std::uint32_t, BVH::num_bins - 1> right_count{};
+          AABB acc;
+          std::uint32_t acc_count = 0;
+          for (std::size_t b = BVH::num_bins - 1; b > 0; --b) {
+            acc.expand(ab[b].bounds);
+            acc_count          += ab[b].count;
+            right_area[b - 1]   = acc.surface_area();
+            right_count[b - 1]  = acc_count;
+          }
+          acc       = AABB{};
+          acc_count = 0;
+          for (std::size_t b = 0; b + 1 < BVH::num_bins; ++b) {
+            acc.expand(ab[b].bounds);
+            acc_count += ab[b].count;
+            if (acc_count == 0 or right_count[b] == 0) {
+              continue;
+            }
+            double const cost = cost_traversal + cost_intersection *
+                                                     (acc.surface_area() * acc_count +
+                                                      right_area[b] * right_count[b]) /
+                                                     parent_area;
+            if (cost < best_cost) {
+              best_cost  = cost;
+              best_axis  = axis;
+              best_split = static_cast<int>(b) + 1;
+            }
+          }
+        }
+
+        double const leaf_cost = cost_intersection * count;
+        if (best_axis < 0 or (best_cost >= leaf_cost and count <= BVH::max_leaf)) {
+          // hoja: o es más barata, o todos los centroides coinciden y no hay corte posible
+          out[node_index].first = begin;
+          out[node_index].count = count;
+          return;
+        }
+
+        std::uint32_t mid = begin;
+        if (depth < BVH::max_sah_depth) {
+          double const c_min = axis_value(rb.centroids.min, best_axis);
+          double const scale =
+              BVH::num_bins / (axis_value(rb.centroids.max, best_axis) - c_min);
+          auto * const first = indices.data() + begin;
+          auto * const split = std::partition(first, indices.data() + end, [&](std::uint32_t p) {
+            return bin_of(axis_value(centroids[p], best_axis), c_min, scale) < best_split;
+          });
+          mid = begin + static_cast<std::uint32_t>(split - first);
+        }
+        if (mid == begin or mid == end) {
+          // corte por la mediana a lo largo del eje de mayor extensión de los centroides
+          mid              = begin + count / 2;
+          vector const ext = vector::sub(rb.centroids.max, rb.centroids.min);
+          int const axis   = (ext.x >= ext.y and ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+          std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+                           [&](std::uint32_t a, std::uint32_t b) {
+                             double const ca = axis_value(centroids[a], axis);
+                             double const cb = axis_value(centroids[b], axis);
+                             return ca < cb or (ca == cb and a < b);
+                           });
+        }
+
+        if (parallel and count >= parallel_task_min) {
+          // los dos subárboles se construyen como tareas en vectores propios y se empalman
+          // en preorden, con lo que el árbol es idéntico al de la construcción en serie
+          std::vector<BVHNode> left;
+          std::vector<BVHNode> right;
+          oneapi::tbb::parallel_invoke([&] { build_node(begin, mid, depth + 1, left); },
+                                       [&] { build_node(mid, end, depth + 1, right); });
+          splice(out, left);
+          out[node_index].first = static_cast<std::uint32_t>(out.size());
+          splice(out, right);
+        } else {
+          build_node(begin, mid, depth + 1, out);
+          out[node_index].first = static_cast<std::uint32_t>(out.size());
+          build_node(mid, end, depth + 1, out);
+        }
+        out[node_index].count = 0;
+      }
+
+      static void splice(std::vector<BVHNode> & out, std::vector<BVHNode> const & sub) {
+        auto const offset = static_cast<std::uint32_t>(out.size());
+        for (BVHNode n : sub) {
+          if (not n.is_leaf()) {
+            n.first += offset;
+          }
+          out.push_back(n);
+        }
+      }
+    };
+
+  }  // namespace
+
+  void BVH::clear() noexcept {
+    nodes_.clear();
+    indices_.clear();
+  }
+
+  void BVH::build(std::vector<AABB> const & prim_bounds, bool parallel) {
+    auto const start = std::chrono::steady_clock::now();
+    clear();
+    if (prim_bounds.size() >= std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error("too many primitives for the BVH");
+    }
+    if (not prim_bounds.empty()) {
+      auto const n = static_cast<std::uint32_t>(prim_bounds.size());
+      Builder builder{prim_bounds, std::vector<vector>(n), indices_, parallel};
+      indices_.resize(n);
+      auto centroid_body = [&](oneapi::tbb::blocked_range<std::uint32_t> const & r) {
+        for (std::uint32_t i = r.begin(); i != r.end(); ++i) {
+          builder.centroids[i] = prim_bounds[i].centroid();
+          indices_[i]          = i;
+        }
+      };
+      if (parallel and n >= parallel_reduce_min) {
+        oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<std::uint32_t>(0, n, reduce_grain),
+                                  centroid_body);
+      } else {
+        centroid_body(oneapi::tbb::blocked_range<std::uint32_t>(0, n));
+      }
+      nodes_.reserve(2 * prim_bounds.size());
+      builder.build_node(0, n, 0, nodes_);
+      nodes_.shrink_to_fit();
+    }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    build_seconds_                              = elapsed.count();
+  }
+
+  double BVH::sah_cost() const {
+    if (nodes_.empty()) {
+      return 0.0;
+    }
+    double const root_area = nodes_[0].bounds.surface_area();
+    if (root_area <= 0.0) {
+      return cost_intersection * static_cast<double>(indices_.size());
+    }
+    double cost = 0.0;
+    for (auto const & n : nodes_) {
+      double const p = n.bounds.surface_area() / root_area;
+      cost += n.is_leaf() ? p * cost_intersection * n.count : p * cost_traversal;
+    }
+    return cost;
+  }
+
+}  // namespace render
@@ -0,0 +1,175 @@
+#include <aabb.hpp>
+#include <array>
+#include <bvh.hpp>
+#include <bvh4.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <simd.hpp>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace render {
+
+  namespace {
+
+    unsigned intersect_children_scalar(BVH4Node const & n, RayBoxData const & rd, double t_max,
+                                       std::array<double, 4> & t_entry) {
+      unsigned mask = 0;
+      for (std::size_t i = 0; i < n.num_children; ++i) {
+        AABB const box{
+          {n.min_x[i], n.min_y[i], n.min_z[i]},
+          {n.max_x[i], n.max_y[i], n.max_z[i]}
+        };
+        t_entry[i] = box.entry(rd.origin, rd.inv_dir, 0.0, t_max);
+        if (t_entry[i] != std::numeric_limits<double>::infinity()) {
+          mask |= 1U << i;
+        }
+      }
+      return mask;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Un eje del test de slabs para los cuatro hijos. El orden de los operandos de min/max hace
+    // que un NaN (rayo paralelo contenido en el plano de una cara) no recorte el intervalo, como
+    // en AABB::entry.
+    [[gnu::target("avx2")]] inline void slab_avx2(double const * lo, double const * hi, double o,
+                                                  double inv, __m256d & t_lo, __m256d & t_hi) {
+      __m256d const org = _mm256_set1_pd(o);
+      __m256d const id  = _mm256_set1_pd(inv);
+      __m256d const t0  = _mm256_mul_pd(_mm256_sub_pd(_mm256_load_pd(lo), org), id);
+      __m256d const t1  = _mm256_mul_pd(_mm256_sub_pd(_mm256_load_pd(hi), org), id);
+      t_lo              = _mm256_max_pd(_mm256_min_pd(t1, t0), t_lo);
+      t_hi              = _mm256_min_pd(_mm256_max_pd(t1, t0), t_hi);
+    }
+
+    [[gnu::target("avx2")]] unsigned intersect_children_avx2(BVH4Node const & n,
+                                                             RayBoxData const & rd, double t_max,
+                                                             std::array<double, 4> & t_entry) {
+      __m256d t_lo = _mm256_setzero_pd();
+      __m256d t_hi = _mm256_set1_pd(t_max);
+      slab_avx2(n.min_x.data(), n.max_x.data(), rd.origin.x, rd.inv_dir.x, t_lo, t_hi);
+      slab_avx2(n.min_y.data(), n.max_y.data(), rd.origin.y, rd.inv_dir.y, t_lo, t_hi);
+      slab_avx2(n.min_z.data(), n.max_z.data(), rd.origin.z, rd.inv_dir.z, t_lo, t_hi);
+      _mm256_storeu_pd(t_entry.data(), t_lo);
+      auto const hit =
+          static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(t_lo, t_hi, _CMP_LE_OQ)));
+      return hit & ((1U << n.num_children) - 1U);
+    }
+#endif
+
+    using ChildrenTest = unsigned (*)(BVH4Node const &, RayBoxData const &, double,
+                                      std::array<double, 4> &);
+
+    // Selección en tiempo de ejecución según las capacidades de la CPU
+    ChildrenTest select_children_test() {
+#if defined(__x86_64__) || defined(__i386__)
+      if (simd_supported(SimdLevel::avx2)) {
+        return intersect_children_avx2;
+      }
+#endif
+      return intersect_children_scalar;
+    }
+
+    ChildrenTest const children_test = select_children_test();
+
+  }  // namespace
+
+  unsigned BVH4::intersect_children(BVH4Node const & node, RayBoxData const & ray_data,
+                                    double t_max, std::array<double, 4> & t_entry) {
+    return children_test(node, ray_data, t_max, t_entry);
+  }
+
+  bool BVH4::uses_avx2() noexcept {
+    return children_test != intersect_children_scalar;
+  }
+
+  void BVH4::clear() noexcept {
+    nodes_.clear();
+    indices_.clear();
+    root_leaf_   = BVHNode{};
+    root_bounds_ = AABB{};
+  }
+
+  void BVH4::build(BVH const & binary) {
+    clear();
+    if (binary.empty()) {
+      return;
+    }
+    indices_     = binary.indices();
+    root_bounds_ = binary.nodes()[0].bounds;
+    if (binary.nodes()[0].is_leaf()) {
+      root_leaf_ = binary.nodes()[0];
+      return;
+    }
+    nodes_.reserve(binary.nodes().size() / 2 + 1);
+    collapse(binary, 0);
+  }
+
+  // Convierte el nodo interior `node` de la BVH binaria en un nodo de aridad 4, abriendo
+  // repetidamente el hijo interior de mayor área, y devuelve su índice
+  std::uint32_t BVH4::collapse(BVH const & binary, std::uint32_t node) {
+    auto const & bn       = binary.nodes();
+    auto const node_index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    std::array<std::uint32_t, width> kids{node + 1, bn[node].first, 0, 0};
+    std::size_t num_kids = 2;
+    while (num_kids < width) {
+      std::size_t best = width;
+      double best_area = -1.0;
+      for (std::size_t k = 0; k < num_kids; ++k) {
+        double const area = bn[kids[k]].bounds.surface_area();
+        if (not bn[kids[k]].is_leaf() and area > best_area) {
+          best      = k;
+          best_area = area;
+        }
+      }
+      if (best == width) {
+        break;
+      }
+      std::uint32_t const open = kids[best];
+      // se conserva el orden izquierda-derecha de los hijos
+      for (std::size_t k = num_kids; k > best + 1; --k) {
+        kids[k] = kids[k - 1];
+      }
+      kids[best]     = open + 1;
+      kids[best + 1] = bn[open].first;
+      ++num_kids;
+    }
+
+    std::array<std::uint32_t, width> child{};
+    std::array<std::uint32_t, width> count{};
+    for (std::size_t k = 0; k < num_kids; ++k) {
+      BVHNode const & kn = bn[kids[k]];
+      if (kn.is_leaf()) {
+        child[k] = kn.first;
+        count[k] = kn.count;
+      } else {
+        child[k] = collapse(binary, kids[k]);
+        count[k] = 0;
+      }
+    }
+
+    BVH4Node & n   = nodes_[node_index];
+    n.num_children = static_cast<std::uint32_t>(num_kids);
+    for (std::size_t k = 0; k < width; ++k) {
+      // los huecos sin hijo llevan una caja vacía y quedan fuera de la máscara de hijos
+      AABB const box = k < num_kids ? bn[kids[k]].bounds : AABB{};
+      n.min_x[k]     = box.min.x;
+      n.min_y[k]     = box.min.y;
+      n.min_z[k]     = box.min.z;
+      n.max_x[k]     = box.max.x;
+      n.max_y[k]     = box.max.y;
+      n.max_z[k]     = box.max.z;
+      n.child[k]     = child[k];
+      n.count[k]     = count[k];
+    }
+    return node_index;
+  }
+
+}  // namespace render
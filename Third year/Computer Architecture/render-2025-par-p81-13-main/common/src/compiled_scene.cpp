@@ -0,0 +1,141 @@
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <intersection.hpp>
+#include <limits>
+#include <memory>
+#include <object.hpp>
+#include <optional>
+#include <primitive_kernels.hpp>
+#include <ray.hpp>
+#include <sphere.hpp>
+#include <stdexcept>
+#include <vector.hpp>
+#include <vector>
+
+namespace render {
+
+  namespace {
+
+    constexpr double no_hit = std::numeric_limits<double>::infinity();
+
+    // no_hit nunca gana, ni siquiera empatando con el mejor impacto inicial
+    bool closer(double lambda, std::uint32_t obj, PrimHit const & best) {
+      return lambda > CompiledScene::min_lambda and lambda != no_hit and
+             (lambda < best.lambda or (lambda == best.lambda and obj < best.obj));
+    }
+
+  }  // namespace
+
+  void CompiledScene::clear() noexcept {
+    spheres_   = SphereSoA{};
+    cylinders_ = CylinderSoA{};
+    refs_.clear();
+  }
+
+  void CompiledScene::build(std::vector<std::unique_ptr<Object3D>> const & objects) {
+    clear();
+    if (objects.size() >= std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error("too many objects for the compiled scene");
+    }
+    refs_.reserve(objects.size());
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+      auto const obj = static_cast<std::uint32_t>(i);
+      if (auto const * s = dynamic_cast<Sphere const *>(objects[i].get())) {
+        refs_.push_back({PrimKind::sphere, static_cast<std::uint32_t>(spheres_.size())});
+        spheres_.cx.push_back(s->center.x);
+        spheres_.cy.push_back(s->center.y);
+        spheres_.cz.push_back(s->center.z);
+        spheres_.r2.push_back(s->radius * s->radius);
+        spheres_.mat_id.push_back(s->material_id);
+        spheres_.obj_id.push_back(obj);
+      } else if (auto const * c = dynamic_cast<Cylinder const *>(objects[i].get())) {
+        refs_.push_back({PrimKind::cylinder, static_cast<std::uint32_t>(cylinders_.size())});
+        vector const & e   = c->axis();
+        vector const top   = vector::add(c->center, vector::muld(e, c->height() / 2.0));
+        vector const bot   = vector::add(c->center, vector::muld(e, -c->height() / 2.0));
+        vector const bot_n = vector::muld(e, -1.0);
+        auto & cy          = cylinders_;
+        cy.cx.push_back(c->center.x);
+        cy.cy.push_back(c->center.y);
+        cy.cz.push_back(c->center.z);
+        cy.ex.push_back(e.x);
+        cy.ey.push_back(e.y);
+        cy.ez.push_back(e.z);
+        cy.half_h.push_back(c->height() / 2.0);
+        cy.r.push_back(c->radius);
+        cy.r2.push_back(c->radius * c->radius);
+        cy.top_x.push_back(top.x);
+        cy.top_y.push_back(top.y);
+        cy.top_z.push_back(top.z);
+        cy.bot_x.push_back(bot.x);
+        cy.bot_y.push_back(bot.y);
+        cy.bot_z.push_back(bot.z);
+        cy.bot_nx.push_back(bot_n.x);
+        cy.bot_ny.push_back(bot_n.y);
+        cy.bot_nz.push_back(bot_n.z);
+        cy.mat_id.push_back(c->material_id);
+        cy.obj_id.push_back(obj);
+      } else {
+        throw std::invalid_argument("unsupported object type in the scene");
+      }
+    }
+  }
+
+  void CompiledScene::test(std::uint32_t obj, ray const & r, PrimHit & best) const {
+    PrimRef const ref = refs_[obj];
+    if (ref.kind == PrimKind::sphere) {
+      double const lambda = sphere_lambda(spheres_, ref.slot, r);
+      if (closer(lambda, obj, best)) {
+        best = PrimHit{lambda, obj, HitSurface::body};
+      }
+    } else {
+      HitSurface surface  = HitSurface::body;
+      double const lambda = cylinder_lambda(cylinders_, ref.slot, r, surface);
+      if (closer(lambda, obj, best)) {
+        best = PrimHit{lambda, obj, surface};
+      }
+    }
+  }
+
+  PrimHit CompiledScene::closest_all(ray const & r) const {
+    PrimHit best;
+    NearestHit const sphere = nearest_sphere(spheres_, r);
+    if (sphere.found()) {
+      best = PrimHit{sphere.lambda, spheres_.obj_id[sphere.slot], HitSurface::body};
+    }
+    NearestHit const cylinder = nearest_cylinder(cylinders_, r);
+    if (cylinder.found() and closer(cylinder.lambda, cylinders_.obj_id[cylinder.slot], best)) {
+      best = PrimHit{cylinder.lambda, cylinders_.obj_id[cylinder.slot], cylinder.surface};
+    }
+    return best;
+  }
+
+  std::optional<Intersection> CompiledScene::resolve(ray const & r, PrimHit const & hit) const {
+    if (hit.obj >= refs_.size()) {
+      return std::nullopt;
+    }
+    PrimRef const ref  = refs_[hit.obj];
+    vector const punto = vector::add(r.origin, vector::muld(r.direction, hit.lambda));
+    if (ref.kind == PrimKind::sphere) {
+      vector const center{spheres_.cx[ref.slot], spheres_.cy[ref.slot], spheres_.cz[ref.slot]};
+      return Intersection{punto, vector::normalize(vector::sub(punto, center)), hit.lambda,
+                          spheres_.mat_id[ref.slot]};
+    }
+    auto const & cy     = cylinders_;
+    std::size_t const s = ref.slot;
+    vector const e{cy.ex[s], cy.ey[s], cy.ez[s]};
+    vector normal;
+    if (hit.surface == HitSurface::body) {
+      normal = vector::sub(punto, vector{cy.cx[s], cy.cy[s], cy.cz[s]});
+      normal = vector::normalize(vector::sub(normal, vector::muld(e, vector::dotp(normal, e))));
+    } else if (hit.surface == HitSurface::top_cap) {
+      normal = vector::normalize(e);
+    } else {
+      normal = vector::normalize(vector{cy.bot_nx[s], cy.bot_ny[s], cy.bot_nz[s]});
+    }
+    return Intersection{punto, normal, hit.lambda, cy.mat_id[s]};
+  }
+
+}  // namespace render
@@ -46,12 +46,8 @@ namespace {
 
 }  // namespace
 
-void Config::load_config(std::string const & path) {
-  std::ifstream ifs(path);
-  if (!ifs.is_open()) {
-    error_exit("Error: Cannot open configuration file: " + path);
-  }
-  using Handler = void (Config::*)(std::string const &, std::string const &);  // puntero a metodos
+Config::Handler Config::find_handler(std::string const & key) {
+  // puntero a metodos
   static std::unordered_map<std::string, Handler> const handlers = {
     {          "aspect_ratio:",           &Config::set_aspect_ratio},
     {           "image_width:",            &Config::set_image_width},
@@ -65,8 +61,29 @@ void Config::load_config(std::string const & path) {
     {     "material_rng_seed:",      &Config::set_material_rng_seed},
     {          "ray_rng_seed:",           &Config::set_ray_rng_seed},
     { "background_dark_color:",  &Config::set_background_dark_color},
-    {"background_light_color:", &Config::set_background_light_color}
+    {"background_light_color:", &Config::set_background_light_color},
+    {           "accelerator:",            &Config::set_accelerator},
+    {           "packet_size:",            &Config::set_packet_size},
+    {"russian_roulette_depth:", &Config::set_russian_roulette_depth},
+    {               "sampler:",                &Config::set_sampler},
+    {    "adaptive_threshold:",     &Config::set_adaptive_threshold},
+    {  "adaptive_min_samples:",   &Config::set_adaptive_min_samples},
+    {               "threads:",                &Config::set_threads},
+    {             "tile_size:",              &Config::set_tile_size},
+    {           "partitioner:",            &Config::set_partitioner},
+    {                  "numa:",                   &Config::set_numa},
+    {              "exposure:",               &Config::set_exposure},
+    {              "tone_map:",               &Config::set_tone_map}
   };  // tabla de handlers
+  auto it = handlers.find(key);
+  return it == handlers.end() ? nullptr : it->second;
+}
+
+void Config::load_config(std::string const & path) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    error_exit("Error: Cannot open configuration file: " + path);
+  }
   std::string raw;
   while (std::getline(ifs, raw)) {
     std::string const line = trim(raw);
@@ -79,13 +96,20 @@ void Config::load_config(std::string const & path) {
     }
     std::string const key  = trim(line.substr(0, colon + 1));
     std::string const rest = trim(line.substr(colon + 1));
-    auto it                = handlers.find(key);
-    if (it == handlers.end()) {
+    Handler const h        = find_handler(key);
+    if (h == nullptr) {
       error_exit("Error: Unknown configuration key: [" + key + " ]");
     }
-    Handler const h = it->second;  // call handler
-    (this->*h)(raw, rest);
+    (this->*h)(raw, rest);  // call handler
+  }
+}
+
+void Config::set_option(std::string const & key, std::string const & value) {
+  Handler const h = find_handler(key + ":");
+  if (h == nullptr) {
+    error_exit("Error: Unknown configuration key: [" + key + ": ]");
   }
+  (this->*h)(key + ": " + value, trim(value));
 }
 
 void Config::set_aspect_ratio(std::string const & raw, std::string const & rest) {
@@ -300,3 +324,204 @@ void Config::set_background_light_color(std::string const & raw, std::string con
     error_exit("Error: Invalid value for key: [background_light_color: ]", raw);
   }
 }
+
+void Config::set_accelerator(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [accelerator: ]", raw);
+  }
+  if (t[0] == "linear") {
+    accelerator = render::Accelerator::linear;
+  } else if (t[0] == "bvh2") {
+    accelerator = render::Accelerator::bvh2;
+  } else if (t[0] == "bvh4") {
+    accelerator = render::Accelerator::bvh4;
+  } else {
+    error_exit("Error: Invalid value for key: [accelerator: ]", raw);
+  }
+  _seen["accelerator:"]++;
+}
+
+void Config::set_packet_size(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [packet_size: ]", raw);
+  }
+  try {
+    int const v = stoi(t[0]);
+    if (v != 1 and v != 2 and v != 4 and v != 8) {
+      throw std::logic_error("unsupported packet size");
+    }
+    packet_size = v;
+    _seen["packet_size:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [packet_size: ]", raw);
+  }
+}
+
+void Config::set_russian_roulette_depth(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [russian_roulette_depth: ]", raw);
+  }
+  try {
+    int const v = stoi(t[0]);
+    if (v < 0) {
+      throw std::logic_error("negative");
+    }
+    russian_roulette_depth = v;
+    _seen["russian_roulette_depth:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [russian_roulette_depth: ]", raw);
+  }
+}
+
+void Config::set_sampler(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [sampler: ]", raw);
+  }
+  if (t[0] == "random") {
+    sampler = render::SamplerKind::random;
+  } else if (t[0] == "sobol") {
+    sampler = render::SamplerKind::sobol;
+  } else {
+    error_exit("Error: Invalid value for key: [sampler: ]", raw);
+  }
+  _seen["sampler:"]++;
+}
+
+void Config::set_adaptive_threshold(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [adaptive_threshold: ]", raw);
+  }
+  try {
+    double const v = stod(t[0]);
+    if (not std::isfinite(v) or v < 0) {
+      throw std::logic_error("negative or not finite");
+    }
+    adaptive_threshold = v;
+    _seen["adaptive_threshold:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [adaptive_threshold: ]", raw);
+  }
+}
+
+void Config::set_adaptive_min_samples(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [adaptive_min_samples: ]", raw);
+  }
+  try {
+    int const v = stoi(t[0]);
+    // la varianza necesita al menos dos muestras
+    if (v < 2) {
+      throw std::logic_error("too few samples");
+    }
+    adaptive_min_samples = v;
+    _seen["adaptive_min_samples:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [adaptive_min_samples: ]", raw);
+  }
+}
+
+void Config::set_threads(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [threads: ]", raw);
+  }
+  try {
+    int const v = stoi(t[0]);
+    if (v < 0) {
+      throw std::logic_error("negative");
+    }
+    threads = v;
+    _seen["threads:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [threads: ]", raw);
+  }
+}
+
+void Config::set_tile_size(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [tile_size: ]", raw);
+  }
+  try {
+    int const v = stoi(t[0]);
+    if (v <= 0) {
+      throw std::logic_error("non-positive");
+    }
+    tile_size = v;
+    _seen["tile_size:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [tile_size: ]", raw);
+  }
+}
+
+void Config::set_partitioner(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [partitioner: ]", raw);
+  }
+  if (t[0] == "simple") {
+    partitioner = render::Partitioner::simple;
+  } else if (t[0] == "auto") {
+    partitioner = render::Partitioner::automatic;
+  } else if (t[0] == "affinity") {
+    partitioner = render::Partitioner::affinity;
+  } else {
+    error_exit("Error: Invalid value for key: [partitioner: ]", raw);
+  }
+  _seen["partitioner:"]++;
+}
+
+void Config::set_numa(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [numa: ]", raw);
+  }
+  if (t[0] == "on") {
+    numa = true;
+  } else if (t[0] == "off") {
+    numa = false;
+  } else {
+    error_exit("Error: Invalid value for key: [numa: ]", raw);
+  }
+  _seen["numa:"]++;
+}
+
+void Config::set_exposure(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [exposure: ]", raw);
+  }
+  try {
+    double const v = stod(t[0]);
+    if (not std::isfinite(v)) {
+      throw std::logic_error("not finite");
+    }
+    exposure = v;
+    _seen["exposure:"]++;
+  } catch (...) {
+    error_exit("Error: Invalid value for key: [exposure: ]", raw);
+  }
+}
+
+void Config::set_tone_map(std::string const & raw, std::string const & rest) {
+  std::vector<std::string> t = split_ws(rest);
+  if (t.size() != 1) {
+    error_exit("Error: Invalid value for key: [tone_map: ]", raw);
+  }
+  if (t[0] == "none") {
+    tone_map = render::ToneMap::none;
+  } else if (t[0] == "reinhard") {
+    tone_map = render::ToneMap::reinhard;
+  } else if (t[0] == "aces") {
+    tone_map = render::ToneMap::aces;
+  } else {
+    error_exit("Error: Invalid value for key: [tone_map: ]", raw);
+  }
+  _seen["tone_map:"]++;
+}
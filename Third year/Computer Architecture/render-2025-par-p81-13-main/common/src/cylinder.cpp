@@ -1,6 +1,9 @@
+#include <aabb.hpp>
+#include <algorithm>
 #include <cmath>
 #include <cylinder.hpp>
 #include <intersection.hpp>
+#include <memory>
 #include <optional>
 #include <ray.hpp>
 #include <string>
@@ -15,6 +18,20 @@ namespace render {
     material_name = m;
   }
 
+  std::unique_ptr<Object3D> Cylinder::clone() const {
+    return std::make_unique<Cylinder>(*this);
+  }
+
+  // Caja del cilindro: semieje a lo largo del eje más el disco de radio r proyectado en cada eje
+  AABB Cylinder::bounds() const {
+    double const h = altura / 2.0;
+    auto extent    = [&](double e) {
+      return std::fabs(e) * h + radius * std::sqrt(std::max(0.0, 1.0 - e * e));
+    };
+    vector const ext{extent(ejes.x), extent(ejes.y), extent(ejes.z)};
+    return AABB{vector::sub(center, ext), vector::add(center, ext)}.padded();
+  }
+
   std::optional<Intersection> Cylinder::collision(ray const & r) const {
     auto lateral            = intersect_lateral(r);
     vector const p_superior = vector::add(center, vector::muld(ejes, altura / 2.0));
@@ -59,7 +76,7 @@ namespace render {
         vector normal = vector::sub(punto_interseccion, center);
         normal        = vector::sub(normal, vector::muld(ejes, vector::dotp(normal, ejes)));
         normal        = vector::normalize(normal);
-        return Intersection{punto_interseccion, normal, lambda1, material_name};
+        return Intersection{punto_interseccion, normal, lambda1, material_id};
       }
     }
     if (lambda2 > epsilon) {  // 2. Si la primera no valía, probamos la segunda (salida)
@@ -69,7 +86,7 @@ namespace render {
         vector normal = vector::sub(punto_interseccion, center);
         normal        = vector::sub(normal, vector::muld(ejes, vector::dotp(normal, ejes)));
         normal        = vector::normalize(normal);
-        return Intersection{punto_interseccion, normal, lambda2, material_name};
+        return Intersection{punto_interseccion, normal, lambda2, material_id};
       }
     }
     return std::nullopt;
@@ -90,7 +107,7 @@ namespace render {
         vector::add(r.origin, vector::muld(r.direction, lambda));  // vector punto interseccion
     if (vector::sub(punto_interseccion, P).magnitude() <= radius) {
       vector const normal_base = vector::normalize(n);
-      return Intersection{punto_interseccion, normal_base, lambda, material_name};
+      return Intersection{punto_interseccion, normal_base, lambda, material_id};
     }
     return std::nullopt;  // fuera del radio
   }
@@ -0,0 +1,459 @@
+#include <array>
+#include <cmath>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <primitive_kernels.hpp>
+#include <ray.hpp>
+#include <simd.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace render {
+
+  namespace {
+
+    constexpr double no_hit = std::numeric_limits<double>::infinity();
+
+    double dot3(double ax, double ay, double az, double bx, double by, double bz) {
+      return ax * bx + ay * by + az * bz;
+    }
+
+    // Impacto con una tapa de centro (px, py, pz) y normal (nx, ny, nz)
+    double cap_lambda(ray const & r, double px, double py, double pz, double nx, double ny,
+                      double nz, double radius) {
+      double const den = dot3(r.direction.x, r.direction.y, r.direction.z, nx, ny, nz);
+      if (std::fabs(den) < 1e-6) {
+        return no_hit;
+      }
+      double const num    = dot3(px - r.origin.x, py - r.origin.y, pz - r.origin.z, nx, ny, nz);
+      double const lambda = num / den;
+      if (lambda < 1e-3) {
+        return no_hit;
+      }
+      double const qx = (r.origin.x + r.direction.x * lambda) - px;
+      double const qy = (r.origin.y + r.direction.y * lambda) - py;
+      double const qz = (r.origin.z + r.direction.z * lambda) - pz;
+      return std::sqrt(qx * qx + qy * qy + qz * qz) <= radius ? lambda : no_hit;
+    }
+
+    NearestHit nearest_cylinder_scalar(CylinderSoA const & cy, std::size_t begin, ray const & r,
+                                       NearestHit best) {
+      for (std::size_t s = begin; s < cy.size(); ++s) {
+        HitSurface surface  = HitSurface::body;
+        double const lambda = cylinder_lambda(cy, s, r, surface);
+        if (lambda > CompiledScene::min_lambda and lambda < best.lambda) {
+          best = NearestHit{lambda, static_cast<std::uint32_t>(s), surface};
+        }
+      }
+      return best;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Mejor impacto entre los carriles: menor lambda y, a igualdad, menor posición. La
+    // superficie se guarda en los carriles como 0 (lateral), 1 (tapa superior) o 2 (inferior).
+    template <std::size_t N>
+    NearestHit reduce_lanes(std::array<double, N> const & t, std::array<double, N> const & idx,
+                            std::array<double, N> const & surf) {
+      NearestHit best;
+      for (std::size_t i = 0; i < N; ++i) {
+        if (t[i] == no_hit) {
+          continue;
+        }
+        auto const slot = static_cast<std::uint32_t>(idx[i]);
+        if (t[i] < best.lambda or (t[i] == best.lambda and slot < best.slot)) {
+          best = NearestHit{t[i], slot, static_cast<HitSurface>(static_cast<int>(surf[i]))};
+        }
+      }
+      return best;
+    }
+
+    // Tapa de centro p y normal n para cuatro cilindros; igual que cap_lambda
+    [[gnu::target("avx2")]] inline __m256d cap_avx2(__m256d ox, __m256d oy, __m256d oz,
+                                                    __m256d dx, __m256d dy, __m256d dz,
+                                                    __m256d px, __m256d py, __m256d pz,
+                                                    __m256d nx, __m256d ny, __m256d nz,
+                                                    __m256d radius) {
+      __m256d const sign_mask = _mm256_set1_pd(-0.0);
+      __m256d const den       = _mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(dx, nx), _mm256_mul_pd(dy, ny)), _mm256_mul_pd(dz, nz));
+      __m256d const num = _mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(px, ox), nx),
+                        _mm256_mul_pd(_mm256_sub_pd(py, oy), ny)),
+          _mm256_mul_pd(_mm256_sub_pd(pz, oz), nz));
+      __m256d const lambda = _mm256_div_pd(num, den);
+      __m256d const qx     = _mm256_sub_pd(_mm256_add_pd(ox, _mm256_mul_pd(dx, lambda)), px);
+      __m256d const qy     = _mm256_sub_pd(_mm256_add_pd(oy, _mm256_mul_pd(dy, lambda)), py);
+      __m256d const qz     = _mm256_sub_pd(_mm256_add_pd(oz, _mm256_mul_pd(dz, lambda)), pz);
+      __m256d const dist   = _mm256_sqrt_pd(_mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(qx, qx), _mm256_mul_pd(qy, qy)), _mm256_mul_pd(qz, qz)));
+      __m256d hit = _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, den), _mm256_set1_pd(1e-6),
+                                  _CMP_NLT_UQ);
+      hit         = _mm256_and_pd(hit, _mm256_cmp_pd(lambda, _mm256_set1_pd(1e-3), _CMP_NLT_UQ));
+      hit         = _mm256_and_pd(hit, _mm256_cmp_pd(dist, radius, _CMP_LE_OQ));
+      return _mm256_blendv_pd(_mm256_set1_pd(no_hit), lambda, hit);
+    }
+
+    // Raíz lateral l válida: delante del rayo y con la altura del impacto dentro del cilindro
+    [[gnu::target("avx2")]] inline __m256d inside_avx2(__m256d l, __m256d ox, __m256d oy,
+                                                       __m256d oz, __m256d dx, __m256d dy,
+                                                       __m256d dz, __m256d cx, __m256d cy,
+                                                       __m256d cz, __m256d ex, __m256d ey,
+                                                       __m256d ez, __m256d hh) {
+      __m256d const hx = _mm256_sub_pd(_mm256_add_pd(ox, _mm256_mul_pd(dx, l)), cx);
+      __m256d const hy = _mm256_sub_pd(_mm256_add_pd(oy, _mm256_mul_pd(dy, l)), cy);
+      __m256d const hz = _mm256_sub_pd(_mm256_add_pd(oz, _mm256_mul_pd(dz, l)), cz);
+      __m256d const h  = _mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(hx, ex), _mm256_mul_pd(hy, ey)), _mm256_mul_pd(hz, ez));
+      __m256d ok = _mm256_cmp_pd(l, _mm256_set1_pd(1e-3), _CMP_GT_OQ);
+      ok         = _mm256_and_pd(ok, _mm256_cmp_pd(h, hh, _CMP_LE_OQ));
+      return _mm256_and_pd(
+          ok, _mm256_cmp_pd(h, _mm256_xor_pd(hh, _mm256_set1_pd(-0.0)), _CMP_GE_OQ));
+    }
+
+    // Cada carril repite las operaciones de cylinder_lambda sin FMA, así que los lambdas
+    // coinciden bit a bit con la versión escalar
+    [[gnu::target("avx2")]] NearestHit nearest_cylinder_avx2(CylinderSoA const & cy,
+                                                             ray const & r) {
+      __m256d const ox        = _mm256_set1_pd(r.origin.x);
+      __m256d const oy        = _mm256_set1_pd(r.origin.y);
+      __m256d const oz        = _mm256_set1_pd(r.origin.z);
+      __m256d const dx        = _mm256_set1_pd(r.direction.x);
+      __m256d const dy        = _mm256_set1_pd(r.direction.y);
+      __m256d const dz        = _mm256_set1_pd(r.direction.z);
+      __m256d const sign_mask = _mm256_set1_pd(-0.0);
+      __m256d const minus_one = _mm256_set1_pd(-1.0);
+      __m256d const two       = _mm256_set1_pd(2.0);
+      __m256d const four      = _mm256_set1_pd(4.0);
+      __m256d const tiny      = _mm256_set1_pd(1e-8);
+      __m256d const inf       = _mm256_set1_pd(no_hit);
+      __m256d const min_l     = _mm256_set1_pd(CompiledScene::min_lambda);
+
+      __m256d best_t     = inf;
+      __m256d best_i     = _mm256_setzero_pd();
+      __m256d best_s     = _mm256_setzero_pd();
+      __m256d idx        = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+      __m256d const step = _mm256_set1_pd(4.0);
+
+      std::size_t const n = cy.size();
+      std::size_t s       = 0;
+      for (; s + 4 <= n; s += 4) {
+        __m256d const cx  = _mm256_loadu_pd(cy.cx.data() + s);
+        __m256d const cyv = _mm256_loadu_pd(cy.cy.data() + s);
+        __m256d const cz  = _mm256_loadu_pd(cy.cz.data() + s);
+        __m256d const ex  = _mm256_loadu_pd(cy.ex.data() + s);
+        __m256d const ey  = _mm256_loadu_pd(cy.ey.data() + s);
+        __m256d const ez  = _mm256_loadu_pd(cy.ez.data() + s);
+        __m256d const hh  = _mm256_loadu_pd(cy.half_h.data() + s);
+
+        // superficie lateral
+        __m256d const rcx = _mm256_sub_pd(ox, cx);
+        __m256d const rcy = _mm256_sub_pd(oy, cyv);
+        __m256d const rcz = _mm256_sub_pd(oz, cz);
+        __m256d const dd  = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(dx, ex), _mm256_mul_pd(dy, ey)), _mm256_mul_pd(dz, ez));
+        __m256d const dpx = _mm256_sub_pd(dx, _mm256_mul_pd(ex, dd));
+        __m256d const dpy = _mm256_sub_pd(dy, _mm256_mul_pd(ey, dd));
+        __m256d const dpz = _mm256_sub_pd(dz, _mm256_mul_pd(ez, dd));
+        __m256d const rd  = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(rcx, ex), _mm256_mul_pd(rcy, ey)), _mm256_mul_pd(rcz, ez));
+        __m256d const rpx = _mm256_sub_pd(rcx, _mm256_mul_pd(ex, rd));
+        __m256d const rpy = _mm256_sub_pd(rcy, _mm256_mul_pd(ey, rd));
+        __m256d const rpz = _mm256_sub_pd(rcz, _mm256_mul_pd(ez, rd));
+        __m256d const a   = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(dpx, dpx), _mm256_mul_pd(dpy, dpy)),
+            _mm256_mul_pd(dpz, dpz));
+        __m256d const b = _mm256_mul_pd(
+            two, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dpx, rpx), _mm256_mul_pd(dpy, rpy)),
+                               _mm256_mul_pd(dpz, rpz)));
+        __m256d const c = _mm256_sub_pd(
+            _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(rpx, rpx), _mm256_mul_pd(rpy, rpy)),
+                          _mm256_mul_pd(rpz, rpz)),
+            _mm256_loadu_pd(cy.r2.data() + s));
+        __m256d const disc =
+            _mm256_sub_pd(_mm256_mul_pd(b, b), _mm256_mul_pd(_mm256_mul_pd(four, a), c));
+        __m256d const quad_ok =
+            _mm256_and_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign_mask, a), tiny, _CMP_GE_OQ),
+                          _mm256_cmp_pd(disc, tiny, _CMP_GE_OQ));
+        __m256d const raiz  = _mm256_sqrt_pd(disc);
+        __m256d const neg_b = _mm256_mul_pd(b, minus_one);
+        __m256d const two_a = _mm256_mul_pd(two, a);
+        __m256d const l1    = _mm256_div_pd(_mm256_sub_pd(neg_b, raiz), two_a);
+        __m256d const l2    = _mm256_div_pd(_mm256_add_pd(neg_b, raiz), two_a);
+        __m256d const in1 = _mm256_and_pd(
+            quad_ok, inside_avx2(l1, ox, oy, oz, dx, dy, dz, cx, cyv, cz, ex, ey, ez, hh));
+        __m256d const in2 = _mm256_and_pd(
+            quad_ok, inside_avx2(l2, ox, oy, oz, dx, dy, dz, cx, cyv, cz, ex, ey, ez, hh));
+        __m256d t         = _mm256_blendv_pd(_mm256_blendv_pd(inf, l2, in2), l1, in1);
+        __m256d surf      = _mm256_setzero_pd();
+
+        // tapas
+        __m256d const radius = _mm256_loadu_pd(cy.r.data() + s);
+        __m256d const top    = cap_avx2(
+            ox, oy, oz, dx, dy, dz, _mm256_loadu_pd(cy.top_x.data() + s),
+            _mm256_loadu_pd(cy.top_y.data() + s), _mm256_loadu_pd(cy.top_z.data() + s), ex, ey,
+            ez, radius);
+        __m256d const bot = cap_avx2(
+            ox, oy, oz, dx, dy, dz, _mm256_loadu_pd(cy.bot_x.data() + s),
+            _mm256_loadu_pd(cy.bot_y.data() + s), _mm256_loadu_pd(cy.bot_z.data() + s),
+            _mm256_loadu_pd(cy.bot_nx.data() + s), _mm256_loadu_pd(cy.bot_ny.data() + s),
+            _mm256_loadu_pd(cy.bot_nz.data() + s), radius);
+        __m256d const top_closer = _mm256_cmp_pd(top, t, _CMP_LT_OQ);
+        t                        = _mm256_blendv_pd(t, top, top_closer);
+        surf                     = _mm256_blendv_pd(surf, _mm256_set1_pd(1.0), top_closer);
+        __m256d const bot_closer = _mm256_cmp_pd(bot, t, _CMP_LT_OQ);
+        t                        = _mm256_blendv_pd(t, bot, bot_closer);
+        surf                     = _mm256_blendv_pd(surf, two, bot_closer);
+
+        __m256d const better = _mm256_and_pd(_mm256_cmp_pd(t, min_l, _CMP_GT_OQ),
+                                             _mm256_cmp_pd(t, best_t, _CMP_LT_OQ));
+        best_t               = _mm256_blendv_pd(best_t, t, better);
+        best_i               = _mm256_blendv_pd(best_i, idx, better);
+        best_s               = _mm256_blendv_pd(best_s, surf, better);
+        idx                  = _mm256_add_pd(idx, step);
+      }
+      std::array<double, 4> t_lanes{};
+      std::array<double, 4> i_lanes{};
+      std::array<double, 4> s_lanes{};
+      _mm256_storeu_pd(t_lanes.data(), best_t);
+      _mm256_storeu_pd(i_lanes.data(), best_i);
+      _mm256_storeu_pd(s_lanes.data(), best_s);
+      return nearest_cylinder_scalar(cy, s, r, reduce_lanes(t_lanes, i_lanes, s_lanes));
+    }
+
+    // Los intrínsecos de AVX-512 de GCC 12 usan _mm512_undefined_pd como operando de paso y
+    // provocan falsos avisos de variable sin inicializar
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    [[gnu::target("avx512f")]] inline __m512d cap_avx512(__m512d ox, __m512d oy, __m512d oz,
+                                                         __m512d dx, __m512d dy, __m512d dz,
+                                                         __m512d px, __m512d py, __m512d pz,
+                                                         __m512d nx, __m512d ny, __m512d nz,
+                                                         __m512d radius) {
+      __m512d const den = _mm512_add_pd(
+          _mm512_add_pd(_mm512_mul_pd(dx, nx), _mm512_mul_pd(dy, ny)), _mm512_mul_pd(dz, nz));
+      __m512d const num = _mm512_add_pd(
+          _mm512_add_pd(_mm512_mul_pd(_mm512_sub_pd(px, ox), nx),
+                        _mm512_mul_pd(_mm512_sub_pd(py, oy), ny)),
+          _mm512_mul_pd(_mm512_sub_pd(pz, oz), nz));
+      __m512d const lambda = _mm512_div_pd(num, den);
+      __m512d const qx     = _mm512_sub_pd(_mm512_add_pd(ox, _mm512_mul_pd(dx, lambda)), px);
+      __m512d const qy     = _mm512_sub_pd(_mm512_add_pd(oy, _mm512_mul_pd(dy, lambda)), py);
+      __m512d const qz     = _mm512_sub_pd(_mm512_add_pd(oz, _mm512_mul_pd(dz, lambda)), pz);
+      __m512d const dist   = _mm512_sqrt_pd(_mm512_add_pd(
+          _mm512_add_pd(_mm512_mul_pd(qx, qx), _mm512_mul_pd(qy, qy)), _mm512_mul_pd(qz, qz)));
+      auto const hit = static_cast<__mmask8>(
+          _mm512_cmp_pd_mask(_mm512_abs_pd(den), _mm512_set1_pd(1e-6), _CMP_NLT_UQ) &
+          _mm512_cmp_pd_mask(lambda, _mm512_set1_pd(1e-3), _CMP_NLT_UQ) &
+          _mm512_cmp_pd_mask(dist, radius, _CMP_LE_OQ));
+      return _mm512_mask_blend_pd(hit, _mm512_set1_pd(no_hit), lambda);
+    }
+
+    [[gnu::target("avx512f")]] inline __mmask8 inside_avx512(__m512d l, __m512d ox, __m512d oy,
+                                                             __m512d oz, __m512d dx, __m512d dy,
+                                                             __m512d dz, __m512d cx, __m512d cy,
+                                                             __m512d cz, __m512d ex, __m512d ey,
+                                                             __m512d ez, __m512d hh) {
+      __m512d const hx = _mm512_sub_pd(_mm512_add_pd(ox, _mm512_mul_pd(dx, l)), cx);
+      __m512d const hy = _mm512_sub_pd(_mm512_add_pd(oy, _mm512_mul_pd(dy, l)), cy);
+      __m512d const hz = _mm512_sub_pd(_mm512_add_pd(oz, _mm512_mul_pd(dz, l)), cz);
+      __m512d const h  = _mm512_add_pd(
+          _mm512_add_pd(_mm512_mul_pd(hx, ex), _mm512_mul_pd(hy, ey)), _mm512_mul_pd(hz, ez));
+      return static_cast<__mmask8>(
+          _mm512_cmp_pd_mask(l, _mm512_set1_pd(1e-3), _CMP_GT_OQ) &
+          _mm512_cmp_pd_mask(h, hh, _CMP_LE_OQ) &
+          _mm512_cmp_pd_mask(h, _mm512_mul_pd(hh, _mm512_set1_pd(-1.0)), _CMP_GE_OQ));
+    }
+
+    [[gnu::target("avx512f")]] NearestHit nearest_cylinder_avx512(CylinderSoA const & cy,
+                                                                  ray const & r) {
+      __m512d const ox        = _mm512_set1_pd(r.origin.x);
+      __m512d const oy        = _mm512_set1_pd(r.origin.y);
+      __m512d const oz        = _mm512_set1_pd(r.origin.z);
+      __m512d const dx        = _mm512_set1_pd(r.direction.x);
+      __m512d const dy        = _mm512_set1_pd(r.direction.y);
+      __m512d const dz        = _mm512_set1_pd(r.direction.z);
+      __m512d const minus_one = _mm512_set1_pd(-1.0);
+      __m512d const two       = _mm512_set1_pd(2.0);
+      __m512d const four      = _mm512_set1_pd(4.0);
+      __m512d const tiny      = _mm512_set1_pd(1e-8);
+      __m512d const inf       = _mm512_set1_pd(no_hit);
+      __m512d const min_l     = _mm512_set1_pd(CompiledScene::min_lambda);
+
+      __m512d best_t     = inf;
+      __m512d best_i     = _mm512_setzero_pd();
+      __m512d best_s     = _mm512_setzero_pd();
+      __m512d idx        = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+      __m512d const step = _mm512_set1_pd(8.0);
+
+      std::size_t const n = cy.size();
+      std::size_t s       = 0;
+      for (; s + 8 <= n; s += 8) {
+        __m512d const cx  = _mm512_loadu_pd(cy.cx.data() + s);
+        __m512d const cyv = _mm512_loadu_pd(cy.cy.data() + s);
+        __m512d const cz  = _mm512_loadu_pd(cy.cz.data() + s);
+        __m512d const ex  = _mm512_loadu_pd(cy.ex.data() + s);
+        __m512d const ey  = _mm512_loadu_pd(cy.ey.data() + s);
+        __m512d const ez  = _mm512_loadu_pd(cy.ez.data() + s);
+        __m512d const hh  = _mm512_loadu_pd(cy.half_h.data() + s);
+
+        // superficie lateral
+        __m512d const rcx = _mm512_sub_pd(ox, cx);
+        __m512d const rcy = _mm512_sub_pd(oy, cyv);
+        __m512d const rcz = _mm512_sub_pd(oz, cz);
+        __m512d const dd  = _mm512_add_pd(
+            _mm512_add_pd(_mm512_mul_pd(dx, ex), _mm512_mul_pd(dy, ey)), _mm512_mul_pd(dz, ez));
+        __m512d const dpx = _mm512_sub_pd(dx, _mm512_mul_pd(ex, dd));
+        __m512d const dpy = _mm512_sub_pd(dy, _mm512_mul_pd(ey, dd));
+        __m512d const dpz = _mm512_sub_pd(dz, _mm512_mul_pd(ez, dd));
+        __m512d const rd  = _mm512_add_pd(
+            _mm512_add_pd(_mm512_mul_pd(rcx, ex), _mm512_mul_pd(rcy, ey)), _mm512_mul_pd(rcz, ez));
+        __m512d const rpx = _mm512_sub_pd(rcx, _mm512_mul_pd(ex, rd));
+        __m512d const rpy = _mm512_sub_pd(rcy, _mm512_mul_pd(ey, rd));
+        __m512d const rpz = _mm512_sub_pd(rcz, _mm512_mul_pd(ez, rd));
+        __m512d const a   = _mm512_add_pd(
+            _mm512_add_pd(_mm512_mul_pd(dpx, dpx), _mm512_mul_pd(dpy, dpy)),
+            _mm512_mul_pd(dpz, dpz));
+        __m512d const b = _mm512_mul_pd(
+            two, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dpx, rpx), _mm512_mul_pd(dpy, rpy)),
+                               _mm512_mul_pd(dpz, rpz)));
+        __m512d const c = _mm512_sub_pd(
+            _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(rpx, rpx), _mm512_mul_pd(rpy, rpy)),
+                          _mm512_mul_pd(rpz, rpz)),
+            _mm512_loadu_pd(cy.r2.data() + s));
+        __m512d const disc =
+            _mm512_sub_pd(_mm512_mul_pd(b, b), _mm512_mul_pd(_mm512_mul_pd(four, a), c));
+        auto const quad_ok = static_cast<__mmask8>(
+            _mm512_cmp_pd_mask(_mm512_abs_pd(a), tiny, _CMP_GE_OQ) &
+            _mm512_cmp_pd_mask(disc, tiny, _CMP_GE_OQ));
+        __m512d const raiz  = _mm512_sqrt_pd(disc);
+        __m512d const neg_b = _mm512_mul_pd(b, minus_one);
+        __m512d const two_a = _mm512_mul_pd(two, a);
+        __m512d const l1    = _mm512_div_pd(_mm512_sub_pd(neg_b, raiz), two_a);
+        __m512d const l2    = _mm512_div_pd(_mm512_add_pd(neg_b, raiz), two_a);
+        auto const in1 = static_cast<__mmask8>(
+            quad_ok & inside_avx512(l1, ox, oy, oz, dx, dy, dz, cx, cyv, cz, ex, ey, ez, hh));
+        auto const in2 = static_cast<__mmask8>(
+            quad_ok & inside_avx512(l2, ox, oy, oz, dx, dy, dz, cx, cyv, cz, ex, ey, ez, hh));
+        __m512d t      = _mm512_mask_blend_pd(in1, _mm512_mask_blend_pd(in2, inf, l2), l1);
+        __m512d surf   = _mm512_setzero_pd();
+
+        // tapas
+        __m512d const radius = _mm512_loadu_pd(cy.r.data() + s);
+        __m512d const top    = cap_avx512(
+            ox, oy, oz, dx, dy, dz, _mm512_loadu_pd(cy.top_x.data() + s),
+            _mm512_loadu_pd(cy.top_y.data() + s), _mm512_loadu_pd(cy.top_z.data() + s), ex, ey,
+            ez, radius);
+        __m512d const bot = cap_avx512(
+            ox, oy, oz, dx, dy, dz, _mm512_loadu_pd(cy.bot_x.data() + s),
+            _mm512_loadu_pd(cy.bot_y.data() + s), _mm512_loadu_pd(cy.bot_z.data() + s),
+            _mm512_loadu_pd(cy.bot_nx.data() + s), _mm512_loadu_pd(cy.bot_ny.data() + s),
+            _mm512_loadu_pd(cy.bot_nz.data() + s), radius);
+        __mmask8 const top_closer = _mm512_cmp_pd_mask(top, t, _CMP_LT_OQ);
+        t                         = _mm512_mask_blend_pd(top_closer, t, top);
+        surf = _mm512_mask_blend_pd(top_closer, surf, _mm512_set1_pd(1.0));
+        __mmask8 const bot_closer = _mm512_cmp_pd_mask(bot, t, _CMP_LT_OQ);
+        t                         = _mm512_mask_blend_pd(bot_closer, t, bot);
+        surf                      = _mm512_mask_blend_pd(bot_closer, surf, two);
+
+        auto const better = static_cast<__mmask8>(_mm512_cmp_pd_mask(t, min_l, _CMP_GT_OQ) &
+                                                  _mm512_cmp_pd_mask(t, best_t, _CMP_LT_OQ));
+        best_t = _mm512_mask_blend_pd(better, best_t, t);
+        best_i = _mm512_mask_blend_pd(better, best_i, idx);
+        best_s = _mm512_mask_blend_pd(better, best_s, surf);
+        idx    = _mm512_add_pd(idx, step);
+      }
+      std::array<double, 8> t_lanes{};
+      std::array<double, 8> i_lanes{};
+      std::array<double, 8> s_lanes{};
+      _mm512_storeu_pd(t_lanes.data(), best_t);
+      _mm512_storeu_pd(i_lanes.data(), best_i);
+      _mm512_storeu_pd(s_lanes.data(), best_s);
+      return nearest_cylinder_scalar(cy, s, r, reduce_lanes(t_lanes, i_lanes, s_lanes));
+    }
+  #pragma GCC diagnostic pop
+#endif
+
+  }  // namespace
+
+  double cylinder_lambda(CylinderSoA const & cy, std::size_t s, ray const & r,
+                         HitSurface & surface) {
+    double const ex = cy.ex[s];
+    double const ey = cy.ey[s];
+    double const ez = cy.ez[s];
+
+    // superficie lateral: primera raíz cuya altura cae dentro del cilindro
+    double lateral   = no_hit;
+    double const rcx = r.origin.x - cy.cx[s];
+    double const rcy = r.origin.y - cy.cy[s];
+    double const rcz = r.origin.z - cy.cz[s];
+    double const dd  = dot3(r.direction.x, r.direction.y, r.direction.z, ex, ey, ez);
+    double const dpx = r.direction.x - ex * dd;
+    double const dpy = r.direction.y - ey * dd;
+    double const dpz = r.direction.z - ez * dd;
+    double const rd  = dot3(rcx, rcy, rcz, ex, ey, ez);
+    double const rpx = rcx - ex * rd;
+    double const rpy = rcy - ey * rd;
+    double const rpz = rcz - ez * rd;
+    double const a   = dot3(dpx, dpy, dpz, dpx, dpy, dpz);
+    double const b   = 2.0 * dot3(dpx, dpy, dpz, rpx, rpy, rpz);
+    double const c   = dot3(rpx, rpy, rpz, rpx, rpy, rpz) - cy.r2[s];
+    if (std::abs(a) >= 1e-8) {
+      double const disc = b * b - 4.0 * a * c;
+      if (disc >= 1e-8) {
+        double const raiz = std::sqrt(disc);
+        for (double const lambda : {(-b - raiz) / (2.0 * a), (-b + raiz) / (2.0 * a)}) {
+          if (lambda > 1e-3) {
+            double const hx = (r.origin.x + r.direction.x * lambda) - cy.cx[s];
+            double const hy = (r.origin.y + r.direction.y * lambda) - cy.cy[s];
+            double const hz = (r.origin.z + r.direction.z * lambda) - cy.cz[s];
+            double const h  = dot3(hx, hy, hz, ex, ey, ez);
+            if (h <= cy.half_h[s] and h >= -cy.half_h[s]) {
+              lateral = lambda;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    double const top = cap_lambda(r, cy.top_x[s], cy.top_y[s], cy.top_z[s], ex, ey, ez, cy.r[s]);
+    double const bot = cap_lambda(r, cy.bot_x[s], cy.bot_y[s], cy.bot_z[s], cy.bot_nx[s],
+                                  cy.bot_ny[s], cy.bot_nz[s], cy.r[s]);
+    double best = lateral;
+    surface     = HitSurface::body;
+    if (top < best) {
+      best    = top;
+      surface = HitSurface::top_cap;
+    }
+    if (bot < best) {
+      best    = bot;
+      surface = HitSurface::bottom_cap;
+    }
+    return best;
+  }
+
+  NearestHit nearest_cylinder(CylinderSoA const & cylinders, ray const & r, SimdLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level) {
+      case SimdLevel::avx512:
+        return nearest_cylinder_avx512(cylinders, r);
+      case SimdLevel::avx2:
+        return nearest_cylinder_avx2(cylinders, r);
+      case SimdLevel::scalar:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    return nearest_cylinder_scalar(cylinders, 0, r, NearestHit{});
+  }
+
+  NearestHit nearest_cylinder(CylinderSoA const & cylinders, ray const & r) {
+    return nearest_cylinder(cylinders, r, cpu_simd_level());
+  }
+
+}  // namespace render
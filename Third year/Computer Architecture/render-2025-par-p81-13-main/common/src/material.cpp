@@ -1,11 +1,65 @@
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <material.hpp>
-#include <random>
+#include <sampler.hpp>
 #include <string>
 #include <utility>
 #include <vector.hpp>
+#include <vector>
+
+namespace {
+
+  // normalize de render::vector sobre componentes sueltas, con las mismas operaciones
+  inline void normalize3(double & x, double & y, double & z) {
+    double const n = std::sqrt(x * x + y * y + z * z);
+    if (n != 0.0) {
+      x = x / n;
+      y = y / n;
+      z = z / n;
+    }
+  }
+
+  // Normal unitaria orientada contra el rayo, como en Matte::scatter y Metal::scatter
+  inline void facing_normal(ScatterBatch const & batch, std::size_t i, double & nx, double & ny,
+                            double & nz) {
+    nx = batch.n_x[i];
+    ny = batch.n_y[i];
+    nz = batch.n_z[i];
+    normalize3(nx, ny, nz);
+    if (batch.in_x[i] * nx + batch.in_y[i] * ny + batch.in_z[i] * nz > 0.0) {
+      nx = nx * -1.0;
+      ny = ny * -1.0;
+      nz = nz * -1.0;
+    }
+  }
+
+  // Los números aleatorios se generan primero, en el mismo orden que scatter, y se dejan en la
+  // dirección de salida; el cálculo posterior no depende del generador
+  void draw_uniform(ScatterBatch & batch, double lo, double hi) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      batch.out_x[i] = render::uniform_double(batch.rng[i], lo, hi);
+      batch.out_y[i] = render::uniform_double(batch.rng[i], lo, hi);
+      batch.out_z[i] = render::uniform_double(batch.rng[i], lo, hi);
+    }
+  }
+
+  void fill_attenuation(ScatterBatch & batch, render::vector const & att) {
+    std::ranges::fill(batch.att_r, att.x);
+    std::ranges::fill(batch.att_g, att.y);
+    std::ranges::fill(batch.att_b, att.z);
+  }
+
+}  // namespace
+
+void ScatterBatch::resize(std::size_t n) {
+  for (auto * v : {&in_x, &in_y, &in_z, &n_x, &n_y, &n_z, &out_x, &out_y, &out_z, &att_r, &att_g,
+                   &att_b}) {
+    v->resize(n);
+  }
+  rng.resize(n);
+}
 
 Matte::Matte(std::string name, render::vector reflectance)
     : Material(std::move(name)), reflectance(reflectance) { }
@@ -15,9 +69,131 @@ Metal::Metal(std::string name, render::vector reflectance, double fuzz)
 
 Refractive::Refractive(std::string name, double ior) : Material(std::move(name)), ior(ior) { }
 
+std::vector<double> Matte::parameters() const {
+  return {reflectance.x, reflectance.y, reflectance.z};
+}
+
+std::vector<double> Metal::parameters() const {
+  return {reflectance.x, reflectance.y, reflectance.z, fuzz};
+}
+
+std::vector<double> Refractive::parameters() const {
+  return {ior};
+}
+
+// Implementación genérica: scatter impacto a impacto
+void Material::scatter_batch(ScatterBatch & batch) const {
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    auto const [dir, att] =
+        scatter(render::vector{batch.in_x[i], batch.in_y[i], batch.in_z[i]},
+                render::vector{batch.n_x[i], batch.n_y[i], batch.n_z[i]}, batch.rng[i]);
+    batch.out_x[i] = dir.x;
+    batch.out_y[i] = dir.y;
+    batch.out_z[i] = dir.z;
+    batch.att_r[i] = att.x;
+    batch.att_g[i] = att.y;
+    batch.att_b[i] = att.z;
+  }
+}
+
+// Las versiones por lote de cada material repiten las operaciones de su scatter sobre los arrays
+// del lote, sin llamadas por impacto, y dan exactamente el mismo resultado
+void Matte::scatter_batch(ScatterBatch & batch) const {
+  draw_uniform(batch, -1.0, 1.0);
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    double nx = 0.0;
+    double ny = 0.0;
+    double nz = 0.0;
+    facing_normal(batch, i, nx, ny, nz);
+    double dx = nx + batch.out_x[i];
+    double dy = ny + batch.out_y[i];
+    double dz = nz + batch.out_z[i];
+    if (std::fabs(dx) < 1e-8 and std::fabs(dy) < 1e-8 and std::fabs(dz) < 1e-8) {
+      dx = nx;
+      dy = ny;
+      dz = nz;
+    }
+    normalize3(dx, dy, dz);
+    batch.out_x[i] = dx;
+    batch.out_y[i] = dy;
+    batch.out_z[i] = dz;
+  }
+  fill_attenuation(batch, reflectance);
+}
+
+void Metal::scatter_batch(ScatterBatch & batch) const {
+  draw_uniform(batch, -fuzz, fuzz);
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    double nx = 0.0;
+    double ny = 0.0;
+    double nz = 0.0;
+    facing_normal(batch, i, nx, ny, nz);
+    double const k = 2.0 * (batch.in_x[i] * nx + batch.in_y[i] * ny + batch.in_z[i] * nz);
+    double dx      = batch.in_x[i] - nx * k;
+    double dy      = batch.in_y[i] - ny * k;
+    double dz      = batch.in_z[i] - nz * k;
+    normalize3(dx, dy, dz);
+    dx = dx + batch.out_x[i];
+    dy = dy + batch.out_y[i];
+    dz = dz + batch.out_z[i];
+    normalize3(dx, dy, dz);
+    batch.out_x[i] = dx;
+    batch.out_y[i] = dy;
+    batch.out_z[i] = dz;
+  }
+  fill_attenuation(batch, reflectance);
+}
+
+void Refractive::scatter_batch(ScatterBatch & batch) const {
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    double ix = batch.in_x[i];
+    double iy = batch.in_y[i];
+    double iz = batch.in_z[i];
+    normalize3(ix, iy, iz);
+    double nx = batch.n_x[i];
+    double ny = batch.n_y[i];
+    double nz = batch.n_z[i];
+    normalize3(nx, ny, nz);
+    bool const front_face = ix * nx + iy * ny + iz * nz < 0;
+    if (not front_face) {
+      nx = nx * -1.0;
+      ny = ny * -1.0;
+      nz = nz * -1.0;
+    }
+    double const ref_ratio = front_face ? (1.0 / ior) : ior;
+    double const cos_theta =
+        std::min((ix * -1.0) * nx + (iy * -1.0) * ny + (iz * -1.0) * nz, 1.0);
+    double const sin_theta = std::sqrt(std::max(0.0, 1.0 - cos_theta * cos_theta));
+    double rx = 0.0;
+    double ry = 0.0;
+    double rz = 0.0;
+    if (ref_ratio * sin_theta > 1.0) {
+      double const k = 2.0 * (ix * nx + iy * ny + iz * nz);
+      rx             = ix - nx * k;
+      ry             = iy - ny * k;
+      rz             = iz - nz * k;
+    } else {
+      double const ux  = (ix + nx * cos_theta) * ref_ratio;
+      double const uy  = (iy + ny * cos_theta) * ref_ratio;
+      double const uz  = (iz + nz * cos_theta) * ref_ratio;
+      double const mag = std::sqrt(ux * ux + uy * uy + uz * uz);
+      double const a   = std::abs(1.0 - mag * mag);
+      double const v   = -std::sqrt(a);
+      rx               = ux + nx * v;
+      ry               = uy + ny * v;
+      rz               = uz + nz * v;
+    }
+    normalize3(rx, ry, rz);
+    batch.out_x[i] = rx;
+    batch.out_y[i] = ry;
+    batch.out_z[i] = rz;
+  }
+  fill_attenuation(batch, render::vector{1.0, 1.0, 1.0});
+}
+
 std::pair<render::vector, render::vector> Matte::scatter(
     [[maybe_unused]] render::vector const & in_dir, render::vector const & normal,
-    std::mt19937_64 & rng) const {
+    render::Sampler & rng) const {
   render::vector unit_normal = render::vector::normalize(normal);
 
   // Orientar la normal para que apunte contra el rayo (si estamos dentro, apuntar hacia adentro)
@@ -26,8 +202,10 @@ std::pair<render::vector, render::vector> Matte::scatter(
   }
 
   // el rayo reflejado se genera en una dirección aleatoria
-  std::uniform_real_distribution<double> ud(-1.0, 1.0);
-  render::vector const rnd{ud(rng), ud(rng), ud(rng)};
+  double const x = render::uniform_double(rng, -1.0, 1.0);
+  double const y = render::uniform_double(rng, -1.0, 1.0);
+  double const z = render::uniform_double(rng, -1.0, 1.0);
+  render::vector const rnd{x, y, z};
   render::vector dir = render::vector::add(unit_normal, rnd);
   if (std::fabs(dir.x) < 1e-8 and std::fabs(dir.y) < 1e-8 and std::fabs(dir.z) < 1e-8) {
     // evitar vector demasiado pequeño
@@ -39,7 +217,7 @@ std::pair<render::vector, render::vector> Matte::scatter(
 
 std::pair<render::vector, render::vector> Metal::scatter(render::vector const & in_dir,
                                                          render::vector const & normal,
-                                                         std::mt19937_64 & rng) const {
+                                                         render::Sampler & rng) const {
   render::vector unit_normal = render::vector::normalize(normal);
 
   // Orientar la normal para que apunte contra el rayo (si estamos dentro, apuntar hacia adentro)
@@ -50,8 +228,10 @@ std::pair<render::vector, render::vector> Metal::scatter(render::vector const &
   render::vector const dir = render::vector::sub(
       in_dir, render::vector::muld(unit_normal, 2.0 * render::vector::dotp(in_dir, unit_normal)));
   // agregar fuzz
-  std::uniform_real_distribution<double> ud(-fuzz, fuzz);
-  render::vector const diff{ud(rng), ud(rng), ud(rng)};
+  double const x = render::uniform_double(rng, -fuzz, fuzz);
+  double const y = render::uniform_double(rng, -fuzz, fuzz);
+  double const z = render::uniform_double(rng, -fuzz, fuzz);
+  render::vector const diff{x, y, z};
   render::vector const res = render::vector::add(render::vector::normalize(dir), diff);
 
   return {render::vector::normalize(res), reflectance};
@@ -59,7 +239,7 @@ std::pair<render::vector, render::vector> Metal::scatter(render::vector const &
 
 std::pair<render::vector, render::vector> Refractive::scatter(
     render::vector const & in_dir, render::vector const & normal,
-    [[maybe_unused]] std::mt19937_64 & rng) const {
+    [[maybe_unused]] render::Sampler & rng) const {
   render::vector const unit_in_dir = render::vector::normalize(in_dir);
   render::vector const unit_normal = render::vector::normalize(normal);
 
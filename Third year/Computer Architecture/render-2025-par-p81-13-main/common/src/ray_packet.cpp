@@ -0,0 +1,159 @@
+#include <aabb.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bvh.hpp>
+#include <cmath>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ray.hpp>
+#include <ray_packet.hpp>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector.hpp>
+
+namespace render {
+
+  namespace {
+
+    constexpr double no_hit = std::numeric_limits<double>::infinity();
+
+    std::array<double, 3> xyz(vector const & v) {
+      return {v.x, v.y, v.z};
+    }
+
+    // Rango de las inversas de las direcciones del paquete en cada eje
+    struct PacketBounds {
+      std::array<double, 3> origin{};
+      std::array<double, 3> inv_lo{};
+      std::array<double, 3> inv_hi{};
+      // false si el paquete no admite el test conjunto (orígenes distintos o signos mezclados)
+      bool coherent = false;
+    };
+
+    PacketBounds packet_bounds(std::span<ray const> rays, std::span<vector const> inv_dirs) {
+      PacketBounds pb;
+      pb.origin = xyz(rays[0].origin);
+      pb.inv_lo = xyz(inv_dirs[0]);
+      pb.inv_hi = pb.inv_lo;
+      for (std::size_t i = 0; i < rays.size(); ++i) {
+        if (xyz(rays[i].origin) != pb.origin) {
+          return pb;
+        }
+        std::array<double, 3> const inv_dir = xyz(inv_dirs[i]);
+        for (std::size_t a = 0; a < 3; ++a) {
+          double const inv = inv_dir[a];
+          // con inversas finitas del mismo signo los productos son monótonos en la inversa
+          if (not std::isfinite(inv) or std::signbit(inv) != std::signbit(pb.inv_lo[a])) {
+            return pb;
+          }
+          pb.inv_lo[a] = std::min(pb.inv_lo[a], inv);
+          pb.inv_hi[a] = std::max(pb.inv_hi[a], inv);
+        }
+      }
+      pb.coherent = true;
+      return pb;
+    }
+
+    // Cota inferior de la entrada y superior de la salida de todos los rayos del paquete en la
+    // caja. Si la entrada supera a la salida ningún rayo del paquete la corta.
+    bool packet_misses(AABB const & box, PacketBounds const & pb, double t_max) {
+      std::array<double, 3> const lo{box.min.x, box.min.y, box.min.z};
+      std::array<double, 3> const hi{box.max.x, box.max.y, box.max.z};
+      double t_enter = 0.0;
+      double t_exit  = t_max;
+      for (std::size_t a = 0; a < 3; ++a) {
+        bool const positive = pb.inv_lo[a] > 0.0;
+        double const near   = (positive ? lo[a] : hi[a]) - pb.origin[a];
+        double const far    = (positive ? hi[a] : lo[a]) - pb.origin[a];
+        t_enter = std::max(t_enter, std::min(near * pb.inv_lo[a], near * pb.inv_hi[a]));
+        t_exit  = std::min(t_exit, std::max(far * pb.inv_lo[a], far * pb.inv_hi[a]));
+      }
+      return t_enter > t_exit;
+    }
+
+  }  // namespace
+
+  void closest_hits_packet(BVH const & bvh, CompiledScene const & cs, std::span<ray const> rays,
+                           std::span<PrimHit> hits, TraversalStats * stats) {
+    if (rays.size() != hits.size() or rays.size() > max_packet_rays) {
+      throw std::invalid_argument("invalid ray packet size");
+    }
+    for (PrimHit & h : hits) {
+      h = PrimHit{};
+    }
+    if (rays.empty() or bvh.empty()) {
+      return;
+    }
+    std::array<vector, max_packet_rays> inv_dirs{};
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      vector const & d = rays[i].direction;
+      inv_dirs[i]      = vector{1.0 / d.x, 1.0 / d.y, 1.0 / d.z};
+    }
+    PacketBounds const pb =
+        packet_bounds(rays, std::span<vector const>{inv_dirs.data(), rays.size()});
+
+    auto const & nodes   = bvh.nodes();
+    auto const & indices = bvh.indices();
+    std::uint64_t const all =
+        rays.size() == max_packet_rays ? ~std::uint64_t{0} : (std::uint64_t{1} << rays.size()) - 1;
+    // pila de nodos pendientes con los rayos que llegaron a ellos
+    std::array<std::pair<std::uint32_t, std::uint64_t>, 128> stack{};
+    std::size_t top = 0;
+    stack[top++]    = {0, all};
+    while (top > 0) {
+      auto [node, active] = stack[--top];
+      BVHNode const & n   = nodes[node];
+      // test conjunto contra el impacto más lejano de los rayos activos
+      if (pb.coherent) {
+        double t_max = 0.0;
+        for (std::uint64_t m = active; m != 0; m &= m - 1) {
+          t_max = std::max(t_max, hits[static_cast<std::size_t>(std::countr_zero(m))].lambda);
+        }
+        if (packet_misses(n.bounds, pb, t_max)) {
+          continue;
+        }
+      }
+      // test de cada rayo activo
+      for (std::uint64_t m = active; m != 0; m &= m - 1) {
+        auto const i = static_cast<std::size_t>(std::countr_zero(m));
+        if (n.bounds.entry(rays[i].origin, inv_dirs[i], 0.0, hits[i].lambda) == no_hit) {
+          active &= ~(std::uint64_t{1} << i);
+        }
+      }
+      if (active == 0) {
+        continue;
+      }
+      if (stats != nullptr) {
+        stats->nodes++;
+      }
+      if (n.is_leaf()) {
+        for (std::uint32_t p = n.first; p < n.first + n.count; ++p) {
+          for (std::uint64_t m = active; m != 0; m &= m - 1) {
+            auto const i = static_cast<std::size_t>(std::countr_zero(m));
+            cs.test(indices[p], rays[i], hits[i]);
+          }
+        }
+        if (stats != nullptr) {
+          stats->primitives += static_cast<std::uint64_t>(n.count) *
+                               static_cast<std::uint64_t>(std::popcount(active));
+        }
+        continue;
+      }
+      // el hijo más cercano para el primer rayo activo se visita antes
+      auto const first = static_cast<std::size_t>(std::countr_zero(active));
+      std::uint32_t near_child = node + 1;
+      std::uint32_t far_child  = n.first;
+      if (nodes[far_child].bounds.entry(rays[first].origin, inv_dirs[first], 0.0, no_hit) <
+          nodes[near_child].bounds.entry(rays[first].origin, inv_dirs[first], 0.0, no_hit)) {
+        std::swap(near_child, far_child);
+      }
+      stack[top++] = {far_child, active};
+      stack[top++] = {near_child, active};
+    }
+  }
+
+}  // namespace render
@@ -1,8 +1,15 @@
+#include <aabb.hpp>
+#include <algorithm>
+#include <accelerator.hpp>
 #include <array>
+#include <bvh.hpp>
+#include <bvh4.hpp>
 #include <cctype>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <compiled_scene.hpp>
 #include <cstdlib>
 #include <cylinder.hpp>
 #include <fstream>
@@ -14,7 +21,9 @@
 #include <object.hpp>
 #include <optional>
 #include <ray.hpp>
+#include <ray_packet.hpp>
 #include <scene.hpp>
+#include <span>
 #include <sphere.hpp>
 #include <sstream>
 #include <stdexcept>
@@ -24,6 +33,9 @@
 #include <vector.hpp>
 #include <vector>
 
+// includes de TBB
+#include <oneapi/tbb/parallel_for.h>
+
 // helpers locales
 namespace {
 
@@ -257,11 +269,137 @@ void Scene::load_scene(std::string const & path) {
     }
     parser(*this, v, raw);
   }
+  build_bvh();
+}
+
+namespace {
+
+  // Lo que hace build_bvh sobre `scene`, con la tabla de materiales sacada de `materials`
+  void build_index(Scene & scene,
+                   std::unordered_map<std::string, std::unique_ptr<Material>> const & materials) {
+    // tabla de materiales en orden de nombre, independiente del orden del unordered_map
+    std::vector<std::string> names;
+    names.reserve(materials.size());
+    for (auto const & entry : materials) {
+      names.push_back(entry.first);
+    }
+    std::ranges::sort(names);
+    scene.material_table.clear();
+    scene.material_ids.clear();
+    for (std::string const & name : names) {
+      scene.material_ids.emplace(name, static_cast<std::uint32_t>(scene.material_table.size()));
+      scene.material_table.push_back(materials.at(name).get());
+    }
+    for (auto & obj : scene.objects) {
+      auto const it    = scene.material_ids.find(obj->material_name);
+      obj->material_id =
+          it == scene.material_ids.end() ? render::Intersection::no_material : it->second;
+    }
+    scene.compiled.build(scene.objects);
+    std::vector<render::AABB> prim_bounds(scene.objects.size());
+    oneapi::tbb::parallel_for(std::size_t{0}, scene.objects.size(), [&](std::size_t i) {
+      prim_bounds[i] = scene.objects[i]->bounds();
+    });
+    scene.bvh.build(prim_bounds);
+    scene.bvh4.build(scene.bvh);
+  }
+
+}  // namespace
+
+void Scene::build_bvh() {
+  build_index(*this, materials);
+}
+
+Scene Scene::rebuilt() const {
+  Scene copia;
+  copia.objects.reserve(objects.size());
+  for (auto const & obj : objects) {
+    copia.objects.push_back(obj->clone());
+  }
+  copia.accelerator = accelerator;
+  build_index(copia, materials);
+  return copia;
+}
+
+Scene Scene::replica() const {
+  Scene copia;
+  copia.material_table = material_table;
+  copia.material_ids   = material_ids;
+  copia.objects.reserve(objects.size());
+  for (auto const & obj : objects) {
+    copia.objects.push_back(obj->clone());
+  }
+  copia.compiled    = compiled;
+  copia.bvh         = bvh;
+  copia.bvh4        = bvh4;
+  copia.accelerator = accelerator;
+  return copia;
 }
 
-std::optional<render::Intersection> Scene::intersect(render::ray const & r) const {
+namespace {
+
+  // Impacto más cercano recorriendo una BVH (binaria o ancha). Mismo criterio que el recorrido
+  // lineal: ante empate gana el objeto de menor índice.
+  template <typename Hierarchy>
+  render::PrimHit closest_hit_in(Hierarchy const & hierarchy, render::CompiledScene const & cs,
+                                 render::ray const & r, render::TraversalStats * stats) {
+    render::PrimHit best;
+    hierarchy.traverse(
+        r, best.lambda, [&](std::uint32_t idx) { cs.test(idx, r, best); }, stats);
+    return best;
+  }
+
+}  // namespace
+
+std::optional<render::Intersection> Scene::intersect(render::ray const & r,
+                                                     render::TraversalStats * stats) const {
+  if (not up_to_date()) {
+    return intersect_linear(r);
+  }
+  switch (accelerator) {
+    case render::Accelerator::bvh4:
+      if (bvh4.size() == objects.size()) {
+        return compiled.resolve(r, closest_hit_in(bvh4, compiled, r, stats));
+      }
+      break;
+    case render::Accelerator::bvh2:
+      if (bvh.size() == objects.size()) {
+        return compiled.resolve(r, closest_hit_in(bvh, compiled, r, stats));
+      }
+      break;
+    case render::Accelerator::linear:
+      break;
+  }
+  return compiled.resolve(r, compiled.closest_all(r));
+}
+
+void Scene::intersect_packet(std::span<render::ray const> rays,
+                             std::span<std::optional<render::Intersection>> out,
+                             render::TraversalStats * stats) const {
+  if (rays.size() != out.size()) {
+    throw std::invalid_argument("intersect_packet: rays and results differ in size");
+  }
+  bool const packet = up_to_date() and bvh.size() == objects.size() and
+                      accelerator != render::Accelerator::linear and
+                      rays.size() <= render::max_packet_rays;
+  if (not packet) {
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      out[i] = intersect(rays[i], stats);
+    }
+    return;
+  }
+  std::array<render::PrimHit, render::max_packet_rays> hits{};
+  std::span<render::PrimHit> const packet_hits{hits.data(), rays.size()};
+  render::closest_hits_packet(bvh, compiled, rays, packet_hits, stats);
+  for (std::size_t i = 0; i < rays.size(); ++i) {
+    out[i] = compiled.resolve(rays[i], packet_hits[i]);
+  }
+}
+
+std::optional<render::Intersection> Scene::intersect_linear(render::ray const & r) const {
   std::optional<render::Intersection> closest_hit;
-  double closest_lambda = std::numeric_limits<double>::infinity();
+  double closest_lambda                = std::numeric_limits<double>::infinity();
+  render::Object3D const * closest_obj = nullptr;
 
   double const min_lambda = 1e-3;
 
@@ -270,9 +408,17 @@ std::optional<render::Intersection> Scene::intersect(render::ray const & r) cons
     if (hit and hit->lambda > min_lambda and hit->lambda < closest_lambda) {
       closest_lambda = hit->lambda;
       closest_hit    = hit;
+      closest_obj    = obj.get();
     }
   }
 
+  // objeto añadido tras build_bvh: su material se busca por nombre en la tabla
+  if (closest_hit and closest_hit->material == render::Intersection::no_material) {
+    auto const it = material_ids.find(closest_obj->material_name);
+    if (it != material_ids.end()) {
+      closest_hit->material = it->second;
+    }
+  }
   return closest_hit;
 }
 
@@ -0,0 +1,43 @@
+#include <simd.hpp>
+
+namespace render {
+
+  namespace {
+
+    SimdLevel detect_simd_level() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::avx512;
+      }
+      if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::avx2;
+      }
+#endif
+      return SimdLevel::scalar;
+    }
+
+  }  // namespace
+
+  SimdLevel cpu_simd_level() noexcept {
+    static SimdLevel const level = detect_simd_level();
+    return level;
+  }
+
+  bool simd_supported(SimdLevel level) noexcept {
+    // avx512 implica avx2 en todas las CPU que lo implementan
+    return static_cast<int>(level) <= static_cast<int>(cpu_simd_level());
+  }
+
+  char const * simd_level_name(SimdLevel level) noexcept {
+    switch (level) {
+      case SimdLevel::avx512:
+        return "avx512";
+      case SimdLevel::avx2:
+        return "avx2";
+      case SimdLevel::scalar:
+        break;
+    }
+    return "scalar";
+  }
+
+}  // namespace render
@@ -1,6 +1,8 @@
+#include <aabb.hpp>
 #include <algorithm>
 #include <cmath>
 #include <intersection.hpp>
+#include <memory>
 #include <optional>
 #include <ray.hpp>
 #include <sphere.hpp>
@@ -15,6 +17,15 @@ namespace render {
     material_name = m;
   }
 
+  std::unique_ptr<Object3D> Sphere::clone() const {
+    return std::make_unique<Sphere>(*this);
+  }
+
+  AABB Sphere::bounds() const {
+    vector const ext{radius, radius, radius};
+    return AABB{vector::sub(center, ext), vector::add(center, ext)}.padded();
+  }
+
   // metodo que calcula la interseccion de un rayo con la esfera
 
   std::optional<Intersection> Sphere::collision(ray const & r) const {
@@ -51,7 +62,7 @@ namespace render {
     /*if (vector::dotp(r.direction, normal) > 0.0) {
       normal = vector::muld(normal, -1.0);  // invertir normal si el rayo entra
     }*/
-    return Intersection(punto_interseccion, normal, lambda, material_name);
+    return Intersection(punto_interseccion, normal, lambda, material_id);
   }
 
 }  // namespace render
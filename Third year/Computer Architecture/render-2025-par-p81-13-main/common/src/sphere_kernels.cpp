@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <primitive_kernels.hpp>
+#include <ray.hpp>
+#include <simd.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace render {
+
+  namespace {
+
+    constexpr double no_hit = std::numeric_limits<double>::infinity();
+
+    // Actualiza `best` con el candidato (lambda, s) con el mismo criterio que CompiledScene
+    void keep_nearest(NearestHit & best, double lambda, std::size_t s) {
+      if (lambda > CompiledScene::min_lambda and lambda < best.lambda) {
+        best = NearestHit{lambda, static_cast<std::uint32_t>(s)};
+      }
+    }
+
+    NearestHit nearest_sphere_scalar(SphereSoA const & sp, std::size_t begin, ray const & r,
+                                     NearestHit best) {
+      for (std::size_t s = begin; s < sp.size(); ++s) {
+        keep_nearest(best, sphere_lambda(sp, s, r), s);
+      }
+      return best;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Combina los mejores impactos de cada carril: el menor lambda y, a igualdad, la menor
+    // posición
+    template <std::size_t N>
+    NearestHit reduce_lanes(std::array<double, N> const & t, std::array<double, N> const & idx) {
+      NearestHit best;
+      for (std::size_t i = 0; i < N; ++i) {
+        if (t[i] == no_hit) {
+          continue;
+        }
+        auto const slot = static_cast<std::uint32_t>(idx[i]);
+        if (t[i] < best.lambda or (t[i] == best.lambda and slot < best.slot)) {
+          best = NearestHit{t[i], slot};
+        }
+      }
+      return best;
+    }
+
+    // Cada carril repite las operaciones de sphere_lambda (sin FMA), con lo que los lambdas son
+    // los mismos bit a bit. Cada carril guarda su mejor impacto con comparación estricta, así que
+    // a igualdad conserva la menor posición.
+    [[gnu::target("avx2")]] NearestHit nearest_sphere_avx2(SphereSoA const & sp, ray const & r) {
+      double const a   = r.direction.x * r.direction.x + r.direction.y * r.direction.y +
+                       r.direction.z * r.direction.z;
+      __m256d const ox = _mm256_set1_pd(r.origin.x);
+      __m256d const oy = _mm256_set1_pd(r.origin.y);
+      __m256d const oz = _mm256_set1_pd(r.origin.z);
+      __m256d const dx = _mm256_set1_pd(r.direction.x);
+      __m256d const dy = _mm256_set1_pd(r.direction.y);
+      __m256d const dz = _mm256_set1_pd(r.direction.z);
+      __m256d const va = _mm256_set1_pd(a);
+      __m256d const two_a     = _mm256_set1_pd(2.0 * a);
+      __m256d const two       = _mm256_set1_pd(2.0);
+      __m256d const four      = _mm256_set1_pd(4.0);
+      __m256d const minus_one = _mm256_set1_pd(-1.0);
+      __m256d const disc_min  = _mm256_set1_pd(1e-8);
+      __m256d const eps       = _mm256_set1_pd(1e-3);
+      __m256d const min_l     = _mm256_set1_pd(CompiledScene::min_lambda);
+
+      __m256d best_t = _mm256_set1_pd(no_hit);
+      __m256d best_i = _mm256_setzero_pd();
+      __m256d idx    = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+      __m256d const step = _mm256_set1_pd(4.0);
+
+      std::size_t const n = sp.size();
+      std::size_t s       = 0;
+      for (; s + 4 <= n; s += 4) {
+        __m256d const rcx = _mm256_sub_pd(ox, _mm256_loadu_pd(sp.cx.data() + s));
+        __m256d const rcy = _mm256_sub_pd(oy, _mm256_loadu_pd(sp.cy.data() + s));
+        __m256d const rcz = _mm256_sub_pd(oz, _mm256_loadu_pd(sp.cz.data() + s));
+        __m256d const b   = _mm256_mul_pd(
+            two, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, rcx), _mm256_mul_pd(dy, rcy)),
+                               _mm256_mul_pd(dz, rcz)));
+        __m256d const c = _mm256_sub_pd(
+            _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(rcx, rcx), _mm256_mul_pd(rcy, rcy)),
+                          _mm256_mul_pd(rcz, rcz)),
+            _mm256_loadu_pd(sp.r2.data() + s));
+        __m256d const disc =
+            _mm256_sub_pd(_mm256_mul_pd(b, b), _mm256_mul_pd(four, _mm256_mul_pd(va, c)));
+        __m256d const raiz  = _mm256_sqrt_pd(disc);
+        __m256d const neg_b = _mm256_mul_pd(b, minus_one);
+        __m256d const l1    = _mm256_div_pd(_mm256_sub_pd(neg_b, raiz), two_a);
+        __m256d const l2    = _mm256_div_pd(_mm256_add_pd(neg_b, raiz), two_a);
+        __m256d const ok1   = _mm256_cmp_pd(l1, eps, _CMP_GE_OQ);
+        __m256d const ok2   = _mm256_cmp_pd(l2, eps, _CMP_GE_OQ);
+        // ambas válidas: std::min(l1, l2); si no, la que sea válida
+        __m256d t = _mm256_blendv_pd(l2, l1, ok1);
+        t         = _mm256_blendv_pd(t, _mm256_min_pd(l2, l1), _mm256_and_pd(ok1, ok2));
+        __m256d valid = _mm256_and_pd(_mm256_cmp_pd(disc, disc_min, _CMP_GE_OQ),
+                                      _mm256_or_pd(ok1, ok2));
+        valid = _mm256_and_pd(valid, _mm256_cmp_pd(t, min_l, _CMP_GT_OQ));
+        __m256d const better = _mm256_and_pd(valid, _mm256_cmp_pd(t, best_t, _CMP_LT_OQ));
+        best_t               = _mm256_blendv_pd(best_t, t, better);
+        best_i               = _mm256_blendv_pd(best_i, idx, better);
+        idx                  = _mm256_add_pd(idx, step);
+      }
+      std::array<double, 4> t_lanes{};
+      std::array<double, 4> i_lanes{};
+      _mm256_storeu_pd(t_lanes.data(), best_t);
+      _mm256_storeu_pd(i_lanes.data(), best_i);
+      return nearest_sphere_scalar(sp, s, r, reduce_lanes(t_lanes, i_lanes));
+    }
+
+    // Los intrínsecos de AVX-512 de GCC 12 usan _mm512_undefined_pd como operando de paso y
+    // provocan falsos avisos de variable sin inicializar
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    [[gnu::target("avx512f")]] NearestHit nearest_sphere_avx512(SphereSoA const & sp,
+                                                                ray const & r) {
+      double const a   = r.direction.x * r.direction.x + r.direction.y * r.direction.y +
+                       r.direction.z * r.direction.z;
+      __m512d const ox = _mm512_set1_pd(r.origin.x);
+      __m512d const oy = _mm512_set1_pd(r.origin.y);
+      __m512d const oz = _mm512_set1_pd(r.origin.z);
+      __m512d const dx = _mm512_set1_pd(r.direction.x);
+      __m512d const dy = _mm512_set1_pd(r.direction.y);
+      __m512d const dz = _mm512_set1_pd(r.direction.z);
+      __m512d const va = _mm512_set1_pd(a);
+      __m512d const two_a     = _mm512_set1_pd(2.0 * a);
+      __m512d const two       = _mm512_set1_pd(2.0);
+      __m512d const four      = _mm512_set1_pd(4.0);
+      __m512d const minus_one = _mm512_set1_pd(-1.0);
+      __m512d const disc_min  = _mm512_set1_pd(1e-8);
+      __m512d const eps       = _mm512_set1_pd(1e-3);
+      __m512d const min_l     = _mm512_set1_pd(CompiledScene::min_lambda);
+
+      __m512d best_t = _mm512_set1_pd(no_hit);
+      __m512d best_i = _mm512_setzero_pd();
+      __m512d idx    = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+      __m512d const step = _mm512_set1_pd(8.0);
+
+      std::size_t const n = sp.size();
+      std::size_t s       = 0;
+      for (; s + 8 <= n; s += 8) {
+        __m512d const rcx = _mm512_sub_pd(ox, _mm512_loadu_pd(sp.cx.data() + s));
+        __m512d const rcy = _mm512_sub_pd(oy, _mm512_loadu_pd(sp.cy.data() + s));
+        __m512d const rcz = _mm512_sub_pd(oz, _mm512_loadu_pd(sp.cz.data() + s));
+        __m512d const b   = _mm512_mul_pd(
+            two, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, rcx), _mm512_mul_pd(dy, rcy)),
+                               _mm512_mul_pd(dz, rcz)));
+        __m512d const c = _mm512_sub_pd(
+            _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(rcx, rcx), _mm512_mul_pd(rcy, rcy)),
+                          _mm512_mul_pd(rcz, rcz)),
+            _mm512_loadu_pd(sp.r2.data() + s));
+        __m512d const disc =
+            _mm512_sub_pd(_mm512_mul_pd(b, b), _mm512_mul_pd(four, _mm512_mul_pd(va, c)));
+        __m512d const raiz  = _mm512_sqrt_pd(disc);
+        __m512d const neg_b = _mm512_mul_pd(b, minus_one);
+        __m512d const l1    = _mm512_div_pd(_mm512_sub_pd(neg_b, raiz), two_a);
+        __m512d const l2    = _mm512_div_pd(_mm512_add_pd(neg_b, raiz), two_a);
+        __mmask8 const ok1  = _mm512_cmp_pd_mask(l1, eps, _CMP_GE_OQ);
+        __mmask8 const ok2  = _mm512_cmp_pd_mask(l2, eps, _CMP_GE_OQ);
+        __m512d t           = _mm512_mask_blend_pd(ok1, l2, l1);
+        t = _mm512_mask_blend_pd(static_cast<__mmask8>(ok1 & ok2), t, _mm512_min_pd(l2, l1));
+        auto const valid = static_cast<__mmask8>(
+            _mm512_cmp_pd_mask(disc, disc_min, _CMP_GE_OQ) & (ok1 | ok2) &
+            _mm512_cmp_pd_mask(t, min_l, _CMP_GT_OQ));
+        auto const better =
+            static_cast<__mmask8>(valid & _mm512_cmp_pd_mask(t, best_t, _CMP_LT_OQ));
+        best_t = _mm512_mask_blend_pd(better, best_t, t);
+        best_i = _mm512_mask_blend_pd(better, best_i, idx);
+        idx    = _mm512_add_pd(idx, step);
+      }
+      std::array<double, 8> t_lanes{};
+      std::array<double, 8> i_lanes{};
+      _mm512_storeu_pd(t_lanes.data(), best_t);
+      _mm512_storeu_pd(i_lanes.data(), best_i);
+      return nearest_sphere_scalar(sp, s, r, reduce_lanes(t_lanes, i_lanes));
+    }
+  #pragma GCC diagnostic pop
+#endif
+
+  }  // namespace
+
+  double sphere_lambda(SphereSoA const & sp, std::size_t s, ray const & r) {
+    double const rcx  = r.origin.x - sp.cx[s];
+    double const rcy  = r.origin.y - sp.cy[s];
+    double const rcz  = r.origin.z - sp.cz[s];
+    double const a    = r.direction.x * r.direction.x + r.direction.y * r.direction.y +
+                     r.direction.z * r.direction.z;
+    double const b    = 2 * (r.direction.x * rcx + r.direction.y * rcy + r.direction.z * rcz);
+    double const c    = (rcx * rcx + rcy * rcy + rcz * rcz) - sp.r2[s];
+    double const disc = (b * b) - 4 * (a * c);
+    if (disc < 1e-8) {
+      return no_hit;
+    }
+    double const raiz    = std::sqrt(disc);
+    double const lambda1 = (-b - raiz) / (2.0 * a);
+    double const lambda2 = (-b + raiz) / (2.0 * a);
+    if (lambda1 >= 1e-3 and lambda2 >= 1e-3) {
+      return std::min(lambda1, lambda2);
+    }
+    if (lambda1 >= 1e-3) {
+      return lambda1;
+    }
+    if (lambda2 >= 1e-3) {
+      return lambda2;
+    }
+    return no_hit;
+  }
+
+  NearestHit nearest_sphere(SphereSoA const & spheres, ray const & r, SimdLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level) {
+      case SimdLevel::avx512:
+        return nearest_sphere_avx512(spheres, r);
+      case SimdLevel::avx2:
+        return nearest_sphere_avx2(spheres, r);
+      case SimdLevel::scalar:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    return nearest_sphere_scalar(spheres, 0, r, NearestHit{});
+  }
+
+  NearestHit nearest_sphere(SphereSoA const & spheres, ray const & r) {
+    return nearest_sphere(spheres, r, cpu_simd_level());
+  }
+
+}  // namespace render
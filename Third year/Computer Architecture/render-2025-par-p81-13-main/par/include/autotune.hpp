@@ -0,0 +1,33 @@
+#ifndef RENDER_AUTOTUNE_HPP
+#define RENDER_AUTOTUNE_HPP
+
+#include <config.hpp>
+#include <partitioner.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector>
+
+namespace render {
+
+  // Reparto del trabajo de un render piloto y su tiempo
+  struct TuneResult {
+    int threads;
+    int tile_size;
+    Partitioner partitioner;
+    double seconds;
+  };
+
+  // Nombre de un particionador tal como se escribe en el config
+  [[nodiscard]] std::string partitioner_name(Partitioner p);
+
+  // Renders piloto de la escena con el config y `muestras` muestras por píxel para cada
+  // combinación de hilos (todos los del sistema y la mitad), lado de bloque y particionador. Los
+  // lados que lado_tesela redondea al mismo se prueban una vez, con el lado efectivo. El tiempo
+  // de cada combinación es el mejor de `repeticiones`, que comparten el reparto de affinity y su
+  // arena; devuelve las combinaciones de la más rápida a la más lenta.
+  [[nodiscard]] std::vector<TuneResult> autotune(Scene const & escena, Config const & config,
+                                                 int muestras = 2, int repeticiones = 2);
+
+}  // namespace render
+
+#endif
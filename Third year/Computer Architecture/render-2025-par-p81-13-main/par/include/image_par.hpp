@@ -1,28 +1,98 @@
 #ifndef IMAGE_PAR_HPP
 #define IMAGE_PAR_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <pixel.hpp>
+#include <span>
+#include <string>
 #include <vector>
 
-//Clase que representa una imagen en formato Structure of Arrays (SoA)
+// Formatos de salida: PPM de texto (P3) o binario (P6) de 8 bits y, en HDR con la radiancia
+// lineal en float, PFM y OpenEXR sin compresión
+enum class ImageFormat : std::uint8_t { p3, p6, pfm, exr };
+
+// Interpreta el nombre de un formato ("p3", "p6", "pfm" o "exr"); lanza std::invalid_argument si
+// no existe
+[[nodiscard]] ImageFormat parse_image_format(std::string const & name);
+
+// Los formatos HDR se escriben desde la imagen de acumulación, sin gamma ni cuantización
+[[nodiscard]] inline bool hdr_format(ImageFormat formato) noexcept {
+  return formato == ImageFormat::pfm or formato == ImageFormat::exr;
+}
+
+//Clase que representa una imagen en formato Structure of Arrays (SoA), con un byte por canal
 class ImageSOA {
 public:
   ImageSOA(int width, int height);
   [[nodiscard]] int width() const noexcept;
   [[nodiscard]] int height() const noexcept;
 
+  // Los valores fuera de 0-255 se saturan
   void set_pixel(int x, int y, Pixel color);
   [[nodiscard]] Pixel get_pixel(int x, int y) const;
+  // Copia un bloque de w x h píxeles con esquina (x, y) desde tres canales guardados por filas de
+  // `paso` elementos. Los límites se comprueban una vez por bloque, no por píxel.
+  void set_block(int x, int y, int w, int h, std::size_t paso, std::span<std::uint8_t const> r,
+                 std::span<std::uint8_t const> g, std::span<std::uint8_t const> b);
 
   void write_ppm_p3(std::ostream & os) const;
+  // Mismo texto que write_ppm_p3, formateado en paralelo por bloques de filas con std::to_chars
+  // en un buffer del tamaño exacto que se escribe de una vez
+  void write_ppm_p3_parallel(std::ostream & os) const;
+  // PPM binario (P6): un byte por canal. Se rellena en paralelo y se escribe de una vez.
+  void write_ppm_p6(std::ostream & os) const;
+  // Escribe la imagen en el formato dado (P3 con write_ppm_p3_parallel); lanza
+  // std::invalid_argument con un formato HDR
+  void write(std::ostream & os, ImageFormat formato) const;
 
 private:
   int w_;
   int h_;
-  std::vector<int> R_;
-  std::vector<int> G_;
-  std::vector<int> B_;
+  std::vector<std::uint8_t> R_;
+  std::vector<std::uint8_t> G_;
+  std::vector<std::uint8_t> B_;
   static inline void validate_coords(int x, int y, int w, int h);
 };
+
+// Imagen de acumulación por canales: suma lineal (antes de gamma y cuantización) de las muestras
+// de cada píxel en float y número de muestras. La imagen de 8 bits sale de ella en un paso final
+// (render::quantize).
+class AccumImageSOA {
+public:
+  AccumImageSOA(int width, int height);
+  [[nodiscard]] int width() const noexcept { return w_; }
+  [[nodiscard]] int height() const noexcept { return h_; }
+
+  void set_pixel(int x, int y, float r, float g, float b, std::uint32_t muestras);
+  // Copia un bloque de w x h píxeles con esquina (x, y) desde canales guardados por filas de
+  // `paso` elementos, como ImageSOA::set_block
+  void set_block(int x, int y, int w, int h, std::size_t paso, std::span<float const> r,
+                 std::span<float const> g, std::span<float const> b,
+                 std::span<std::uint32_t const> muestras);
+
+  // Canales de la imagen entera, por filas
+  [[nodiscard]] std::span<float const> r() const noexcept { return R_; }
+  [[nodiscard]] std::span<float const> g() const noexcept { return G_; }
+  [[nodiscard]] std::span<float const> b() const noexcept { return B_; }
+  [[nodiscard]] std::span<std::uint32_t const> samples() const noexcept { return N_; }
+
+  // Radiancia lineal (media de las muestras, 0 sin muestras) en PFM: cabecera de texto y los
+  // canales RGB intercalados en float little endian, de la fila de abajo a la de arriba
+  void write_pfm(std::ostream & os) const;
+  // Radiancia lineal en OpenEXR de una parte por líneas sin compresión, con los canales B, G y R
+  // en float. Como write_pfm, se rellena en paralelo y se escribe de una vez.
+  void write_exr(std::ostream & os) const;
+  // Escribe la imagen en el formato HDR dado; lanza std::invalid_argument con uno de 8 bits
+  void write(std::ostream & os, ImageFormat formato) const;
+
+private:
+  int w_;
+  int h_;
+  std::vector<float> R_;
+  std::vector<float> G_;
+  std::vector<float> B_;
+  std::vector<std::uint32_t> N_;
+};
 #endif
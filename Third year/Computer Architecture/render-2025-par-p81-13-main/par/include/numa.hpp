@@ -0,0 +1,48 @@
+#ifndef RENDER_NUMA_HPP
+#define RENDER_NUMA_HPP
+
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <image_par.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <vector>
+
+namespace render {
+
+  // Nodo NUMA de TBB y los hilos que le tocan
+  struct NumaNode {
+    int id;
+    int threads;
+  };
+
+  // Nodos NUMA del sistema con sus hilos: todos los de cada nodo o, si config.threads > 0, esos
+  // hilos repartidos con split_threads. Sin información de NUMA (TBB sin tbbbind o un solo nodo)
+  // hay un único nodo sin restricciones.
+  [[nodiscard]] std::vector<NumaNode> numa_nodes(Config const & config);
+
+  // Reparto de `hilos` hilos entre los nodos en proporción a los que tiene cada uno, que suma
+  // exactamente `hilos`; los nodos a los que no les toca ninguno (con menos hilos que nodos) se
+  // quitan
+  [[nodiscard]] std::vector<NumaNode> split_threads(std::vector<NumaNode> const & nodos,
+                                                    int hilos);
+
+  // Reparto de `n` teselas consecutivas entre los nodos en proporción a sus hilos: las del nodo i
+  // son [limites[i], limites[i + 1])
+  [[nodiscard]] std::vector<std::size_t> split_tiles(std::size_t n,
+                                                     std::vector<NumaNode> const & nodos);
+
+  // render_image_accum con un task_arena por nodo NUMA, restringido a los núcleos del nodo. Cada
+  // nodo calcula un tramo contiguo de las teselas en orden de Morton con su propia copia de la
+  // escena (Scene::replica) y guarda sus píxeles en teselas reservadas y escritas por sus hilos,
+  // así que ambas quedan en su memoria local; al final se copian a `acum`. Con un solo nodo
+  // no se copia la escena. Da la misma imagen que sin NUMA. Con `afinidad`, el reparto de
+  // affinity de cada nodo y el arena del nodo se guardan en su posición.
+  void render_image_numa(Scene const & escena, Config const & config, Camera & camara,
+                         AccumImageSOA & acum, RenderStats * stats = nullptr,
+                         TileAffinity * afinidad = nullptr);
+
+}  // namespace render
+
+#endif
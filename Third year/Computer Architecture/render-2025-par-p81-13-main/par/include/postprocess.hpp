@@ -0,0 +1,68 @@
+#ifndef RENDER_POSTPROCESS_HPP
+#define RENDER_POSTPROCESS_HPP
+
+#include <array>
+#include <config.hpp>
+#include <cstdint>
+#include <pixel.hpp>
+#include <simd.hpp>
+#include <span>
+#include <tone_map.hpp>
+
+namespace render {
+
+  // Paso de la radiancia acumulada a la imagen de 8 bits, fuera del bucle de sombreado: se
+  // aplica por etapas a canales enteros (exposición, tone mapping y gamma con cuantización).
+  // Cada etapa tiene versión escalar y vectorial (avx2 u avx512, 8 o 16 valores a la vez) con
+  // exactamente el mismo resultado. `level` debe estar soportado por la CPU.
+  class PostProcess {
+  public:
+    explicit PostProcess(Config const & config, SimdLevel level = cpu_simd_level());
+
+    // Media de las muestras por 2^exposure: salida[i] = suma[i] / muestras[i] * escala, o 0 si
+    // el valor no tiene muestras
+    void expose(std::span<float const> suma, std::span<std::uint32_t const> muestras,
+                std::span<float> salida) const;
+    // Aplica el operador de tone mapping del config en el sitio
+    void tone_map(std::span<float> color) const;
+    // Gamma y cuantización: el nivel de quantize_reference, buscado en las tablas
+    void quantize(std::span<float const> color, std::span<std::uint8_t> salida) const;
+    // Las tres etapas sobre un canal; `tmp` es del tamaño del canal y guarda el color expuesto
+    void apply(std::span<float const> suma, std::span<std::uint32_t const> muestras,
+               std::span<float> tmp, std::span<std::uint8_t> salida) const;
+
+    // Las tres etapas para un solo píxel, en escalar
+    [[nodiscard]] Pixel pixel(float r, float g, float b, std::uint32_t muestras) const;
+
+    // Etapas escalares de un valor, sin tabla. Las vectoriales hacen las mismas operaciones y en
+    // el mismo orden (sin FMA); las muestras se convierten a float como enteros con signo.
+    [[nodiscard]] static float exposure_scale(Config const & config);
+    [[nodiscard]] static float expose_value(float suma, std::uint32_t muestras, float escala);
+    [[nodiscard]] static float tone_map_value(ToneMap operador, float x);
+    // Nivel de 0 a 255 de un color ya expuesto y comprimido: 255.99 * c^(1/gamma) saturado,
+    // con std::pow en double (0 para negativos y NaN)
+    [[nodiscard]] static std::uint8_t quantize_reference(float c, double gamma);
+
+    [[nodiscard]] SimdLevel level() const noexcept { return level_; }
+
+    // Los colores de 0 a 1 se agrupan por los 16 bits altos de su representación (signo,
+    // exponente y 7 bits de mantisa); el grupo 16256 es el de 1.0 y recoge los mayores
+    static constexpr int grupo_uno = 16'256;
+
+  private:
+    float escala_;
+    ToneMap tone_map_;
+    SimdLevel level_;
+    // umbrales_[k]: menor color con nivel k o más (umbrales_[0] = -infinito y umbrales_[256] =
+    // NaN, que ninguna comparación supera)
+    std::array<float, 257> umbrales_{};
+    // Nivel del menor color de cada grupo, con 3 bytes de relleno para leerlo con gathers de 32
+    // bits; el nivel de un color se alcanza desde el de su grupo con `pasos_` comparaciones
+    // con el umbral siguiente
+    std::array<std::uint8_t, grupo_uno + 4> base_{};
+    int pasos_ = 0;
+  };
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef RENDER_PROGRESSIVE_HPP
+#define RENDER_PROGRESSIVE_HPP
+
+#include <atomic>
+#include <camera.hpp>
+#include <chrono>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <istream>
+#include <ostream>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector>
+
+namespace render {
+
+  // Muestras acumuladas de todos los píxeles de un render progresivo: suma de colores lineales
+  // (antes de gamma y cuantización), número de muestras y estadísticas de luminancia de cada
+  // píxel. Como cada muestra depende sólo de las semillas, el píxel y su índice, el número de
+  // muestras de un píxel es también la posición de sus generadores.
+  struct ProgressiveBuffer {
+    int ancho = 0;
+    int alto  = 0;
+    // muestras por píxel pedidas hasta ahora (los píxeles convergidos pueden tener menos)
+    int muestras = 0;
+    std::vector<EstadisticasPixel> pixeles;
+
+    ProgressiveBuffer() = default;
+    ProgressiveBuffer(int ancho_, int alto_);
+
+    [[nodiscard]] EstadisticasPixel & at(int fila, int col) {
+      return pixeles[static_cast<std::size_t>(fila) * static_cast<std::size_t>(ancho) +
+                     static_cast<std::size_t>(col)];
+    }
+
+    // Escribe en la imagen la media de las muestras de cada píxel
+    void write(Config const & config, ImageSOA & img) const;
+    // Copia la suma y las muestras de cada píxel en la imagen de acumulación
+    void write(AccumImageSOA & acum) const;
+  };
+
+  // Cancelación cooperativa de un render: se cancela a mano o al llegar al plazo, y los hilos la
+  // consultan entre píxeles (o paquetes), así que paran en un estado consistente
+  class CancelToken {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    CancelToken() = default;
+
+    explicit CancelToken(clock::time_point plazo) : plazo_(plazo) { }
+
+    void cancel() noexcept { cancelado_.store(true, std::memory_order_relaxed); }
+
+    [[nodiscard]] bool cancelled() noexcept {
+      if (cancelado_.load(std::memory_order_relaxed)) {
+        return true;
+      }
+      if (clock::now() >= plazo_) {
+        cancel();
+        return true;
+      }
+      return false;
+    }
+
+  private:
+    std::atomic<bool> cancelado_{false};
+    clock::time_point plazo_ = clock::time_point::max();
+  };
+
+  // Añade muestras a todos los píxeles hasta tener `hasta` (o hasta que converjan), en paralelo
+  // como render_image_soa. Varias pasadas dan la misma imagen que un render con `hasta` muestras.
+  // Si se cancela `cancelar`, la pasada se deja a medias: los píxeles ya calculados conservan sus
+  // muestras nuevas, buffer.muestras no cambia y devuelve false. Pasando la misma `afinidad` a
+  // todas las pasadas, con Partitioner::affinity cada hilo repite las teselas de la anterior.
+  bool render_progressive_pass(Scene const & escena, Config const & config, Camera & camara,
+                               ProgressiveBuffer & buffer, int hasta,
+                               RenderStats * stats = nullptr, CancelToken * cancelar = nullptr,
+                               TileAffinity * afinidad = nullptr);
+
+  // Huella de lo que cambia las muestras: los parámetros del config (cámara, semillas,
+  // muestreador, profundidad, ruleta rusa, fondo y pasadas adaptativas) y la escena (cada objeto
+  // en orden y cada material con sus parámetros). samples_per_pixel, adaptive_threshold, la
+  // estructura de aceleración y el postproceso (gamma, exposición y tone mapping) pueden cambiar
+  // al reanudar.
+  [[nodiscard]] std::uint64_t checkpoint_fingerprint(Config const & config,
+                                                     Scene const & escena);
+
+  // Checkpoint binario: cabecera (firma, versión, tamaño, muestras pedidas y huella del config y
+  // la escena) y las estadísticas de cada píxel. La lectura lanza std::runtime_error si el
+  // fichero está dañado o es de otro render.
+  void write_checkpoint(std::ostream & out, Config const & config, Scene const & escena,
+                        ProgressiveBuffer const & buffer);
+  [[nodiscard]] ProgressiveBuffer read_checkpoint(std::istream & in, Config const & config,
+                                                  Scene const & escena);
+
+  // Guarda el checkpoint en un fichero temporal, lo cierra comprobando que se ha escrito entero
+  // y sólo entonces lo renombra, así que una interrupción o un error de escritura a mitad deja
+  // el checkpoint anterior intacto
+  void save_checkpoint(std::string const & path, Config const & config, Scene const & escena,
+                       ProgressiveBuffer const & buffer);
+  [[nodiscard]] ProgressiveBuffer load_checkpoint(std::string const & path,
+                                                  Config const & config, Scene const & escena);
+
+}  // namespace render
+
+#endif
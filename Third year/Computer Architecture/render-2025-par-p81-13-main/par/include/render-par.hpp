@@ -1,41 +1,285 @@
 #ifndef RENDER_PAR_HPP
 #define RENDER_PAR_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <camera.hpp>
 #include <config.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <image_par.hpp>
-#include <random>
+#include <intersection.hpp>
+#include <memory>
+#include <optional>
+#include <partitioner.hpp>
+#include <pixel.hpp>
+#include <sampler.hpp>
 #include <scene.hpp>
+#include <span>
 #include <vector.hpp>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/cache_aligned_allocator.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/task_arena.h>
 
 namespace render {
 
   class ray;
 
+  // Los números de cada muestra salen del muestreador del config (Philox o Sobol barajado) con la
+  // semilla del config, el píxel, la muestra y la dimensión, así que la imagen es la misma con
+  // cualquier número de hilos, particionador o motor. El flujo de rayos da el desplazamiento de
+  // anti-aliasing (dimensiones 0 y 1); el de materiales reserva dimensiones_por_rebote números a
+  // cada rebote, empezando en rebote * dimensiones_por_rebote.
+  inline constexpr std::uint32_t dimensiones_por_rebote = 16;
+
+  // Píxel de la imagen como índice del generador
+  [[nodiscard]] inline std::uint64_t indice_pixel(int fila, int col, Camera const & camara) {
+    return static_cast<std::uint64_t>(fila) * static_cast<std::uint64_t>(camara.ancho_imagen) +
+           static_cast<std::uint64_t>(col);
+  }
+
+  // Ejecuta f con los hilos del config: en un task_arena propio si config.threads > 0 y, si no,
+  // en el del llamador (por defecto, todos los del sistema)
+  template <typename F>
+  void con_hilos(Config const & config, F const & f) {
+    if (config.threads > 0) {
+      oneapi::tbb::task_arena arena(config.threads);
+      arena.execute(f);
+    } else {
+      f();
+    }
+  }
+
+  // Tesela rectangular de la imagen
+  struct Tile {
+    int fila0, col0;
+    int filas, cols;
+  };
+
+  // Lado de las teselas: config.tile_size redondeado a un múltiplo del lado de los paquetes, para
+  // que cada paquete quede dentro de una tesela
+  [[nodiscard]] inline int lado_tesela(Config const & config) {
+    return std::max(1, config.tile_size / config.packet_size) * config.packet_size;
+  }
+
+  // Teselas de `lado` de lado que cubren una imagen de ancho x alto, en orden de Morton (curva Z)
+  // sobre la rejilla de teselas: teselas consecutivas, que suele calcular el mismo hilo, están
+  // cerca en la imagen y recorren las mismas partes de la escena
+  [[nodiscard]] std::vector<Tile> morton_tiles(int ancho, int alto, int lado);
+
+  // Repartos de Partitioner::affinity que se conservan entre renders de la misma imagen (pasadas
+  // del render progresivo, repeticiones del autotuner): cada render da a cada hilo las teselas
+  // que calculó en el anterior. Hay uno por parallel_for de teselas del render (uno por nodo
+  // NUMA en render_image_numa). affinity_partitioner recuerda slots de un task_arena, y en un
+  // arena nuevo esos slots son otros hilos, así que cada reparto guarda también el arena en el
+  // que se usa. Lo crea el llamador, que lo pasa a todos los renders; sus métodos no se pueden
+  // llamar durante un render.
+  class TileAffinity {
+  public:
+    // Reparto i; los que faltan se crean vacíos
+    [[nodiscard]] oneapi::tbb::affinity_partitioner & reparto(std::size_t i);
+    // Arena del reparto i con `hilos` hilos en el nodo NUMA `nodo`: se crea en la primera llamada
+    // y se reutiliza en las siguientes. Si cambian los hilos o el nodo se crea otro y el reparto
+    // empieza de cero.
+    [[nodiscard]] oneapi::tbb::task_arena & arena(std::size_t i, int hilos,
+                                                  int nodo = oneapi::tbb::task_arena::automatic);
+
+  private:
+    struct Reparto {
+      int hilos = 0;
+      int nodo  = oneapi::tbb::task_arena::automatic;
+      std::optional<oneapi::tbb::task_arena> arena;
+      oneapi::tbb::affinity_partitioner particionador;
+    };
+
+    Reparto & en(std::size_t i);
+
+    // affinity_partitioner no se puede mover
+    std::vector<std::unique_ptr<Reparto>> repartos_;
+  };
+
+  // parallel_for sobre los índices [primero, ultimo) con el particionador del config, en el arena
+  // del llamador; con el particionador simple cada tarea es un índice. Con affinity se usa
+  // `afinidad`, el reparto guardado de este bucle; sin él, el reparto empieza de cero en cada
+  // llamada y equivale a automatic.
+  template <typename Cuerpo>
+  void parallel_for_particionado(std::size_t primero, std::size_t ultimo, Config const & config,
+                                 Cuerpo const & cuerpo,
+                                 oneapi::tbb::affinity_partitioner * afinidad = nullptr) {
+    oneapi::tbb::blocked_range<std::size_t> const rango(primero, ultimo, 1);
+    switch (config.partitioner) {
+      case Partitioner::simple:
+        oneapi::tbb::parallel_for(rango, cuerpo, oneapi::tbb::simple_partitioner());
+        break;
+      case Partitioner::automatic:
+        oneapi::tbb::parallel_for(rango, cuerpo, oneapi::tbb::auto_partitioner());
+        break;
+      case Partitioner::affinity:
+        if (afinidad != nullptr) {
+          oneapi::tbb::parallel_for(rango, cuerpo, *afinidad);
+        } else {
+          oneapi::tbb::affinity_partitioner nueva;
+          oneapi::tbb::parallel_for(rango, cuerpo, nueva);
+        }
+        break;
+    }
+  }
+
+  // parallel_for sobre los índices [0, n) con los hilos y el particionador del config. Con
+  // `afinidad` el reparto de affinity es el primero de `afinidad` y, si config.threads > 0, se
+  // ejecuta en su arena en lugar de en uno nuevo.
+  template <typename Cuerpo>
+  void parallel_for_tiles(std::size_t n, Config const & config, Cuerpo const & cuerpo,
+                          TileAffinity * afinidad = nullptr) {
+    if (afinidad == nullptr) {
+      con_hilos(config, [&] { parallel_for_particionado(0, n, config, cuerpo); });
+    } else if (config.threads > 0) {
+      oneapi::tbb::task_arena & arena             = afinidad->arena(0, config.threads);
+      oneapi::tbb::affinity_partitioner & reparto = afinidad->reparto(0);
+      arena.execute([&] { parallel_for_particionado(0, n, config, cuerpo, &reparto); });
+    } else {
+      parallel_for_particionado(0, n, config, cuerpo, &afinidad->reparto(0));
+    }
+  }
+
+  // Sumas y muestras de los píxeles de una tesela por canales y por filas de `cols`, en memoria
+  // alineada a líneas de caché. Cada hilo reutiliza el suyo, así que los hilos no escriben en las
+  // mismas líneas de la imagen y set no comprueba límites: la tesela se copia entera con
+  // AccumImageSOA::set_block.
+  struct TileBuffer {
+    std::vector<float, oneapi::tbb::cache_aligned_allocator<float>> r, g, b;
+    std::vector<std::uint32_t, oneapi::tbb::cache_aligned_allocator<std::uint32_t>> muestras;
+    int cols = 0;
+
+    void reset(int filas, int cols_) {
+      cols                = cols_;
+      std::size_t const n = static_cast<std::size_t>(filas) * static_cast<std::size_t>(cols_);
+      r.resize(n);
+      g.resize(n);
+      b.resize(n);
+      muestras.resize(n);
+    }
+
+    void set(int fila, int col, vector suma, int n) noexcept {
+      std::size_t const i =
+          static_cast<std::size_t>(fila) * static_cast<std::size_t>(cols) +
+          static_cast<std::size_t>(col);
+      r[i]        = static_cast<float>(suma.x);
+      g[i]        = static_cast<float>(suma.y);
+      b[i]        = static_cast<float>(suma.z);
+      muestras[i] = static_cast<std::uint32_t>(n);
+    }
+
+    // Copia la tesela `t` en la imagen de acumulación
+    void write(Tile const & t, AccumImageSOA & acum) const {
+      acum.set_block(t.col0, t.fila0, t.cols, t.filas, static_cast<std::size_t>(cols), r, g, b,
+                     muestras);
+    }
+  };
+
   // Contexto compartido para el renderizado paralelo
   struct RenderContext {
     Scene const * escena;
     Config const * config;
     Camera * camara;
     ImageSOA * img;
-    std::mt19937_64 * ray_rng;
-    std::mt19937_64 * material_rng;
+    // Flujo de materiales de la muestra en curso; calcular_pixel_soa lo fija antes de cada muestra
+    Sampler material_rng;
+    // Muestras y rebotes (dispersiones en un material) calculados con este contexto
+    std::uint64_t muestras = 0;
+    std::uint64_t rebotes  = 0;
+
+    RenderContext(Scene const & escena_, Config const & config_, Camera & camara_, ImageSOA & img_)
+        : escena(&escena_), config(&config_), camara(&camara_), img(&img_) { }
 
-    RenderContext(Scene const & escena_, Config const & config_, Camera & camara_, ImageSOA & img_,
-                  std::mt19937_64 & ray_rng_, std::mt19937_64 & material_rng_)
-        : escena(&escena_), config(&config_), camara(&camara_), img(&img_), ray_rng(&ray_rng_),
-          material_rng(&material_rng_) { }
+    // Prepara el flujo de materiales para la muestra `sample` del píxel `pixel`
+    void empezar_muestra(std::uint64_t pixel, std::uint32_t sample) {
+      material_rng = Sampler(config->sampler, config->material_rng_seed, pixel, sample);
+    }
   };
 
-  // Renderiza la imagen usando el enfoque Structure of Arrays (SoA)
+  // Trabajo total de un render, sumado por todos los hilos
+  struct RenderStats {
+    std::atomic<std::uint64_t> muestras{0};
+    std::atomic<std::uint64_t> rebotes{0};
+  };
+
+  // Muestras de un píxel: suma de los colores y media y varianza de la luminancia, acumuladas
+  // muestra a muestra con el algoritmo de Welford
+  struct EstadisticasPixel {
+    vector suma{0.0, 0.0, 0.0};
+    int muestras = 0;
+    double media = 0.0;
+    double m2    = 0.0;
+
+    void anadir(vector const & color);
+    // true si el muestreo adaptativo del config da el píxel por terminado: el intervalo de
+    // confianza del 95 % de la luminancia es más estrecho que adaptive_threshold veces la media
+    // (para los píxeles muy oscuros, que 1/256)
+    [[nodiscard]] bool convergido(Config const & config) const;
+    // true si el píxel debe seguir muestreándose para llegar a `hasta` muestras: no ha llegado y
+    // no ha convergido al final de una pasada
+    [[nodiscard]] bool necesita_muestras(int hasta, Config const & config) const;
+  };
+
+  // Muestras de cada pasada de un píxel: la convergencia sólo se comprueba al final de una
+  // pasada, así que todos los motores paran cada píxel en la misma muestra
+  [[nodiscard]] int muestras_por_pasada(Config const & config);
+
+  // Renderiza la imagen usando el enfoque Structure of Arrays (SoA): render_image_accum en una
+  // imagen de acumulación del tamaño de la cámara y quantize. Si se pasa `stats`, se le suman
+  // las muestras y rebotes calculados; `afinidad` guarda el reparto de affinity entre renders.
   ImageSOA render_image_soa(Scene const & escena, Config const & config, Camera & cam,
-                            ImageSOA & img);
-  std::pair<std::vector<std::uint64_t>, std::vector<std::uint64_t>> generar_semillas_soa(
-      int hilos, Config const & config);
+                            ImageSOA & img, RenderStats * stats = nullptr,
+                            TileAffinity * afinidad = nullptr);
+  // Suma y número de muestras de cada píxel, sin gamma ni cuantización
+  void render_image_accum(Scene const & escena, Config const & config, Camera & cam,
+                          AccumImageSOA & acum, RenderStats * stats = nullptr,
+                          TileAffinity * afinidad = nullptr);
+  // Paso final de la imagen de acumulación a la de 8 bits con las etapas de PostProcess, en
+  // paralelo por bloques de filas
+  void quantize(AccumImageSOA const & acum, Config const & config, ImageSOA & img);
 
+  // Color final de un píxel con `muestras` muestras de suma (r, g, b): las etapas escalares de
+  // PostProcess con std::pow en vez de la tabla, para píxeles sueltos. Da el mismo color que
+  // quantize.
+  [[nodiscard]] Pixel color_pixel(float r, float g, float b, std::uint32_t muestras,
+                                  Config const & config);
   void calcular_pixel_soa(int fila, int col, RenderContext & ctx);
+  // Sigue muestreando un píxel desde las muestras que ya tiene `estadisticas` hasta `hasta`
+  // muestras o hasta que converja. Como cada muestra depende sólo del píxel y de su índice, da lo
+  // mismo que muestrear todo de una vez.
+  void muestrear_pixel(int fila, int col, EstadisticasPixel & estadisticas, int hasta,
+                       RenderContext & ctx);
+  // Escribe en la imagen la media de las `muestras` muestras de un píxel cuya suma es `acumulado`,
+  // redondeada a float como en la imagen de acumulación para que todos los caminos den el mismo
+  // color
+  void escribir_pixel(int fila, int col, vector acumulado, int muestras, Config const & config,
+                      ImageSOA & img);
+  void calcular_paquete_soa(int fila0, int col0, RenderContext & ctx);
+  // Calcula los píxeles de la tesela `t` en `buffer`, píxel a píxel o por paquetes
+  void calcular_tesela(Tile const & t, TileBuffer & buffer, RenderContext & ctx);
+  // muestrear_pixel para los píxeles de un paquete con esquina (fila0, col0); las estadísticas
+  // del píxel (i, j) del paquete son estadisticas[i * paso + j]
+  void muestrear_paquete(int fila0, int col0, std::span<EstadisticasPixel> estadisticas,
+                         std::size_t paso, int hasta, RenderContext & ctx);
   vector soa_calcular_color(ray const & r, int profundidad, RenderContext & render);
+  vector soa_color_impacto(ray const & r, std::optional<Intersection> const & inter_mas_cercana,
+                           int profundidad, RenderContext & render);
   vector soa_calcular_fondo(ray const & r, Config const & config);
+  // Decide por ruleta rusa si sigue un camino con la reflectancia acumulada `throughput` tras
+  // `rebotes` rebotes. Si sigue, divide `throughput` por la probabilidad de supervivencia para que
+  // el estimador no tenga sesgo; sin ruleta rusa configurada siempre sigue.
+  bool sobrevive_ruleta_rusa(vector & throughput, int rebotes, Config const & config,
+                             Sampler & rng);
+  // Desplazamiento de anti-aliasing (u, v) de la muestra `sample` del píxel `pixel`
+  void desplazamiento_muestra(std::uint64_t pixel, std::uint32_t sample, Config const & config,
+                              double & u, double & v);
 
 }  // namespace render
 
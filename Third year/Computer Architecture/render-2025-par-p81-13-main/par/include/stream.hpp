@@ -0,0 +1,71 @@
+#ifndef RENDER_STREAM_HPP
+#define RENDER_STREAM_HPP
+
+#include <atomic>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <fstream>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/concurrent_queue.h>
+
+namespace render {
+
+  // Filas completas y consecutivas de una imagen en bytes RGB intercalados (como en P6)
+  struct RowBand {
+    int fila0 = 0;
+    int filas = 0;
+    std::vector<unsigned char> rgb;
+  };
+
+  // Escritor de un fichero P6 en segundo plano. El fichero se crea con su tamaño final y un hilo
+  // propio escribe cada franja que recibe en su posición, en cualquier orden. La cola está
+  // acotada a `capacidad` franjas: push espera si el escritor va por detrás, así que la memoria
+  // no depende del tamaño de la imagen.
+  class P6StreamWriter {
+  public:
+    P6StreamWriter(std::string const & path, int ancho, int alto, std::size_t capacidad = 8);
+    P6StreamWriter(P6StreamWriter const &)             = delete;
+    P6StreamWriter & operator=(P6StreamWriter const &) = delete;
+    // Termina el hilo escritor sin comprobar errores; usar finish para comprobarlos
+    ~P6StreamWriter();
+
+    [[nodiscard]] int width() const noexcept { return ancho_; }
+
+    [[nodiscard]] int height() const noexcept { return alto_; }
+
+    // Encola una franja de la imagen; lanza std::invalid_argument si se sale de ella
+    void push(RowBand franja);
+    // Espera a que se escriban todas las franjas; lanza std::runtime_error si alguna escritura
+    // ha fallado
+    void finish();
+
+  private:
+    void escribir();
+
+    std::ofstream out_;
+    std::string path_;
+    int ancho_;
+    int alto_;
+    std::streamoff cabecera_ = 0;
+    oneapi::tbb::concurrent_bounded_queue<RowBand> cola_;
+    std::atomic<bool> fallo_{false};
+    std::thread hilo_;
+  };
+
+  // Render con salida en streaming: la imagen se calcula por franjas de lado_tesela(config) filas
+  // (cada una tesela a tesela, en paralelo con los hilos y el particionador del config) y cada
+  // franja terminada se entrega al escritor. Sólo hay en memoria las franjas en cálculo y las de
+  // la cola; el fichero es el mismo que el de render_image_soa escrito en P6.
+  void render_image_stream(Scene const & escena, Config const & config, Camera & camara,
+                           P6StreamWriter & salida, RenderStats * stats = nullptr);
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef RENDER_WAVEFRONT_HPP
+#define RENDER_WAVEFRONT_HPP
+
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector>
+
+namespace render {
+
+  // Motor de render seleccionable desde la línea de órdenes
+  enum class Engine : std::uint8_t { recursive, wavefront };
+
+  // Interpreta el nombre de un motor ("recursive" o "wavefront"); lanza std::invalid_argument si
+  // no existe
+  [[nodiscard]] Engine parse_engine(std::string const & name);
+
+  // Etapa de sombreado del motor wavefront; ambas dan la misma imagen
+  enum class Shading : std::uint8_t {
+    binned,   // impactos agrupados por material, un Material::scatter_batch por grupo
+    per_hit,  // un Material::scatter por impacto en el orden de la cola, para comparar
+  };
+
+  // Cola de caminos por componentes (SoA): rayo actual, atenuación acumulada (throughput) y
+  // camino al que pertenece dentro del lote
+  struct PathQueue {
+    std::vector<double> ox, oy, oz;
+    std::vector<double> dx, dy, dz;
+    std::vector<double> tr, tg, tb;
+    std::vector<std::uint32_t> path;
+
+    [[nodiscard]] std::size_t size() const noexcept { return path.size(); }
+
+    void resize(std::size_t n);
+  };
+
+  // Render por frentes de onda (en anchura): en lugar de seguir cada muestra hasta el final, los
+  // caminos de un lote de píxeles avanzan juntos rebote a rebote por las etapas de generación,
+  // extensión (intersección), fallo (fondo) y sombreado, cada una un parallel_for de TBB por
+  // bloques sobre las colas SoA. Cada camino usa los mismos muestreadores que su muestra en
+  // render_image_soa, así que la imagen es la misma. Con muestreo adaptativo cada lote se traza
+  // por pasadas de muestras_por_pasada muestras de los píxeles que aún no han convergido.
+  void render_image_wavefront(Scene const & escena, Config const & config, Camera & camara,
+                              AccumImageSOA & acum, RenderStats * stats = nullptr,
+                              Shading sombreado = Shading::binned);
+  // render_image_wavefront en una imagen de acumulación y quantize
+  ImageSOA render_image_wavefront(Scene const & escena, Config const & config, Camera & camara,
+                                  ImageSOA & img, RenderStats * stats = nullptr,
+                                  Shading sombreado = Shading::binned);
+
+}  // namespace render
+
+#endif
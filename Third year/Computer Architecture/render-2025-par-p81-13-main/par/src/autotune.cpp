@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <array>
+#include <autotune.hpp>
+#include <camera.hpp>
+#include <chrono>
+#include <config.hpp>
+#include <image_par.hpp>
+#include <limits>
+#include <partitioner.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb/info.h>
+
+namespace render {
+
+  std::string partitioner_name(Partitioner p) {
+    switch (p) {
+      case Partitioner::simple:    return "simple";
+      case Partitioner::automatic: return "auto";
+      case Partitioner::affinity:  return "affinity";
+    }
+    return "";
+  }
+
+  std::vector<TuneResult> autotune(Scene const & escena, Config const & config, int muestras,
+                                   int repeticiones) {
+    // lados de bloque distintos una vez redondeados al lado de los paquetes (lado_tesela)
+    std::vector<int> lados;
+    for (int const lado : {1, 4, 8, 16, 32, 64}) {
+      Config c           = config;
+      c.tile_size        = lado;
+      int const efectivo = lado_tesela(c);
+      if (std::ranges::find(lados, efectivo) == lados.end()) {
+        lados.push_back(efectivo);
+      }
+    }
+    constexpr std::array<Partitioner, 3> particionadores{
+      Partitioner::simple, Partitioner::automatic, Partitioner::affinity};
+    int const todos = oneapi::tbb::info::default_concurrency();
+    std::vector<int> hilos{todos};
+    if (todos > 1) {
+      hilos.push_back(todos / 2);
+    }
+
+    Config piloto            = config;
+    piloto.samples_per_pixel = std::min(config.samples_per_pixel, muestras);
+    Camera camara(piloto);
+    ImageSOA img(camara.ancho_imagen, camara.alto_imagen);
+    std::vector<TuneResult> resultados;
+    for (int const h : hilos) {
+      for (int const lado : lados) {
+        for (Partitioner const p : particionadores) {
+          piloto.threads     = h;
+          piloto.tile_size   = lado;
+          piloto.partitioner = p;
+          double mejor       = std::numeric_limits<double>::infinity();
+          // las repeticiones conservan el reparto de affinity de la anterior
+          TileAffinity afinidad;
+          for (int i = 0; i < repeticiones; ++i) {
+            auto const inicio = std::chrono::steady_clock::now();
+            (void) render_image_soa(escena, piloto, camara, img, nullptr, &afinidad);
+            std::chrono::duration<double> const t = std::chrono::steady_clock::now() - inicio;
+            mejor                                 = std::min(mejor, t.count());
+          }
+          resultados.push_back({h, lado, p, mejor});
+        }
+      }
+    }
+    std::ranges::sort(resultados, {}, &TuneResult::seconds);
+    return resultados;
+  }
+
+}  // namespace render
@@ -1,9 +1,123 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
 #include <image_par.hpp>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <pixel.hpp>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+
+namespace {
+
+  // Filas de cada bloque de la salida P3 en paralelo
+  constexpr int filas_por_bloque = 16;
+
+  // Caracteres de un canal escrito en decimal
+  std::size_t digitos(std::uint8_t v) {
+    return v >= 100 ? 3 : (v >= 10 ? 2 : 1);
+  }
+
+  std::uint8_t saturar(int v) {
+    return static_cast<std::uint8_t>(std::clamp(v, 0, 255));
+  }
+
+  // Comprueba que un bloque de w x h con esquina (x, y) cabe en una imagen de ancho x alto y que
+  // sus canales, por filas de `paso` elementos, tienen al menos `n` elementos
+  void comprobar_bloque(int x, int y, int w, int h, std::size_t paso, std::size_t n, int ancho,
+                        int alto) {
+    if (x < 0 or y < 0 or x + w > ancho or y + h > alto) {
+      std::ostringstream oss;
+      oss << "block out of range: " << w << "x" << h << " at (" << x << "," << y
+          << ") for size " << ancho << "x" << alto;
+      throw std::out_of_range(oss.str());
+    }
+    std::size_t const ultima = static_cast<std::size_t>(h - 1) * paso + static_cast<std::size_t>(w);
+    if (paso < static_cast<std::size_t>(w) or n < ultima) {
+      throw std::invalid_argument("block channels smaller than the block");
+    }
+  }
+
+  // Copia por filas un bloque ya comprobado de un canal
+  template <typename T>
+  void copiar_bloque(int x, int y, int w, int h, std::size_t paso, std::span<T const> origen,
+                     std::vector<T> & destino, int ancho) {
+    for (std::size_t fila = 0; fila < static_cast<std::size_t>(h); ++fila) {
+      std::size_t const idx = (static_cast<std::size_t>(y) + fila) *
+                                  static_cast<std::size_t>(ancho) +
+                              static_cast<std::size_t>(x);
+      std::copy_n(origen.begin() + static_cast<std::ptrdiff_t>(fila * paso),
+                  static_cast<std::size_t>(w), destino.begin() + static_cast<std::ptrdiff_t>(idx));
+    }
+  }
+
+  std::string cabecera(char const * firma, int w, int h) {
+    return std::string(firma) + '\n' + std::to_string(w) + ' ' + std::to_string(h) + "\n255\n";
+  }
+
+  // Bytes de un valor en little endian
+  template <typename T>
+  std::array<char, sizeof(T)> little_endian(T valor) {
+    auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(valor);
+    if constexpr (std::endian::native == std::endian::big) {
+      std::ranges::reverse(bytes);
+    }
+    return bytes;
+  }
+
+  // Escribe un valor en little endian en `p` y avanza
+  template <typename T>
+  void poner(char *& p, T valor) {
+    auto const bytes = little_endian(valor);
+    p                = std::copy(bytes.begin(), bytes.end(), p);
+  }
+
+  template <typename T>
+  void anadir(std::string & s, T valor) {
+    auto const bytes = little_endian(valor);
+    s.append(bytes.begin(), bytes.end());
+  }
+
+  // Atributo de la cabecera de un OpenEXR: nombre, tipo, tamaño y valor
+  void atributo_exr(std::string & s, char const * nombre, char const * tipo,
+                    std::string const & valor) {
+    s.append(nombre).push_back('\0');
+    s.append(tipo).push_back('\0');
+    anadir(s, static_cast<std::int32_t>(valor.size()));
+    s += valor;
+  }
+
+  float media(float suma, std::uint32_t muestras) {
+    return muestras == 0 ? 0.0F : suma / static_cast<float>(muestras);
+  }
+
+}  // namespace
+
+ImageFormat parse_image_format(std::string const & name) {
+  if (name == "p3") {
+    return ImageFormat::p3;
+  }
+  if (name == "p6") {
+    return ImageFormat::p6;
+  }
+  if (name == "pfm") {
+    return ImageFormat::pfm;
+  }
+  if (name == "exr") {
+    return ImageFormat::exr;
+  }
+  throw std::invalid_argument("unknown image format: " + name);
+}
 
 // Función auxiliar para validar coordenadas de píxeles
 inline void ImageSOA::validate_coords(int x, int y, int w, int h) {
@@ -39,9 +153,9 @@ void ImageSOA::set_pixel(int x, int y, Pixel color) {
   validate_coords(x, y, w_, h_);
   std::size_t const idx =
       static_cast<std::size_t>(y) * static_cast<std::size_t>(w_) + static_cast<std::size_t>(x);
-  R_[idx] = color.r;
-  G_[idx] = color.g;
-  B_[idx] = color.b;
+  R_[idx] = saturar(color.r);
+  G_[idx] = saturar(color.g);
+  B_[idx] = saturar(color.b);
 }
 
 Pixel ImageSOA::get_pixel(int x, int y) const {
@@ -51,6 +165,18 @@ Pixel ImageSOA::get_pixel(int x, int y) const {
   return Pixel{R_[idx], G_[idx], B_[idx]};
 }
 
+void ImageSOA::set_block(int x, int y, int w, int h, std::size_t paso,
+                         std::span<std::uint8_t const> r, std::span<std::uint8_t const> g,
+                         std::span<std::uint8_t const> b) {
+  if (w <= 0 or h <= 0) {
+    return;
+  }
+  comprobar_bloque(x, y, w, h, paso, std::min({r.size(), g.size(), b.size()}), w_, h_);
+  copiar_bloque(x, y, w, h, paso, r, R_, w_);
+  copiar_bloque(x, y, w, h, paso, g, G_, w_);
+  copiar_bloque(x, y, w, h, paso, b, B_, w_);
+}
+
 // Método para escribir la imagen en formato PPM (P3)
 void ImageSOA::write_ppm_p3(std::ostream & os) const {
   os << "P3\n" << w_ << ' ' << h_ << '\n' << "255\n";
@@ -62,3 +188,219 @@ void ImageSOA::write_ppm_p3(std::ostream & os) const {
     }
   }
 }
+
+void ImageSOA::write_ppm_p3_parallel(std::ostream & os) const {
+  std::string const cab = cabecera("P3", w_, h_);
+  auto const ancho      = static_cast<std::size_t>(w_);
+  int const bloques     = (h_ + filas_por_bloque - 1) / filas_por_bloque;
+  // índice del primer píxel de un bloque
+  auto primero = [&](int bloque) {
+    return static_cast<std::size_t>(std::min(bloque * filas_por_bloque, h_)) * ancho;
+  };
+  // caracteres de cada bloque y, tras la suma, posición de cada bloque en el buffer
+  std::vector<std::size_t> inicio(static_cast<std::size_t>(bloques) + 1, 0);
+  oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<int>(0, bloques),
+                            [&](oneapi::tbb::blocked_range<int> const & r) {
+                              for (int bloque = r.begin(); bloque != r.end(); ++bloque) {
+                                std::size_t n = 0;
+                                for (std::size_t i = primero(bloque); i < primero(bloque + 1);
+                                     ++i) {
+                                  n += digitos(R_[i]) + digitos(G_[i]) + digitos(B_[i]) + 3;
+                                }
+                                inicio[static_cast<std::size_t>(bloque) + 1] = n;
+                              }
+                            });
+  std::inclusive_scan(inicio.begin(), inicio.end(), inicio.begin());
+
+  std::size_t const total = cab.size() + inicio.back();
+  auto const buffer       = std::make_unique_for_overwrite<char[]>(total);
+  std::copy(cab.begin(), cab.end(), buffer.get());
+  char * const datos = buffer.get() + cab.size();
+  oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<int>(0, bloques),
+                            [&](oneapi::tbb::blocked_range<int> const & r) {
+                              for (int bloque = r.begin(); bloque != r.end(); ++bloque) {
+                                char * p = datos + inicio[static_cast<std::size_t>(bloque)];
+                                char * const fin =
+                                    datos + inicio[static_cast<std::size_t>(bloque) + 1];
+                                for (std::size_t i = primero(bloque); i < primero(bloque + 1);
+                                     ++i) {
+                                  p    = std::to_chars(p, fin, R_[i]).ptr;
+                                  *p++ = ' ';
+                                  p    = std::to_chars(p, fin, G_[i]).ptr;
+                                  *p++ = ' ';
+                                  p    = std::to_chars(p, fin, B_[i]).ptr;
+                                  *p++ = '\n';
+                                }
+                              }
+                            });
+  os.write(buffer.get(), static_cast<std::streamsize>(total));
+}
+
+void ImageSOA::write_ppm_p6(std::ostream & os) const {
+  std::string const cab   = cabecera("P6", w_, h_);
+  auto const ancho        = static_cast<std::size_t>(w_);
+  std::size_t const total = cab.size() + 3 * ancho * static_cast<std::size_t>(h_);
+  auto const buffer       = std::make_unique_for_overwrite<char[]>(total);
+  std::copy(cab.begin(), cab.end(), buffer.get());
+  auto * const datos = reinterpret_cast<std::uint8_t *>(buffer.get() + cab.size());
+  oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<int>(0, h_),
+                            [&](oneapi::tbb::blocked_range<int> const & r) {
+                              for (std::size_t i = static_cast<std::size_t>(r.begin()) * ancho;
+                                   i < static_cast<std::size_t>(r.end()) * ancho; ++i) {
+                                datos[3 * i]     = R_[i];
+                                datos[3 * i + 1] = G_[i];
+                                datos[3 * i + 2] = B_[i];
+                              }
+                            });
+  os.write(buffer.get(), static_cast<std::streamsize>(total));
+}
+
+void ImageSOA::write(std::ostream & os, ImageFormat formato) const {
+  switch (formato) {
+    case ImageFormat::p3:
+      write_ppm_p3_parallel(os);
+      break;
+    case ImageFormat::p6:
+      write_ppm_p6(os);
+      break;
+    case ImageFormat::pfm:
+    case ImageFormat::exr:
+      throw std::invalid_argument("HDR formats are written from the accumulation image");
+  }
+}
+
+// Constructor de la imagen de acumulación, con todas las sumas y muestras a cero
+AccumImageSOA::AccumImageSOA(int width, int height) : w_(width), h_(height) {
+  if (w_ <= 0 or h_ <= 0) {
+    throw std::invalid_argument("width and height must be positive");
+  }
+  std::size_t const n = static_cast<std::size_t>(w_) * static_cast<std::size_t>(h_);
+  R_.assign(n, 0.0F);
+  G_.assign(n, 0.0F);
+  B_.assign(n, 0.0F);
+  N_.assign(n, 0);
+}
+
+void AccumImageSOA::set_pixel(int x, int y, float r, float g, float b, std::uint32_t muestras) {
+  comprobar_bloque(x, y, 1, 1, 1, 1, w_, h_);
+  std::size_t const idx =
+      static_cast<std::size_t>(y) * static_cast<std::size_t>(w_) + static_cast<std::size_t>(x);
+  R_[idx] = r;
+  G_[idx] = g;
+  B_[idx] = b;
+  N_[idx] = muestras;
+}
+
+void AccumImageSOA::set_block(int x, int y, int w, int h, std::size_t paso,
+                              std::span<float const> r, std::span<float const> g,
+                              std::span<float const> b, std::span<std::uint32_t const> muestras) {
+  if (w <= 0 or h <= 0) {
+    return;
+  }
+  comprobar_bloque(x, y, w, h, paso, std::min({r.size(), g.size(), b.size(), muestras.size()}),
+                   w_, h_);
+  copiar_bloque(x, y, w, h, paso, r, R_, w_);
+  copiar_bloque(x, y, w, h, paso, g, G_, w_);
+  copiar_bloque(x, y, w, h, paso, b, B_, w_);
+  copiar_bloque(x, y, w, h, paso, muestras, N_, w_);
+}
+
+void AccumImageSOA::write_pfm(std::ostream & os) const {
+  // escala negativa: floats en little endian
+  std::string const cab   = "PF\n" + std::to_string(w_) + ' ' + std::to_string(h_) + "\n-1.0\n";
+  auto const ancho        = static_cast<std::size_t>(w_);
+  std::size_t const fila  = 3 * sizeof(float) * ancho;
+  std::size_t const total = cab.size() + fila * static_cast<std::size_t>(h_);
+  auto const buffer       = std::make_unique_for_overwrite<char[]>(total);
+  std::copy(cab.begin(), cab.end(), buffer.get());
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<int>(0, h_), [&](oneapi::tbb::blocked_range<int> const & r) {
+        for (int y = r.begin(); y != r.end(); ++y) {
+          auto const desde = static_cast<std::size_t>(y) * ancho;
+          // las filas van de abajo a arriba
+          char * p = buffer.get() + cab.size() + static_cast<std::size_t>(h_ - 1 - y) * fila;
+          for (std::size_t i = desde; i < desde + ancho; ++i) {
+            poner(p, media(R_[i], N_[i]));
+            poner(p, media(G_[i], N_[i]));
+            poner(p, media(B_[i], N_[i]));
+          }
+        }
+      });
+  os.write(buffer.get(), static_cast<std::streamsize>(total));
+}
+
+void AccumImageSOA::write_exr(std::ostream & os) const {
+  std::string cab;
+  anadir(cab, std::int32_t{20'000'630});  // número mágico
+  anadir(cab, std::int32_t{2});           // versión 2, una parte por líneas
+  // canales en orden alfabético, en float (tipo 2) y sin submuestreo
+  std::string canales;
+  for (char const * nombre : {"B", "G", "R"}) {
+    canales.append(nombre).push_back('\0');
+    anadir(canales, std::int32_t{2});
+    anadir(canales, std::int32_t{0});  // pLinear y reservados
+    anadir(canales, std::int32_t{1});
+    anadir(canales, std::int32_t{1});
+  }
+  canales.push_back('\0');
+  std::string ventana;
+  for (std::int32_t const v : {0, 0, w_ - 1, h_ - 1}) {
+    anadir(ventana, v);
+  }
+  std::string flotante;
+  anadir(flotante, 1.0F);
+  std::string centro;
+  anadir(centro, 0.0F);
+  anadir(centro, 0.0F);
+  atributo_exr(cab, "channels", "chlist", canales);
+  atributo_exr(cab, "compression", "compression", std::string(1, '\0'));
+  atributo_exr(cab, "dataWindow", "box2i", ventana);
+  atributo_exr(cab, "displayWindow", "box2i", ventana);
+  atributo_exr(cab, "lineOrder", "lineOrder", std::string(1, '\0'));
+  atributo_exr(cab, "pixelAspectRatio", "float", flotante);
+  atributo_exr(cab, "screenWindowCenter", "v2f", centro);
+  atributo_exr(cab, "screenWindowWidth", "float", flotante);
+  cab.push_back('\0');
+
+  // tras la cabecera, la tabla con la posición de cada línea y las líneas: número de línea,
+  // tamaño de los datos y los canales uno tras otro
+  auto const ancho          = static_cast<std::size_t>(w_);
+  auto const alto           = static_cast<std::size_t>(h_);
+  std::size_t const datos   = 3 * sizeof(float) * ancho;
+  std::size_t const linea   = 2 * sizeof(std::int32_t) + datos;
+  std::size_t const primera = cab.size() + sizeof(std::uint64_t) * alto;
+  std::size_t const total   = primera + linea * alto;
+  auto const buffer         = std::make_unique_for_overwrite<char[]>(total);
+  std::copy(cab.begin(), cab.end(), buffer.get());
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<int>(0, h_), [&](oneapi::tbb::blocked_range<int> const & r) {
+        for (int y = r.begin(); y != r.end(); ++y) {
+          auto const fila = static_cast<std::size_t>(y);
+          char * tabla    = buffer.get() + cab.size() + sizeof(std::uint64_t) * fila;
+          poner(tabla, static_cast<std::uint64_t>(primera + linea * fila));
+          char * p = buffer.get() + primera + linea * fila;
+          poner(p, static_cast<std::int32_t>(y));
+          poner(p, static_cast<std::int32_t>(datos));
+          for (std::vector<float> const * canal : {&B_, &G_, &R_}) {
+            for (std::size_t i = fila * ancho; i < (fila + 1) * ancho; ++i) {
+              poner(p, media((*canal)[i], N_[i]));
+            }
+          }
+        }
+      });
+  os.write(buffer.get(), static_cast<std::streamsize>(total));
+}
+
+void AccumImageSOA::write(std::ostream & os, ImageFormat formato) const {
+  switch (formato) {
+    case ImageFormat::pfm:
+      write_pfm(os);
+      break;
+    case ImageFormat::exr:
+      write_exr(os);
+      break;
+    case ImageFormat::p3:
+    case ImageFormat::p6:
+      throw std::invalid_argument("8-bit formats are written from the quantized image");
+  }
+}
@@ -1,42 +1,303 @@
+#include <algorithm>
+#include <autotune.hpp>
 #include <camera.hpp>
+#include <chrono>
 #include <config.hpp>
+#include <cstddef>
 #include <exception>
 #include <fstream>
 #include <image_par.hpp>
+#include <iomanip>
 #include <iostream>
+#include <progressive.hpp>
 #include <render-par.hpp>
 #include <scene.hpp>
+#include <stdexcept>
+#include <stream.hpp>
 #include <string>
+#include <utility>
 #include <vector>
+#include <wavefront.hpp>
+
+namespace {
+
+  // Valor entero positivo de una opción --nombre=valor
+  int leer_positivo(std::string const & opcion, std::string const & valor) {
+    std::size_t usados = 0;
+    int n              = 0;
+    try {
+      n = std::stoi(valor, &usados);
+    } catch (std::exception const &) {
+      usados = 0;
+    }
+    if (usados != valor.size() or n <= 0) {
+      throw std::invalid_argument("valor inválido para " + opcion + ": " + valor);
+    }
+    return n;
+  }
+
+  // Valor real positivo de una opción --nombre=valor
+  double leer_segundos(std::string const & opcion, std::string const & valor) {
+    std::size_t usados = 0;
+    double s           = 0.0;
+    try {
+      s = std::stod(valor, &usados);
+    } catch (std::exception const &) {
+      usados = 0;
+    }
+    if (usados != valor.size() or not(s > 0.0)) {
+      throw std::invalid_argument("valor inválido para " + opcion + ": " + valor);
+    }
+    return s;
+  }
+
+  // Escribe la imagen: en PPM (P3 o P6) con gamma y cuantización a 8 bits, o en PFM u OpenEXR
+  // con el color lineal en float
+  bool guardar_imagen(AccumImageSOA const & acum, Config const & config,
+                      std::string const & output_file, ImageFormat formato) {
+    std::ofstream out(output_file, std::ios::binary);
+    if (!out) {
+      std::cerr << "Error al abrir el archivo de salida: " << output_file << '\n';
+      return false;
+    }
+    if (hdr_format(formato)) {
+      acum.write(out, formato);
+    } else {
+      ImageSOA img(acum.width(), acum.height());
+      render::quantize(acum, config, img);
+      img.write(out, formato);
+    }
+    return true;
+  }
+
+  // Tiempo desde `inicio` y muestras por píxel de media del render
+  void imprimir_render(std::chrono::steady_clock::time_point inicio,
+                       render::RenderStats const & stats, render::Camera const & camara) {
+    std::chrono::duration<double> const t_render = std::chrono::steady_clock::now() - inicio;
+    std::cout << "Render: " << t_render.count() << " s\n";
+    std::cout << "Muestras por píxel: "
+              << static_cast<double>(stats.muestras) /
+                     (static_cast<double>(camara.ancho_imagen) * camara.alto_imagen)
+              << '\n';
+  }
+
+  // Opciones del render progresivo
+  struct Progresivo {
+    std::string checkpoint;
+    std::string resume;
+    int muestras_pasada = 4;
+    double cada         = 0.0;
+    // segundos de render disponibles (0 = sin límite)
+    double presupuesto = 0.0;
+
+    [[nodiscard]] bool activo() const {
+      return not checkpoint.empty() or not resume.empty() or presupuesto > 0.0;
+    }
+  };
+
+  // Render por pasadas de muestras_pasada muestras acumuladas en un ProgressiveBuffer, empezando
+  // por el checkpoint `resume` si se da. Tras una pasada, si han pasado `cada` segundos desde el
+  // último, guarda el checkpoint y la imagen con las muestras hasta el momento; al final,
+  // siempre. Con presupuesto de tiempo cada pasada dobla las muestras (1, 2, 4...) hasta
+  // samples_per_pixel o hasta agotar el tiempo, que corta la pasada en curso; la primera pasada
+  // siempre se completa para que ningún píxel se quede sin muestras.
+  bool render_progresivo(Scene const & scene, Config const & config, render::Camera & camara,
+                         AccumImageSOA & acum, render::RenderStats & stats,
+                         Progresivo const & opciones,
+                         std::string const & output_file, ImageFormat formato) {
+    render::ProgressiveBuffer buffer =
+        opciones.resume.empty() ? render::ProgressiveBuffer(camara.ancho_imagen, camara.alto_imagen)
+                                : render::load_checkpoint(opciones.resume, config, scene);
+    if (not opciones.resume.empty()) {
+      std::cout << "Reanudado desde " << opciones.resume << " con " << buffer.muestras
+                << " muestras por píxel\n";
+    }
+    auto ultimo = std::chrono::steady_clock::now();
+    bool const con_presupuesto = opciones.presupuesto > 0.0;
+    render::CancelToken cancelar(
+        con_presupuesto ? ultimo + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(opciones.presupuesto))
+                        : std::chrono::steady_clock::time_point::max());
+    // todas las pasadas recorren las mismas teselas: con affinity repiten el reparto
+    render::TileAffinity afinidad;
+    bool terminada = true;
+    while (terminada and buffer.muestras < config.samples_per_pixel) {
+      int const muestras =
+          con_presupuesto ? std::max(buffer.muestras, 1) : opciones.muestras_pasada;
+      int const hasta = std::min(buffer.muestras + muestras, config.samples_per_pixel);
+      terminada = render::render_progressive_pass(scene, config, camara, buffer, hasta, &stats,
+                                                  buffer.muestras > 0 ? &cancelar : nullptr,
+                                                  &afinidad);
+      std::chrono::duration<double> const desde = std::chrono::steady_clock::now() - ultimo;
+      bool const final = not terminada or buffer.muestras == config.samples_per_pixel;
+      if (not opciones.checkpoint.empty() and (final or desde.count() >= opciones.cada)) {
+        render::save_checkpoint(opciones.checkpoint, config, scene, buffer);
+        buffer.write(acum);
+        if (not guardar_imagen(acum, config, output_file, formato)) {
+          return false;
+        }
+        std::cout << "Checkpoint con " << buffer.muestras << " muestras por píxel\n";
+        ultimo = std::chrono::steady_clock::now();
+      }
+    }
+    if (not terminada) {
+      std::cout << "Tiempo agotado tras las pasadas completas de " << buffer.muestras
+                << " muestras por píxel\n";
+    }
+    buffer.write(acum);
+    return true;
+  }
+
+  // Tabla de los renders piloto del autotuner, del más rápido al más lento, y el mejor reparto
+  // en el formato del archivo de configuración
+  void imprimir_autotune(std::vector<render::TuneResult> const & resultados) {
+    std::cout << std::setw(8) << "hilos" << std::setw(8) << "bloque" << std::setw(12)
+              << "particion" << std::setw(12) << "s" << '\n';
+    for (render::TuneResult const & r : resultados) {
+      std::cout << std::setw(8) << r.threads << std::setw(8) << r.tile_size << std::setw(12)
+                << render::partitioner_name(r.partitioner) << std::setw(12) << r.seconds << '\n';
+    }
+    render::TuneResult const & mejor = resultados.front();
+    std::cout << "Mejor reparto:\n"
+              << "threads: " << mejor.threads << '\n'
+              << "tile_size: " << mejor.tile_size << '\n'
+              << "partitioner: " << render::partitioner_name(mejor.partitioner) << '\n';
+  }
+
+}  // namespace
 
 // Programa principal para renderizar una escena a partir de un archivo de configuración y un archivo de escena.
 int main(int argc, char * argv[]) {
   std::vector<std::string> args(argv, argv + argc);
-  if (argc != 4) {
-    std::cerr << "Uso: " << args.at(0) << " <config_file> <scene_file> <output_image>\n";
+  // opciones --nombre=valor en cualquier posición; el resto son los ficheros
+  std::vector<std::string> ficheros;
+  render::Engine engine = render::Engine::recursive;
+  Progresivo progresivo;
+  ImageFormat formato = ImageFormat::p3;
+  // escribe las franjas terminadas en segundo plano sin guardar la imagen entera
+  bool streaming = false;
+  // claves del config dadas en la línea de órdenes, que sustituyen a las del archivo
+  std::vector<std::pair<std::string, std::string>> claves;
+  bool autotune = false;
+  bool args_ok  = true;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    std::string const & a    = args[i];
+    std::size_t const igual  = a.find('=');
+    std::string const nombre = a.substr(0, igual);
+    std::string const valor  = igual == std::string::npos ? "" : a.substr(igual + 1);
+    try {
+      if (nombre == "--engine") {
+        engine = render::parse_engine(valor);
+      } else if (nombre == "--format") {
+        formato = parse_image_format(valor);
+      } else if (nombre == "--checkpoint") {
+        progresivo.checkpoint = valor;
+      } else if (nombre == "--resume") {
+        progresivo.resume = valor;
+      } else if (nombre == "--pass-samples") {
+        progresivo.muestras_pasada = leer_positivo(nombre, valor);
+      } else if (nombre == "--checkpoint-every") {
+        progresivo.cada = leer_segundos(nombre, valor);
+      } else if (nombre == "--time-budget") {
+        progresivo.presupuesto = leer_segundos(nombre, valor);
+      } else if (nombre == "--threads") {
+        claves.emplace_back("threads", valor);
+      } else if (nombre == "--tile-size") {
+        claves.emplace_back("tile_size", valor);
+      } else if (nombre == "--partitioner") {
+        claves.emplace_back("partitioner", valor);
+      } else if (nombre == "--numa") {
+        claves.emplace_back("numa", valor);
+      } else if (a == "--stream") {
+        streaming = true;
+      } else if (a == "--autotune") {
+        autotune = true;
+      } else if (a.starts_with("--")) {
+        std::cerr << "Error: opción desconocida: " << a << '\n';
+        args_ok = false;
+      } else {
+        ficheros.push_back(a);
+      }
+    } catch (std::invalid_argument const & e) {
+      std::cerr << "Error: " << e.what() << '\n';
+      args_ok = false;
+    }
+  }
+  if (progresivo.activo() and engine == render::Engine::wavefront) {
+    std::cerr << "Error: el render progresivo y por tiempo sólo están disponibles con"
+                 " --engine=recursive\n";
+    args_ok = false;
+  }
+  if (streaming and
+      (progresivo.activo() or engine == render::Engine::wavefront or formato != ImageFormat::p6))
+  {
+    std::cerr << "Error: la salida en streaming sólo está disponible con --format=p6 y"
+                 " --engine=recursive, sin render progresivo ni por tiempo\n";
+    args_ok = false;
+  }
+  if (not args_ok or ficheros.size() != (autotune ? 2U : 3U)) {
+    std::cerr << "Uso: " << args.at(0)
+              << " [--engine=recursive|wavefront] [--format=p3|p6|pfm|exr] [--checkpoint=<fichero>]"
+                 " [--resume=<fichero>]"
+                 " [--pass-samples=N] [--checkpoint-every=S] [--time-budget=S] [--threads=N]"
+                 " [--tile-size=N] [--partitioner=simple|auto|affinity] [--numa=on|off]"
+                 " [--stream] <config_file> <scene_file> <output_image>\n"
+              << "       " << args.at(0) << " --autotune <config_file> <scene_file>\n";
     return 1;
   }
-  std::string const & config_file = args.at(1);
-  std::string const & scene_file  = args.at(2);
-  std::string const & output_file = args.at(3);
+  std::string const & config_file = ficheros.at(0);
+  std::string const & scene_file  = ficheros.at(1);
+  std::string const output_file   = autotune ? "" : ficheros.at(2);
   Config config;
   Scene scene;
   try {
     config.load_config(config_file);
+    for (auto const & [clave, valor] : claves) {
+      config.set_option(clave, valor);
+    }
+    // el reparto por nodos sólo lo hace el render por teselas (render_image_accum)
+    if (config.numa and (progresivo.activo() or streaming or engine == render::Engine::wavefront))
+    {
+      throw std::invalid_argument(
+          "el render por nodos NUMA sólo está disponible con --engine=recursive, sin render"
+          " progresivo, por tiempo ni streaming");
+    }
     scene.load_scene(scene_file);
+    scene.accelerator = config.accelerator;
+    std::cout << "Construcción de la BVH: " << scene.bvh.build_seconds() << " s\n";
+    if (autotune) {
+      imprimir_autotune(render::autotune(scene, config));
+      return 0;
+    }
     render::Camera camara(config);
-    ImageSOA img(camara.ancho_imagen, camara.alto_imagen);
+    render::RenderStats stats;
+    auto const inicio = std::chrono::steady_clock::now();
+    if (streaming) {
+      render::P6StreamWriter salida(output_file, camara.ancho_imagen, camara.alto_imagen);
+      render::render_image_stream(scene, config, camara, salida, &stats);
+      salida.finish();
+      imprimir_render(inicio, stats, camara);
+      std::cout << "Imagen guardada en " << output_file << '\n';
+      return 0;
+    }
+    AccumImageSOA acum(camara.ancho_imagen, camara.alto_imagen);
 
-    // Renderiza la imagen y obtiene los píxeles en formato AOS
-    render::render_image_soa(scene, config, camara, img);
-    // Escribe la imagen en formato PPM (P3)
-    std::ofstream out(output_file);
-    if (!out) {
-      std::cerr << "Error al abrir el archivo de salida: " << output_file << '\n';
+    // Renderiza la imagen y acumula las muestras de cada píxel
+    if (progresivo.activo()) {
+      if (not render_progresivo(scene, config, camara, acum, stats, progresivo, output_file,
+                                formato))
+      {
+        return 1;
+      }
+    } else if (engine == render::Engine::wavefront) {
+      render::render_image_wavefront(scene, config, camara, acum, &stats);
+    } else {
+      render::render_image_accum(scene, config, camara, acum, &stats);
+    }
+    imprimir_render(inicio, stats, camara);
+    if (not guardar_imagen(acum, config, output_file, formato)) {
       return 1;
     }
-    img.write_ppm_p3(out);
-    out.close();
     std::cout << "Imagen guardada en " << output_file << '\n';
 
   } catch (std::exception const & e) {
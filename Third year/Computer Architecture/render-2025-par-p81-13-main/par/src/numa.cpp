@@ -0,0 +1,151 @@
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <image_par.hpp>
+#include <numa.hpp>
+#include <optional>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <stdexcept>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/info.h>
+#include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+
+namespace render {
+
+  namespace {
+
+    // Trabajo de un nodo: su arena (propio o el de su reparto de affinity, que se conserva entre
+    // renders), la copia de la escena y las teselas que calcula, que se reservan y escriben
+    // dentro del arena
+    struct TrabajoNodo {
+      oneapi::tbb::task_arena propio;
+      oneapi::tbb::task_arena * arena             = nullptr;
+      oneapi::tbb::affinity_partitioner * reparto = nullptr;
+      oneapi::tbb::task_group grupo;
+      std::optional<Scene> escena;
+      std::vector<TileBuffer> teselas;
+    };
+
+  }  // namespace
+
+  std::vector<NumaNode> numa_nodes(Config const & config) {
+    std::vector<NumaNode> nodos;
+    for (int const id : oneapi::tbb::info::numa_nodes()) {
+      nodos.push_back({id, oneapi::tbb::info::default_concurrency(id)});
+    }
+    if (config.threads > 0) {
+      return split_threads(nodos, config.threads);
+    }
+    return nodos;
+  }
+
+  std::vector<NumaNode> split_threads(std::vector<NumaNode> const & nodos, int hilos) {
+    long long total = 0;
+    for (NumaNode const & nodo : nodos) {
+      total += nodo.threads;
+    }
+    // el nodo i se queda con los hilos entre los redondeos de las sumas acumuladas anteriores y
+    // la suya, así que el total es exactamente `hilos`
+    std::vector<NumaNode> reparto;
+    long long acumulado = 0;
+    int asignados       = 0;
+    for (NumaNode const & nodo : nodos) {
+      acumulado       += nodo.threads;
+      auto const hasta = static_cast<int>(hilos * acumulado / total);
+      if (hasta > asignados) {
+        reparto.push_back({nodo.id, hasta - asignados});
+      }
+      asignados = hasta;
+    }
+    return reparto;
+  }
+
+  std::vector<std::size_t> split_tiles(std::size_t n, std::vector<NumaNode> const & nodos) {
+    std::size_t total = 0;
+    for (NumaNode const & nodo : nodos) {
+      total += static_cast<std::size_t>(nodo.threads);
+    }
+    std::vector<std::size_t> limites{0};
+    std::size_t acumulado = 0;
+    for (NumaNode const & nodo : nodos) {
+      acumulado += static_cast<std::size_t>(nodo.threads);
+      limites.push_back(n * acumulado / total);
+    }
+    return limites;
+  }
+
+  void render_image_numa(Scene const & escena, Config const & config, Camera & camara,
+                         AccumImageSOA & acum, RenderStats * stats, TileAffinity * afinidad) {
+    if (acum.width() != camara.ancho_imagen or acum.height() != camara.alto_imagen) {
+      throw std::invalid_argument("la imagen de acumulación no es del tamaño de la cámara");
+    }
+    // escena con objetos añadidos sin build_bvh: se renderiza una copia reconstruida
+    if (not escena.up_to_date()) {
+      render_image_numa(escena.rebuilt(), config, camara, acum, stats, afinidad);
+      return;
+    }
+    // la imagen de cada contexto no se usa: los píxeles van a las teselas
+    ImageSOA sin_uso(1, 1);
+    std::vector<Tile> const teselas =
+        morton_tiles(camara.ancho_imagen, camara.alto_imagen, lado_tesela(config));
+    std::vector<NumaNode> const nodos    = numa_nodes(config);
+    std::vector<std::size_t> const tramo = split_tiles(teselas.size(), nodos);
+    bool const replicar                  = nodos.size() > 1;
+
+    // los arenas y repartos se toman antes de lanzar ningún nodo: TileAffinity no se puede tocar
+    // durante un render
+    std::vector<TrabajoNodo> trabajos(nodos.size());
+    for (std::size_t n = 0; n < nodos.size(); ++n) {
+      TrabajoNodo & trabajo = trabajos[n];
+      if (afinidad != nullptr) {
+        trabajo.arena   = &afinidad->arena(n, nodos[n].threads, nodos[n].id);
+        trabajo.reparto = &afinidad->reparto(n);
+      } else {
+        trabajo.propio.initialize(oneapi::tbb::task_arena::constraints{}
+                                      .set_numa_id(nodos[n].id)
+                                      .set_max_concurrency(nodos[n].threads));
+        trabajo.arena = &trabajo.propio;
+      }
+    }
+    for (std::size_t n = 0; n < nodos.size(); ++n) {
+      TrabajoNodo & trabajo = trabajos[n];
+      trabajo.arena->execute([&, n] {
+        trabajo.grupo.run([&, n] {
+          if (replicar) {
+            trabajo.escena.emplace(escena.replica());
+          }
+          Scene const & escena_nodo = replicar ? *trabajo.escena : escena;
+          std::size_t const primera = tramo[n];
+          trabajo.teselas.resize(tramo[n + 1] - primera);
+          parallel_for_particionado(
+              primera, tramo[n + 1], config,
+              [&](oneapi::tbb::blocked_range<std::size_t> const & r) {
+                RenderContext ctx{escena_nodo, config, camara, sin_uso};
+                for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                  calcular_tesela(teselas[i], trabajo.teselas[i - primera], ctx);
+                }
+                if (stats != nullptr) {
+                  stats->muestras += ctx.muestras;
+                  stats->rebotes  += ctx.rebotes;
+                }
+              },
+              trabajo.reparto);
+        });
+      });
+    }
+    for (std::size_t n = 0; n < nodos.size(); ++n) {
+      TrabajoNodo & trabajo = trabajos[n];
+      trabajo.arena->execute([&] { trabajo.grupo.wait(); });
+      for (std::size_t i = tramo[n]; i < tramo[n + 1]; ++i) {
+        trabajo.teselas[i - tramo[n]].write(teselas[i], acum);
+      }
+    }
+  }
+
+}  // namespace render
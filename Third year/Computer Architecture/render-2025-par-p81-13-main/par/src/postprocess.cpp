@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <pixel.hpp>
+#include <postprocess.hpp>
+#include <simd.hpp>
+#include <span>
+#include <stdexcept>
+#include <tone_map.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace render {
+
+  namespace {
+
+    // Coeficientes del ajuste de la curva ACES de Narkowicz:
+    // x (a x + b) / (x (c x + d) + e)
+    constexpr float aces_a = 2.51F;
+    constexpr float aces_b = 0.03F;
+    constexpr float aces_c = 2.43F;
+    constexpr float aces_d = 0.59F;
+    constexpr float aces_e = 0.14F;
+
+    // Tablas de PostProcess para los kernels
+    struct Tablas {
+      float const * umbrales;
+      std::uint8_t const * base;
+      int pasos;
+    };
+
+    // Nivel de c: el del menor color de su grupo más las comparaciones con el umbral siguiente.
+    // Los negativos caen en el grupo 0 y los mayores que 1 en el de 1.0.
+    std::uint8_t nivel(Tablas const & t, float c) {
+      if (std::isnan(c)) {
+        return 0;
+      }
+      int const grupo = std::clamp(std::bit_cast<std::int32_t>(c) >> 16, 0, PostProcess::grupo_uno);
+      unsigned k      = t.base[grupo];
+      for (int p = 0; p < t.pasos; ++p) {
+        k += c >= t.umbrales[k + 1] ? 1U : 0U;
+      }
+      return static_cast<std::uint8_t>(k);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    [[gnu::target("avx2")]] std::size_t expose_avx2(std::span<float const> suma,
+                                                     std::span<std::uint32_t const> muestras,
+                                                     float escala, std::span<float> salida) {
+      __m256 const e    = _mm256_set1_ps(escala);
+      __m256 const cero = _mm256_setzero_ps();
+      std::size_t i     = 0;
+      for (; i + 8 <= suma.size(); i += 8) {
+        __m256 const n = _mm256_cvtepi32_ps(
+            _mm256_loadu_si256(reinterpret_cast<__m256i const *>(muestras.data() + i)));
+        __m256 const media = _mm256_mul_ps(_mm256_div_ps(_mm256_loadu_ps(suma.data() + i), n), e);
+        // sin muestras, 0 en vez de 0 / 0
+        _mm256_storeu_ps(salida.data() + i,
+                         _mm256_and_ps(media, _mm256_cmp_ps(n, cero, _CMP_NEQ_OQ)));
+      }
+      return i;
+    }
+
+    [[gnu::target("avx2")]] inline __m256 tone_map_avx2(ToneMap operador, __m256 x) {
+      if (operador == ToneMap::reinhard) {
+        return _mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.0F), x));
+      }
+      __m256 const num = _mm256_mul_ps(
+          x, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(aces_a), x), _mm256_set1_ps(aces_b)));
+      __m256 const den = _mm256_add_ps(
+          _mm256_mul_ps(
+              x, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(aces_c), x), _mm256_set1_ps(aces_d))),
+          _mm256_set1_ps(aces_e));
+      return _mm256_div_ps(num, den);
+    }
+
+    [[gnu::target("avx2")]] std::size_t tone_map_avx2(ToneMap operador, std::span<float> color) {
+      std::size_t i = 0;
+      for (; i + 8 <= color.size(); i += 8) {
+        _mm256_storeu_ps(color.data() + i,
+                         tone_map_avx2(operador, _mm256_loadu_ps(color.data() + i)));
+      }
+      return i;
+    }
+
+    // nivel() con 8 carriles: el nivel del grupo se lee con un gather de 32 bits del byte de
+    // cada carril y los umbrales siguientes con gathers de float
+    [[gnu::target("avx2")]] std::size_t quantize_avx2(Tablas const & t,
+                                                       std::span<float const> color,
+                                                       std::span<std::uint8_t> salida) {
+      __m256i const cero      = _mm256_setzero_si256();
+      __m256i const ultimo    = _mm256_set1_epi32(PostProcess::grupo_uno);
+      __m256i const byte      = _mm256_set1_epi32(0xFF);
+      __m256i const siguiente = _mm256_set1_epi32(1);
+      auto const * base       = reinterpret_cast<int const *>(t.base);
+      std::size_t i           = 0;
+      for (; i + 8 <= color.size(); i += 8) {
+        __m256 const c      = _mm256_loadu_ps(color.data() + i);
+        __m256i const grupo = _mm256_min_epi32(
+            _mm256_max_epi32(_mm256_srai_epi32(_mm256_castps_si256(c), 16), cero), ultimo);
+        __m256i k = _mm256_and_si256(_mm256_i32gather_epi32(base, grupo, 1), byte);
+        for (int p = 0; p < t.pasos; ++p) {
+          __m256 const u =
+              _mm256_i32gather_ps(t.umbrales, _mm256_add_epi32(k, siguiente), 4);
+          // la comparación vale -1 en los carriles que suben de nivel
+          k = _mm256_sub_epi32(k, _mm256_castps_si256(_mm256_cmp_ps(c, u, _CMP_GE_OQ)));
+        }
+        // NaN: nivel 0
+        k = _mm256_and_si256(k, _mm256_castps_si256(_mm256_cmp_ps(c, c, _CMP_ORD_Q)));
+        __m128i const k16 =
+            _mm_packus_epi32(_mm256_castsi256_si128(k), _mm256_extracti128_si256(k, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(salida.data() + i),
+                         _mm_packus_epi16(k16, k16));
+      }
+      return i;
+    }
+
+    // Los intrínsecos de AVX-512 de GCC 12 usan _mm512_undefined_ps como operando de paso y
+    // provocan falsos avisos de variable sin inicializar
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    [[gnu::target("avx512f")]] std::size_t expose_avx512(std::span<float const> suma,
+                                                          std::span<std::uint32_t const> muestras,
+                                                          float escala, std::span<float> salida) {
+      __m512 const e = _mm512_set1_ps(escala);
+      std::size_t i  = 0;
+      for (; i + 16 <= suma.size(); i += 16) {
+        __m512i const m    = _mm512_loadu_si512(muestras.data() + i);
+        __m512 const media = _mm512_div_ps(_mm512_loadu_ps(suma.data() + i), _mm512_cvtepi32_ps(m));
+        // sin muestras, 0 en vez de 0 / 0
+        __mmask16 const con = _mm512_test_epi32_mask(m, m);
+        _mm512_storeu_ps(salida.data() + i, _mm512_maskz_mul_ps(con, media, e));
+      }
+      return i;
+    }
+
+    [[gnu::target("avx512f")]] inline __m512 tone_map_avx512(ToneMap operador, __m512 x) {
+      if (operador == ToneMap::reinhard) {
+        return _mm512_div_ps(x, _mm512_add_ps(_mm512_set1_ps(1.0F), x));
+      }
+      __m512 const num = _mm512_mul_ps(
+          x, _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(aces_a), x), _mm512_set1_ps(aces_b)));
+      __m512 const den = _mm512_add_ps(
+          _mm512_mul_ps(
+              x, _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(aces_c), x), _mm512_set1_ps(aces_d))),
+          _mm512_set1_ps(aces_e));
+      return _mm512_div_ps(num, den);
+    }
+
+    [[gnu::target("avx512f")]] std::size_t tone_map_avx512(ToneMap operador,
+                                                            std::span<float> color) {
+      std::size_t i = 0;
+      for (; i + 16 <= color.size(); i += 16) {
+        _mm512_storeu_ps(color.data() + i,
+                         tone_map_avx512(operador, _mm512_loadu_ps(color.data() + i)));
+      }
+      return i;
+    }
+
+    [[gnu::target("avx512f")]] std::size_t quantize_avx512(Tablas const & t,
+                                                            std::span<float const> color,
+                                                            std::span<std::uint8_t> salida) {
+      __m512i const cero      = _mm512_setzero_si512();
+      __m512i const ultimo    = _mm512_set1_epi32(PostProcess::grupo_uno);
+      __m512i const byte      = _mm512_set1_epi32(0xFF);
+      __m512i const siguiente = _mm512_set1_epi32(1);
+      std::size_t i           = 0;
+      for (; i + 16 <= color.size(); i += 16) {
+        __m512 const c      = _mm512_loadu_ps(color.data() + i);
+        __m512i const grupo = _mm512_min_epi32(
+            _mm512_max_epi32(_mm512_srai_epi32(_mm512_castps_si512(c), 16), cero), ultimo);
+        __m512i k = _mm512_and_si512(_mm512_i32gather_epi32(grupo, t.base, 1), byte);
+        for (int p = 0; p < t.pasos; ++p) {
+          __m512 const u = _mm512_i32gather_ps(_mm512_add_epi32(k, siguiente), t.umbrales, 4);
+          k = _mm512_mask_add_epi32(k, _mm512_cmp_ps_mask(c, u, _CMP_GE_OQ), k, siguiente);
+        }
+        // NaN: nivel 0
+        k = _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(c, c, _CMP_ORD_Q), k);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(salida.data() + i), _mm512_cvtepi32_epi8(k));
+      }
+      return i;
+    }
+  #pragma GCC diagnostic pop
+#endif
+
+  }  // namespace
+
+  PostProcess::PostProcess(Config const & config, SimdLevel level)
+      : escala_(exposure_scale(config)), tone_map_(config.tone_map), level_(level) {
+    // Cada umbral se busca entre las representaciones de los float de 0 a 1, que crecen con el
+    // valor, así que la tabla da exactamente el nivel de quantize_reference
+    umbrales_[0]            = -std::numeric_limits<float>::infinity();
+    std::uint32_t desde     = 0;
+    std::uint32_t const uno = std::bit_cast<std::uint32_t>(1.0F);
+    for (std::size_t k = 1; k < umbrales_.size(); ++k) {
+      std::uint32_t hasta = uno;
+      while (desde < hasta) {
+        std::uint32_t const medio = desde + (hasta - desde) / 2;
+        if (std::size_t{quantize_reference(std::bit_cast<float>(medio), config.gamma)} >= k) {
+          hasta = medio;
+        } else {
+          desde = medio + 1;
+        }
+      }
+      umbrales_.at(k) = std::bit_cast<float>(desde);
+    }
+    umbrales_[256] = std::numeric_limits<float>::quiet_NaN();
+    // nivel del menor y del mayor color de cada grupo
+    unsigned menor = 0;
+    for (int grupo = 0; grupo <= grupo_uno; ++grupo) {
+      auto const bits = static_cast<std::uint32_t>(grupo) << 16U;
+      while (std::bit_cast<float>(bits) >= umbrales_.at(menor + 1)) {
+        ++menor;
+      }
+      unsigned mayor = menor;
+      while (std::bit_cast<float>(bits | 0xFFFFU) >= umbrales_.at(mayor + 1)) {
+        ++mayor;
+      }
+      base_.at(static_cast<std::size_t>(grupo)) = static_cast<std::uint8_t>(menor);
+      pasos_ = std::max(pasos_, static_cast<int>(mayor - menor));
+    }
+  }
+
+  float PostProcess::exposure_scale(Config const & config) {
+    return static_cast<float>(std::exp2(config.exposure));
+  }
+
+  float PostProcess::expose_value(float suma, std::uint32_t muestras, float escala) {
+    if (muestras == 0) {
+      return 0.0F;
+    }
+    return suma / static_cast<float>(static_cast<std::int32_t>(muestras)) * escala;
+  }
+
+  float PostProcess::tone_map_value(ToneMap operador, float x) {
+    switch (operador) {
+      case ToneMap::reinhard:
+        return x / (1.0F + x);
+      case ToneMap::aces:
+        return (x * (aces_a * x + aces_b)) / (x * (aces_c * x + aces_d) + aces_e);
+      case ToneMap::none:
+        break;
+    }
+    return x;
+  }
+
+  std::uint8_t PostProcess::quantize_reference(float c, double gamma) {
+    if (not(c > 0.0F)) {
+      return 0;
+    }
+    double const v = std::pow(static_cast<double>(c), 1.0 / gamma);
+    return static_cast<std::uint8_t>(255.99 * std::clamp(v, 0.0, 1.0));
+  }
+
+  void PostProcess::expose(std::span<float const> suma, std::span<std::uint32_t const> muestras,
+                           std::span<float> salida) const {
+    if (muestras.size() != suma.size() or salida.size() != suma.size()) {
+      throw std::invalid_argument("canales de distinto tamaño");
+    }
+    std::size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level_) {
+      case SimdLevel::avx512:
+        i = expose_avx512(suma, muestras, escala_, salida);
+        break;
+      case SimdLevel::avx2:
+        i = expose_avx2(suma, muestras, escala_, salida);
+        break;
+      case SimdLevel::scalar:
+        break;
+    }
+#endif
+    for (; i < suma.size(); ++i) {
+      salida[i] = expose_value(suma[i], muestras[i], escala_);
+    }
+  }
+
+  void PostProcess::tone_map(std::span<float> color) const {
+    if (tone_map_ == ToneMap::none) {
+      return;
+    }
+    std::size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level_) {
+      case SimdLevel::avx512:
+        i = tone_map_avx512(tone_map_, color);
+        break;
+      case SimdLevel::avx2:
+        i = tone_map_avx2(tone_map_, color);
+        break;
+      case SimdLevel::scalar:
+        break;
+    }
+#endif
+    for (; i < color.size(); ++i) {
+      color[i] = tone_map_value(tone_map_, color[i]);
+    }
+  }
+
+  void PostProcess::quantize(std::span<float const> color, std::span<std::uint8_t> salida) const {
+    if (salida.size() != color.size()) {
+      throw std::invalid_argument("canales de distinto tamaño");
+    }
+    Tablas const tablas{umbrales_.data(), base_.data(), pasos_};
+    std::size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level_) {
+      case SimdLevel::avx512:
+        i = quantize_avx512(tablas, color, salida);
+        break;
+      case SimdLevel::avx2:
+        i = quantize_avx2(tablas, color, salida);
+        break;
+      case SimdLevel::scalar:
+        break;
+    }
+#endif
+    for (; i < color.size(); ++i) {
+      salida[i] = nivel(tablas, color[i]);
+    }
+  }
+
+  void PostProcess::apply(std::span<float const> suma, std::span<std::uint32_t const> muestras,
+                          std::span<float> tmp, std::span<std::uint8_t> salida) const {
+    expose(suma, muestras, tmp);
+    tone_map(tmp);
+    quantize(tmp, salida);
+  }
+
+  Pixel PostProcess::pixel(float r, float g, float b, std::uint32_t muestras) const {
+    Tablas const tablas{umbrales_.data(), base_.data(), pasos_};
+    auto canal = [&](float suma) {
+      return static_cast<int>(
+          nivel(tablas, tone_map_value(tone_map_, expose_value(suma, muestras, escala_))));
+    };
+    return Pixel{canal(r), canal(g), canal(b)};
+  }
+
+}  // namespace render
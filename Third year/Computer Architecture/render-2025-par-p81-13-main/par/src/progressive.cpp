@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <camera.hpp>
+#include <cylinder.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <image_par.hpp>
+#include <istream>
+#include <material.hpp>
+#include <ostream>
+#include <progressive.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector.hpp>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+
+namespace render {
+
+  namespace {
+
+    constexpr std::array<char, 4> firma_checkpoint{'R', 'P', 'C', 'K'};
+    constexpr std::uint32_t version_checkpoint = 1;
+
+    // Huella FNV-1a de 64 bits, valor a valor
+    class Huella {
+    public:
+      template <typename T>
+      void add(T const & valor) {
+        for (char const byte : std::bit_cast<std::array<char, sizeof(T)>>(valor)) {
+          h_ ^= static_cast<unsigned char>(byte);
+          h_ *= 0x0000'0100'0000'01B3U;
+        }
+      }
+
+      void add(vector const & v) {
+        add(v.x);
+        add(v.y);
+        add(v.z);
+      }
+
+      void add(std::string const & s) {
+        add(s.size());
+        for (char const c : s) {
+          add(c);
+        }
+      }
+
+      [[nodiscard]] std::uint64_t value() const noexcept { return h_; }
+
+    private:
+      std::uint64_t h_ = 0xCBF2'9CE4'8422'2325U;
+    };
+
+    template <typename T>
+    void escribir(std::ostream & out, T const & valor) {
+      auto const bytes = std::bit_cast<std::array<char, sizeof(T)>>(valor);
+      out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    template <typename T>
+    T leer(std::istream & in) {
+      std::array<char, sizeof(T)> bytes{};
+      if (not in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("checkpoint truncado");
+      }
+      return std::bit_cast<T>(bytes);
+    }
+
+  }  // namespace
+
+  ProgressiveBuffer::ProgressiveBuffer(int ancho_, int alto_)
+      : ancho(ancho_), alto(alto_),
+        pixeles(static_cast<std::size_t>(ancho_) * static_cast<std::size_t>(alto_)) { }
+
+  void ProgressiveBuffer::write(Config const & config, ImageSOA & img) const {
+    AccumImageSOA acum(ancho, alto);
+    write(acum);
+    quantize(acum, config, img);
+  }
+
+  void ProgressiveBuffer::write(AccumImageSOA & acum) const {
+    for (int fila = 0; fila < alto; ++fila) {
+      for (int col = 0; col < ancho; ++col) {
+        EstadisticasPixel const & p = pixeles[static_cast<std::size_t>(fila) *
+                                                  static_cast<std::size_t>(ancho) +
+                                              static_cast<std::size_t>(col)];
+        acum.set_pixel(col, fila, static_cast<float>(p.suma.x), static_cast<float>(p.suma.y),
+                       static_cast<float>(p.suma.z), static_cast<std::uint32_t>(p.muestras));
+      }
+    }
+  }
+
+  bool render_progressive_pass(Scene const & escena, Config const & config, Camera & camara,
+                               ProgressiveBuffer & buffer, int hasta, RenderStats * stats,
+                               CancelToken * cancelar, TileAffinity * afinidad) {
+    if (buffer.ancho != camara.ancho_imagen or buffer.alto != camara.alto_imagen) {
+      throw std::invalid_argument("el buffer progresivo no es del tamaño de la imagen");
+    }
+    // escena con objetos añadidos sin build_bvh: se renderiza una copia reconstruida
+    if (not escena.up_to_date()) {
+      return render_progressive_pass(escena.rebuilt(), config, camara, buffer, hasta, stats,
+                                     cancelar, afinidad);
+    }
+    // la imagen de cada contexto no se usa: los píxeles se quedan en el buffer
+    ImageSOA sin_uso(1, 1);
+    auto const paso = static_cast<std::size_t>(buffer.ancho);
+    // paquetes (o píxeles) de cada tesela
+    int const lado = config.packet_size;
+    std::vector<Tile> const teselas =
+        morton_tiles(camara.ancho_imagen, camara.alto_imagen, lado_tesela(config));
+    // algún paquete se ha quedado sin calcular por la cancelación
+    std::atomic<bool> incompleta{false};
+    parallel_for_tiles(
+        teselas.size(), config, [&](oneapi::tbb::blocked_range<std::size_t> const & r) {
+          RenderContext ctx{escena, config, camara, sin_uso};
+          for (std::size_t i = r.begin(); i != r.end() and not incompleta; ++i) {
+            Tile const & t = teselas[i];
+            for (int fila = t.fila0; fila < t.fila0 + t.filas and not incompleta; fila += lado) {
+              for (int col = t.col0; col < t.col0 + t.cols; col += lado) {
+                if (cancelar != nullptr and cancelar->cancelled()) {
+                  incompleta = true;
+                  break;
+                }
+                if (lado > 1) {
+                  std::span<EstadisticasPixel> const desde = std::span{buffer.pixeles}.subspan(
+                      static_cast<std::size_t>(fila) * paso + static_cast<std::size_t>(col));
+                  muestrear_paquete(fila, col, desde, paso, hasta, ctx);
+                } else {
+                  muestrear_pixel(fila, col, buffer.at(fila, col), hasta, ctx);
+                }
+              }
+            }
+          }
+          if (stats != nullptr) {
+            stats->muestras += ctx.muestras;
+            stats->rebotes  += ctx.rebotes;
+          }
+        },
+        afinidad);
+    if (incompleta) {
+      return false;
+    }
+    buffer.muestras = std::max(buffer.muestras, hasta);
+    return true;
+  }
+
+  std::uint64_t checkpoint_fingerprint(Config const & config, Scene const & escena) {
+    Huella h;
+    h.add(config.aspect_w);
+    h.add(config.aspect_h);
+    h.add(config.image_width);
+    h.add(config.camera_position);
+    h.add(config.camera_target);
+    h.add(config.camera_north);
+    h.add(config.field_of_view);
+    h.add(config.max_depth);
+    h.add(config.material_rng_seed);
+    h.add(config.ray_rng_seed);
+    h.add(config.background_dark_color);
+    h.add(config.background_light_color);
+    h.add(config.russian_roulette_depth);
+    h.add(config.sampler);
+    h.add(config.adaptive_min_samples);
+    // objetos en orden, porque decide los empates entre impactos a la misma distancia
+    h.add(escena.objects.size());
+    for (auto const & obj : escena.objects) {
+      auto const * const cilindro = dynamic_cast<Cylinder const *>(obj.get());
+      h.add(cilindro != nullptr);
+      h.add(obj->center);
+      h.add(obj->radius);
+      h.add(obj->material_name);
+      if (cilindro != nullptr) {
+        h.add(cilindro->axis());
+        h.add(cilindro->height());
+      }
+    }
+    // materiales por nombre, que es como los buscan los objetos
+    std::vector<std::string> nombres;
+    for (auto const & [nombre, material] : escena.materials) {
+      nombres.push_back(nombre);
+    }
+    std::ranges::sort(nombres);
+    for (std::string const & nombre : nombres) {
+      h.add(nombre);
+      for (double const p : escena.materials.at(nombre)->parameters()) {
+        h.add(p);
+      }
+    }
+    return h.value();
+  }
+
+  void write_checkpoint(std::ostream & out, Config const & config, Scene const & escena,
+                        ProgressiveBuffer const & buffer) {
+    out.write(firma_checkpoint.data(), firma_checkpoint.size());
+    escribir(out, version_checkpoint);
+    escribir(out, buffer.ancho);
+    escribir(out, buffer.alto);
+    escribir(out, buffer.muestras);
+    escribir(out, checkpoint_fingerprint(config, escena));
+    for (EstadisticasPixel const & p : buffer.pixeles) {
+      escribir(out, p.suma.x);
+      escribir(out, p.suma.y);
+      escribir(out, p.suma.z);
+      escribir(out, p.muestras);
+      escribir(out, p.media);
+      escribir(out, p.m2);
+    }
+    if (not out) {
+      throw std::runtime_error("no se pudo escribir el checkpoint");
+    }
+  }
+
+  ProgressiveBuffer read_checkpoint(std::istream & in, Config const & config,
+                                    Scene const & escena) {
+    if (leer<std::array<char, 4>>(in) != firma_checkpoint or
+        leer<std::uint32_t>(in) != version_checkpoint)
+    {
+      throw std::runtime_error("el fichero no es un checkpoint de esta versión");
+    }
+    int const ancho    = leer<int>(in);
+    int const alto     = leer<int>(in);
+    int const muestras = leer<int>(in);
+    Camera const camara(config);
+    if (ancho != camara.ancho_imagen or alto != camara.alto_imagen or
+        leer<std::uint64_t>(in) != checkpoint_fingerprint(config, escena))
+    {
+      throw std::runtime_error(
+          "el checkpoint es de otro render (cambia la configuración o la escena)");
+    }
+    ProgressiveBuffer buffer(ancho, alto);
+    buffer.muestras = muestras;
+    for (EstadisticasPixel & p : buffer.pixeles) {
+      p.suma.x   = leer<double>(in);
+      p.suma.y   = leer<double>(in);
+      p.suma.z   = leer<double>(in);
+      p.muestras = leer<int>(in);
+      p.media    = leer<double>(in);
+      p.m2       = leer<double>(in);
+    }
+    return buffer;
+  }
+
+  void save_checkpoint(std::string const & path, Config const & config, Scene const & escena,
+                       ProgressiveBuffer const & buffer) {
+    std::string const temporal = path + ".tmp";
+    std::ofstream out(temporal, std::ios::binary);
+    if (not out) {
+      throw std::runtime_error("no se pudo abrir el checkpoint: " + temporal);
+    }
+    write_checkpoint(out, config, escena, buffer);
+    // el vaciado del búfer y el cierre también pueden fallar (disco lleno): hasta comprobarlos
+    // el fichero temporal puede estar cortado y no debe sustituir al checkpoint anterior
+    out.close();
+    if (not out) {
+      throw std::runtime_error("no se pudo escribir el checkpoint: " + temporal);
+    }
+    std::filesystem::rename(temporal, path);
+  }
+
+  ProgressiveBuffer load_checkpoint(std::string const & path, Config const & config,
+                                    Scene const & escena) {
+    std::ifstream in(path, std::ios::binary);
+    if (not in) {
+      throw std::runtime_error("no se pudo abrir el checkpoint: " + path);
+    }
+    return read_checkpoint(in, config, escena);
+  }
+
+}  // namespace render
@@ -1,145 +1,429 @@
 #include <algorithm>
-#include <atomic>
+#include <array>
 #include <camera.hpp>
 #include <cmath>
 #include <config.hpp>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <image_par.hpp>
 #include <intersection.hpp>
 #include <material.hpp>
+#include <memory>
+#include <numa.hpp>
 #include <optional>
 #include <pixel.hpp>
-#include <random>
+#include <postprocess.hpp>
 #include <ray.hpp>
+#include <ray_packet.hpp>
 #include <render-par.hpp>
+#include <sampler.hpp>
 #include <scene.hpp>
+#include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector.hpp>
 #include <vector>
 
 // includes de TBB
-#include <oneapi/tbb/blocked_range2d.h>
+#include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/enumerable_thread_specific.h>
-#include <oneapi/tbb/global_control.h>
-#include <oneapi/tbb/parallel_for.h>
-#include <oneapi/tbb/partitioner.h>
 
 namespace render {
 
-  // Estructura para almacenar los generadores de números aleatorios por hilo
-  struct ThreadLocalRNG {
-    std::mt19937_64 ray_rng;
-    std::mt19937_64 material_rng;
-  };
-
   // funciones auxiliares
-  std::pair<std::vector<std::uint64_t>, std::vector<std::uint64_t>> generar_semillas_soa(
-      int hilos, Config const & config) {
-    std::vector<std::uint64_t> seeds_ray(static_cast<std::size_t>(hilos));
-    std::vector<std::uint64_t> seeds_material(static_cast<std::size_t>(hilos));
-    std::mt19937_64 master_ray_gen(config.ray_rng_seed);
-    std::mt19937_64 master_mat_gen(config.material_rng_seed);
-    std::ranges::generate(seeds_ray.begin(), seeds_ray.end(), std::ref(master_ray_gen));
-    std::ranges::generate(seeds_material.begin(), seeds_material.end(), std::ref(master_mat_gen));
-    return {seeds_ray, seeds_material};
+  void desplazamiento_muestra(std::uint64_t pixel, std::uint32_t sample, Config const & config,
+                              double & u, double & v) {
+    // distribucion uniforme para el anti-aliasing
+    Sampler rng(config.sampler, config.ray_rng_seed, pixel, sample);
+    u = uniform_double(rng, -0.5, 0.5);
+    v = uniform_double(rng, -0.5, 0.5);
+  }
+
+  void EstadisticasPixel::anadir(vector const & color) {
+    suma = vector::add(suma, color);
+    muestras++;
+    double const luminancia = 0.2126 * color.x + 0.7152 * color.y + 0.0722 * color.z;
+    double const delta      = luminancia - media;
+    media                  += delta / muestras;
+    m2                     += delta * (luminancia - media);
+  }
+
+  bool EstadisticasPixel::convergido(Config const & config) const {
+    if (config.adaptive_threshold <= 0.0 or muestras < 2) {
+      return false;
+    }
+    // semianchura del intervalo de confianza del 95 % de la media
+    double const semianchura = 1.96 * std::sqrt(m2 / (muestras - 1) / muestras);
+    return semianchura <= config.adaptive_threshold * std::max(media, 1.0 / 256.0);
+  }
+
+  bool EstadisticasPixel::necesita_muestras(int hasta, Config const & config) const {
+    if (muestras >= hasta) {
+      return false;
+    }
+    return muestras % muestras_por_pasada(config) != 0 or not convergido(config);
+  }
+
+  int muestras_por_pasada(Config const & config) {
+    if (config.adaptive_threshold <= 0.0) {
+      return config.samples_per_pixel;
+    }
+    return std::min(config.adaptive_min_samples, config.samples_per_pixel);
+  }
+
+  namespace {
+
+    // Intercala los bits de x (posiciones pares) y de y (impares)
+    std::uint64_t codigo_morton(std::uint32_t x, std::uint32_t y) {
+      auto separar = [](std::uint64_t v) {
+        v = (v | (v << 16U)) & 0x0000'FFFF'0000'FFFFU;
+        v = (v | (v << 8U)) & 0x00FF'00FF'00FF'00FFU;
+        v = (v | (v << 4U)) & 0x0F0F'0F0F'0F0F'0F0FU;
+        v = (v | (v << 2U)) & 0x3333'3333'3333'3333U;
+        v = (v | (v << 1U)) & 0x5555'5555'5555'5555U;
+        return v;
+      };
+      return separar(x) | (separar(y) << 1U);
+    }
+
+  }  // namespace
+
+  TileAffinity::Reparto & TileAffinity::en(std::size_t i) {
+    while (repartos_.size() <= i) {
+      repartos_.push_back(std::make_unique<Reparto>());
+    }
+    return *repartos_[i];
+  }
+
+  oneapi::tbb::affinity_partitioner & TileAffinity::reparto(std::size_t i) {
+    return en(i).particionador;
+  }
+
+  oneapi::tbb::task_arena & TileAffinity::arena(std::size_t i, int hilos, int nodo) {
+    if (en(i).arena and (repartos_[i]->hilos != hilos or repartos_[i]->nodo != nodo)) {
+      repartos_[i] = std::make_unique<Reparto>();
+    }
+    Reparto & r = *repartos_[i];
+    if (not r.arena) {
+      r.hilos = hilos;
+      r.nodo  = nodo;
+      r.arena.emplace(
+          oneapi::tbb::task_arena::constraints{}.set_numa_id(nodo).set_max_concurrency(hilos));
+    }
+    return *r.arena;
+  }
+
+  std::vector<Tile> morton_tiles(int ancho, int alto, int lado) {
+    int const tx = (ancho + lado - 1) / lado;
+    int const ty = (alto + lado - 1) / lado;
+    std::vector<std::pair<std::uint64_t, Tile>> teselas;
+    teselas.reserve(static_cast<std::size_t>(tx) * static_cast<std::size_t>(ty));
+    for (int j = 0; j < ty; ++j) {
+      for (int i = 0; i < tx; ++i) {
+        int const fila0 = j * lado;
+        int const col0  = i * lado;
+        teselas.emplace_back(
+            codigo_morton(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j)),
+            Tile{fila0, col0, std::min(lado, alto - fila0), std::min(lado, ancho - col0)});
+      }
+    }
+    std::ranges::sort(teselas, {}, &std::pair<std::uint64_t, Tile>::first);
+    std::vector<Tile> orden;
+    orden.reserve(teselas.size());
+    for (auto const & [codigo, t] : teselas) {
+      orden.push_back(t);
+    }
+    return orden;
+  }
+
+  Pixel color_pixel(float r, float g, float b, std::uint32_t muestras, Config const & config) {
+    float const escala = PostProcess::exposure_scale(config);
+    auto canal         = [&](float suma) {
+      float const c = PostProcess::tone_map_value(
+          config.tone_map, PostProcess::expose_value(suma, muestras, escala));
+      return static_cast<int>(PostProcess::quantize_reference(c, config.gamma));
+    };
+    return Pixel{canal(r), canal(g), canal(b)};
+  }
+
+  void escribir_pixel(int fila, int col, render::vector acumulado, int muestras,
+                      Config const & config, ImageSOA & img) {
+    img.set_pixel(col, fila,
+                  color_pixel(static_cast<float>(acumulado.x), static_cast<float>(acumulado.y),
+                              static_cast<float>(acumulado.z),
+                              static_cast<std::uint32_t>(muestras), config));
+  }
+
+  void quantize(AccumImageSOA const & acum, Config const & config, ImageSOA & img) {
+    if (img.width() < acum.width() or img.height() < acum.height()) {
+      throw std::out_of_range("image smaller than the accumulation image");
+    }
+    PostProcess const post(config);
+    auto const ancho = static_cast<std::size_t>(acum.width());
+    oneapi::tbb::parallel_for(
+        oneapi::tbb::blocked_range<int>(0, acum.height()),
+        [&](oneapi::tbb::blocked_range<int> const & filas) {
+          // cada bloque de filas pasa por las etapas canal a canal
+          auto const desde = static_cast<std::size_t>(filas.begin()) * ancho;
+          auto const n     = static_cast<std::size_t>(filas.size()) * ancho;
+          std::vector<float> tmp(n);
+          std::vector<std::uint8_t> r(n);
+          std::vector<std::uint8_t> g(n);
+          std::vector<std::uint8_t> b(n);
+          std::span<std::uint32_t const> const muestras = acum.samples().subspan(desde, n);
+          post.apply(acum.r().subspan(desde, n), muestras, tmp, r);
+          post.apply(acum.g().subspan(desde, n), muestras, tmp, g);
+          post.apply(acum.b().subspan(desde, n), muestras, tmp, b);
+          img.set_block(0, filas.begin(), acum.width(), static_cast<int>(filas.size()), ancho, r,
+                        g, b);
+        });
   }
 
   // Estructura para pasar el contexto de renderizado a las funciones
   void calcular_pixel_soa(int fila, int col, RenderContext & ctx) {
-    render::vector acumulado{0.0, 0.0, 0.0};
-    // generamos la distribucion uniforme para el anti-aliasing
-    std::uniform_real_distribution<double> dist(-0.5, 0.5);
-    Config const & config = *ctx.config;
-    for (int s = 0; s < config.samples_per_pixel; ++s) {
-      // usamos ctx.ray_rng para generar los offsets aleatorios
-      double const u_offset = dist(*ctx.ray_rng);
-      double const v_offset = dist(*ctx.ray_rng);
+    EstadisticasPixel estadisticas;
+    muestrear_pixel(fila, col, estadisticas, ctx.config->samples_per_pixel, ctx);
+    escribir_pixel(fila, col, estadisticas.suma, estadisticas.muestras, *ctx.config, *ctx.img);
+  }
+
+  void muestrear_pixel(int fila, int col, EstadisticasPixel & estadisticas, int hasta,
+                       RenderContext & ctx) {
+    Config const & config     = *ctx.config;
+    std::uint64_t const pixel = indice_pixel(fila, col, *ctx.camara);
+    while (estadisticas.necesita_muestras(hasta, config)) {
+      auto const muestra = static_cast<std::uint32_t>(estadisticas.muestras);
+      double u_offset    = 0.0;
+      double v_offset    = 0.0;
+      desplazamiento_muestra(pixel, muestra, config, u_offset, v_offset);
 
       ray const rayo = ctx.camara->generar_ray(fila, col, u_offset, v_offset);
+      ctx.empezar_muestra(pixel, muestra);
       // pasamos el contexto render al calcular_color
-      acumulado = render::vector::add(acumulado, soa_calcular_color(rayo, config.max_depth, ctx));
+      estadisticas.anadir(soa_calcular_color(rayo, config.max_depth, ctx));
+      ctx.muestras++;
     }
-    // promedio
-    acumulado = render::vector::divd(acumulado, static_cast<double>(config.samples_per_pixel));
-    // corrección gamma
-    acumulado = render::vector{std::pow(acumulado.x, 1.0 / config.gamma),
-                               std::pow(acumulado.y, 1.0 / config.gamma),
-                               std::pow(acumulado.z, 1.0 / config.gamma)};
+  }
 
-    int const r = static_cast<int>(255.99 * std::clamp(acumulado.x, 0.0, 1.0));
-    int const g = static_cast<int>(255.99 * std::clamp(acumulado.y, 0.0, 1.0));
-    int const b = static_cast<int>(255.99 * std::clamp(acumulado.z, 0.0, 1.0));
+  // Igual que calcular_pixel_soa para los píxeles de un paquete de config.packet_size de lado
+  // (recortado en los bordes de la imagen), pero trazando juntos los rayos primarios de cada
+  // muestra. Como los números aleatorios dependen sólo del píxel y la muestra, el resultado es
+  // el mismo que píxel a píxel; los rebotes se siguen trazando rayo a rayo. Con muestreo
+  // adaptativo el paquete sólo traza los píxeles que no han convergido. Los arrays del paquete
+  // son de tamaño fijo, así que no se reserva memoria por paquete ni por muestra.
+  void calcular_paquete_soa(int fila0, int col0, RenderContext & ctx) {
+    Config const & config = *ctx.config;
+    int const filas       = std::min(config.packet_size, ctx.camara->alto_imagen - fila0);
+    int const cols        = std::min(config.packet_size, ctx.camara->ancho_imagen - col0);
+    auto const n          = static_cast<std::size_t>(filas * cols);
+    std::array<EstadisticasPixel, max_packet_rays> estadisticas{};
+    muestrear_paquete(fila0, col0, estadisticas, static_cast<std::size_t>(cols),
+                      config.samples_per_pixel, ctx);
+    for (std::size_t p = 0; p < n; ++p) {
+      escribir_pixel(fila0 + static_cast<int>(p) / cols, col0 + static_cast<int>(p) % cols,
+                     estadisticas[p].suma, estadisticas[p].muestras, config, *ctx.img);
+    }
+  }
 
-    ctx.img->set_pixel(col, fila, Pixel{r, g, b});
+  // Cada vuelta traza una muestra de cada píxel activo, la siguiente que le falte, así que tras
+  // reanudar un render los píxeles pueden ir por muestras distintas
+  void muestrear_paquete(int fila0, int col0, std::span<EstadisticasPixel> estadisticas,
+                         std::size_t paso, int hasta, RenderContext & ctx) {
+    Config const & config = *ctx.config;
+    int const filas       = std::min(config.packet_size, ctx.camara->alto_imagen - fila0);
+    int const cols        = std::min(config.packet_size, ctx.camara->ancho_imagen - col0);
+    auto const n          = static_cast<std::size_t>(filas * cols);
+    auto const ncols      = static_cast<std::size_t>(cols);
+    auto estadisticas_de  = [&](std::size_t p) -> EstadisticasPixel & {
+      return estadisticas[(p / ncols) * paso + p % ncols];
+    };
+    std::array<std::uint64_t, max_packet_rays> pixeles{};
+    // píxeles del paquete que siguen muestreándose; el rayo k es del píxel activos[k]
+    std::array<std::size_t, max_packet_rays> activos{};
+    std::array<ray, max_packet_rays> rayos{};
+    std::array<std::optional<Intersection>, max_packet_rays> impactos{};
+    std::size_t num_activos = 0;
+    for (std::size_t p = 0; p < n; ++p) {
+      pixeles[p] = indice_pixel(fila0 + static_cast<int>(p) / cols,
+                                col0 + static_cast<int>(p) % cols, *ctx.camara);
+      if (estadisticas_de(p).necesita_muestras(hasta, config)) {
+        activos[num_activos++] = p;
+      }
+    }
+    while (num_activos > 0) {
+      for (std::size_t k = 0; k < num_activos; ++k) {
+        std::size_t const p = activos[k];
+        auto const muestra  = static_cast<std::uint32_t>(estadisticas_de(p).muestras);
+        double u            = 0.0;
+        double v            = 0.0;
+        desplazamiento_muestra(pixeles[p], muestra, config, u, v);
+        rayos[k] = ctx.camara->generar_ray(fila0 + static_cast<int>(p) / cols,
+                                           col0 + static_cast<int>(p) % cols, u, v);
+      }
+      ctx.escena->intersect_packet(std::span<ray const>{rayos.data(), num_activos},
+                                   std::span<std::optional<Intersection>>{impactos.data(),
+                                                                          num_activos});
+      // quita los píxeles que ya tienen sus muestras o han convergido
+      std::size_t quedan = 0;
+      for (std::size_t k = 0; k < num_activos; ++k) {
+        std::size_t const p     = activos[k];
+        EstadisticasPixel & est = estadisticas_de(p);
+        ctx.empezar_muestra(pixeles[p], static_cast<std::uint32_t>(est.muestras));
+        est.anadir(soa_color_impacto(rayos[k], impactos[k], config.max_depth, ctx));
+        ctx.muestras++;
+        if (est.necesita_muestras(hasta, config)) {
+          activos[quedan++] = p;
+        }
+      }
+      num_activos = quedan;
+    }
   }
 
-  // Función principal de renderizado en paralelo usando TBB y SOA
-  ImageSOA render_image_soa(Scene const & escena, Config const & config, Camera & camara,
-                            ImageSOA & img) {
-    constexpr int max_threads = 64;
-    constexpr int grain_size  = 1;
-    // 1. Configurar el número máximo de hilos
-    oneapi::tbb::global_control const control(oneapi::tbb::global_control::max_allowed_parallelism,
-                                              static_cast<std::size_t>(max_threads));
-    // generacion de semillas
-    auto [seeds_ray, seeds_material] = generar_semillas_soa(max_threads, config);
-    // 3. Configurar TLS
-    oneapi::tbb::enumerable_thread_specific<ThreadLocalRNG> tls_rngs([&]() {
-      static std::atomic<std::size_t> counter{0};
-      std::size_t const thread_id = counter++;
-      std::size_t const index     = thread_id % seeds_ray.size();
-      return ThreadLocalRNG{std::mt19937_64(seeds_ray[index]),
-                            std::mt19937_64(seeds_material[index])};
-    });
-    oneapi::tbb::blocked_range2d<int> const rango =
-        (grain_size > 0)
-            ? oneapi::tbb::blocked_range2d<int>(
-                  0, camara.alto_imagen, static_cast<std::size_t>(grain_size), 0,
-                  camara.ancho_imagen, static_cast<std::size_t>(grain_size))
-            : oneapi::tbb::blocked_range2d<int>(0, camara.alto_imagen, 0, camara.ancho_imagen);
-    // lambda que ejecutará cada hilo
-    auto loop_body = [&](oneapi::tbb::blocked_range2d<int> const & r) {
-      ThreadLocalRNG & local_rngs = tls_rngs.local();
-      RenderContext ctx{escena, config, camara, img, local_rngs.ray_rng, local_rngs.material_rng};
-      for (int fila = r.rows().begin(); fila != r.rows().end(); ++fila) {
-        for (int col = r.cols().begin(); col != r.cols().end(); ++col) {
-          // pixel_id unico por pixel
-          calcular_pixel_soa(fila, col, ctx);
+  namespace {
+
+    // Suma a `stats` el trabajo calculado con un contexto
+    void sumar_estadisticas(RenderContext const & ctx, RenderStats * stats) {
+      if (stats != nullptr) {
+        stats->muestras += ctx.muestras;
+        stats->rebotes  += ctx.rebotes;
+      }
+    }
+
+  }  // namespace
+
+  void calcular_tesela(Tile const & t, TileBuffer & buffer, RenderContext & ctx) {
+    Config const & config = *ctx.config;
+    buffer.reset(t.filas, t.cols);
+    if (config.packet_size == 1) {
+      for (int f = 0; f < t.filas; ++f) {
+        for (int c = 0; c < t.cols; ++c) {
+          EstadisticasPixel estadisticas;
+          muestrear_pixel(t.fila0 + f, t.col0 + c, estadisticas, config.samples_per_pixel, ctx);
+          buffer.set(f, c, estadisticas.suma, estadisticas.muestras);
         }
       }
-    };
-    // ejecucion con el particionador optimo
-    oneapi::tbb::parallel_for(rango, loop_body, oneapi::tbb::simple_partitioner());
+      return;
+    }
+    int const lado = config.packet_size;
+    for (int f0 = 0; f0 < t.filas; f0 += lado) {
+      for (int c0 = 0; c0 < t.cols; c0 += lado) {
+        int const filas = std::min(lado, t.filas - f0);
+        int const cols  = std::min(lado, t.cols - c0);
+        std::array<EstadisticasPixel, max_packet_rays> estadisticas{};
+        muestrear_paquete(t.fila0 + f0, t.col0 + c0, estadisticas,
+                          static_cast<std::size_t>(cols), config.samples_per_pixel, ctx);
+        for (int f = 0; f < filas; ++f) {
+          for (int c = 0; c < cols; ++c) {
+            EstadisticasPixel const & e =
+                estadisticas[static_cast<std::size_t>(f) * static_cast<std::size_t>(cols) +
+                             static_cast<std::size_t>(c)];
+            buffer.set(f0 + f, c0 + c, e.suma, e.muestras);
+          }
+        }
+      }
+    }
+  }
+
+  // Función principal de renderizado en paralelo usando TBB y SOA
+  ImageSOA render_image_soa(Scene const & escena, Config const & config, Camera & camara,
+                            ImageSOA & img, RenderStats * stats, TileAffinity * afinidad) {
+    if (img.width() < camara.ancho_imagen or img.height() < camara.alto_imagen) {
+      throw std::out_of_range("image smaller than the camera");
+    }
+    AccumImageSOA acum(camara.ancho_imagen, camara.alto_imagen);
+    render_image_accum(escena, config, camara, acum, stats, afinidad);
+    quantize(acum, config, img);
     return img;
   }
 
-  // Función recursiva para calcular el color de un rayo usando SOA
+  // La imagen se reparte en teselas de lado_tesela(config) en orden de Morton; cada tarea calcula
+  // sus teselas en el TileBuffer de su hilo y las copia enteras en la imagen. Los hilos y el
+  // particionador salen del config; con config.numa se reparte por nodos NUMA
+  // (render_image_numa).
+  void render_image_accum(Scene const & escena, Config const & config, Camera & camara,
+                          AccumImageSOA & acum, RenderStats * stats, TileAffinity * afinidad) {
+    if (acum.width() != camara.ancho_imagen or acum.height() != camara.alto_imagen) {
+      throw std::invalid_argument("la imagen de acumulación no es del tamaño de la cámara");
+    }
+    // escena con objetos añadidos sin build_bvh: se renderiza una copia reconstruida
+    if (not escena.up_to_date()) {
+      render_image_accum(escena.rebuilt(), config, camara, acum, stats, afinidad);
+      return;
+    }
+    if (config.numa) {
+      render_image_numa(escena, config, camara, acum, stats, afinidad);
+      return;
+    }
+    // la imagen de cada contexto no se usa: los píxeles van a las teselas
+    ImageSOA sin_uso(1, 1);
+    std::vector<Tile> const teselas =
+        morton_tiles(camara.ancho_imagen, camara.alto_imagen, lado_tesela(config));
+    oneapi::tbb::enumerable_thread_specific<TileBuffer> buffers;
+    parallel_for_tiles(teselas.size(), config,
+                       [&](oneapi::tbb::blocked_range<std::size_t> const & r) {
+                         RenderContext ctx{escena, config, camara, sin_uso};
+                         TileBuffer & buffer = buffers.local();
+                         for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                           calcular_tesela(teselas[i], buffer, ctx);
+                           buffer.write(teselas[i], acum);
+                         }
+                         sumar_estadisticas(ctx, stats);
+                       },
+                       afinidad);
+  }
+
+  // Color de un rayo usando SOA
   vector soa_calcular_color(ray const & r, int profundidad, RenderContext & render) {
     if (profundidad <= 0) {
       return vector{0.0, 0.0, 0.0};
     }
-    std::optional<Intersection> inter_mas_cercana;
     // Cambio: ya existe una función Scene::intersect que hace esto
-    inter_mas_cercana = render.escena->intersect(r);
-    if (!inter_mas_cercana.has_value()) {
-      return soa_calcular_fondo(r, *render.config);
+    return soa_color_impacto(r, render.escena->intersect(r), profundidad, render);
+  }
+
+  // Color de un rayo cuyo impacto más cercano ya se conoce. El camino se sigue con un bucle que
+  // acumula la reflectancia de los rebotes (throughput) en lugar de recursividad; el último
+  // rebote permitido por la profundidad no se dispersa porque aportaría negro igualmente.
+  vector soa_color_impacto(ray const & r, std::optional<Intersection> const & inter_mas_cercana,
+                           int profundidad, RenderContext & render) {
+    vector throughput{1.0, 1.0, 1.0};
+    ray rayo                            = r;
+    std::optional<Intersection> impacto = inter_mas_cercana;
+    for (int rebote = 1;; ++rebote) {
+      if (!impacto.has_value()) {
+        return vector::mul(throughput, soa_calcular_fondo(rayo, *render.config));
+      }
+      Material const * mat = render.escena->materialById(impacto->material);
+      if (mat == nullptr or rebote >= profundidad) {
+        return vector{0.0, 0.0, 0.0};
+      }
+      render.material_rng.seek(static_cast<std::uint32_t>(rebote) * dimensiones_por_rebote);
+      // Obtener dirección reflejada y reflectancia según el tipo de material
+      auto [scattered_dir, reflectance] =
+          mat->scatter(rayo.direction, impacto->vector_normal, render.material_rng);
+      render.rebotes++;
+      // Atenuar lo que llegue por el nuevo rayo con la reflectancia del material
+      throughput = vector::mul(throughput, reflectance);
+      if (not sobrevive_ruleta_rusa(throughput, rebote, *render.config, render.material_rng)) {
+        return vector{0.0, 0.0, 0.0};
+      }
+      // Crear nuevo rayo desde el punto de intersección
+      rayo    = ray(impacto->punto_interseccion, scattered_dir);
+      impacto = render.escena->intersect(rayo);
     }
-    Material const * mat = render.escena->materialByName(inter_mas_cercana->nombre_material);
-    if (mat == nullptr) {
-      return vector{0.0, 0.0, 0.0};
+  }
+
+  bool sobrevive_ruleta_rusa(vector & throughput, int rebotes, Config const & config,
+                             Sampler & rng) {
+    if (config.russian_roulette_depth <= 0 or rebotes < config.russian_roulette_depth) {
+      return true;
+    }
+    // probabilidad de seguir proporcional a la mayor componente de la reflectancia acumulada
+    double const p = std::min(1.0, std::max({throughput.x, throughput.y, throughput.z}));
+    if (unit_double(rng()) >= p) {
+      return false;
     }
-    // Generador aleatorio local
-    // Obtener dirección reflejada y reflectancia según el tipo de material
-    auto [scattered_dir, reflectance] =
-        mat->scatter(r.direction, inter_mas_cercana->vector_normal, *render.material_rng);
-    // Crear nuevo rayo desde el punto de intersección
-    ray const scattered_ray(inter_mas_cercana->punto_interseccion, scattered_dir);
-    // Recursividad: calcular color reflejado
-    vector const color_rebote = soa_calcular_color(scattered_ray, profundidad - 1, render);
-    // Atenuar el color reflejado con la reflectancia del material
-    return vector::mul(reflectance, color_rebote);
+    throughput = vector::divd(throughput, p);
+    return true;
   }
 
   // Función para calcular el color de fondo basado en la dirección del rayo
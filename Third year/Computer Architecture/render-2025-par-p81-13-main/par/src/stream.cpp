@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <image_par.hpp>
+#include <ios>
+#include <postprocess.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <span>
+#include <stdexcept>
+#include <stream.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// includes de TBB
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+
+namespace render {
+
+  P6StreamWriter::P6StreamWriter(std::string const & path, int ancho, int alto,
+                                 std::size_t capacidad)
+      : out_(path, std::ios::binary | std::ios::trunc), path_(path), ancho_(ancho), alto_(alto) {
+    if (ancho <= 0 or alto <= 0 or capacidad == 0) {
+      throw std::invalid_argument("width, height and capacity must be positive");
+    }
+    if (not out_) {
+      throw std::runtime_error("no se pudo abrir la imagen de salida: " + path);
+    }
+    out_ << "P6\n" << ancho << ' ' << alto << "\n255\n";
+    cabecera_ = out_.tellp();
+    // reserva el tamaño final escribiendo el último byte
+    out_.seekp(cabecera_ + 3 * static_cast<std::streamoff>(ancho) * alto - 1);
+    out_.put('\0');
+    if (not out_) {
+      throw std::runtime_error("no se pudo reservar la imagen de salida: " + path);
+    }
+    cola_.set_capacity(static_cast<std::ptrdiff_t>(capacidad));
+    hilo_ = std::thread([this] { escribir(); });
+  }
+
+  P6StreamWriter::~P6StreamWriter() {
+    if (hilo_.joinable()) {
+      cola_.push(RowBand{});
+      hilo_.join();
+    }
+  }
+
+  void P6StreamWriter::push(RowBand franja) {
+    if (franja.filas <= 0 or franja.fila0 < 0 or franja.fila0 + franja.filas > alto_ or
+        franja.rgb.size() != 3 * static_cast<std::size_t>(ancho_) *
+                                 static_cast<std::size_t>(franja.filas))
+    {
+      throw std::invalid_argument("band outside the image");
+    }
+    cola_.push(std::move(franja));
+  }
+
+  void P6StreamWriter::finish() {
+    if (hilo_.joinable()) {
+      // una franja vacía termina el hilo
+      cola_.push(RowBand{});
+      hilo_.join();
+      out_.flush();
+    }
+    if (fallo_ or not out_) {
+      throw std::runtime_error("no se pudo escribir la imagen de salida: " + path_);
+    }
+  }
+
+  // Hilo escritor: tras un error sigue vaciando la cola para no bloquear a los productores
+  void P6StreamWriter::escribir() {
+    for (;;) {
+      RowBand franja;
+      cola_.pop(franja);
+      if (franja.filas == 0) {
+        return;
+      }
+      if (fallo_) {
+        continue;
+      }
+      out_.seekp(cabecera_ + 3 * static_cast<std::streamoff>(ancho_) * franja.fila0);
+      out_.write(reinterpret_cast<char const *>(franja.rgb.data()),
+                 static_cast<std::streamsize>(franja.rgb.size()));
+      if (not out_) {
+        fallo_ = true;
+      }
+    }
+  }
+
+  void render_image_stream(Scene const & escena, Config const & config, Camera & camara,
+                           P6StreamWriter & salida, RenderStats * stats) {
+    if (salida.width() != camara.ancho_imagen or salida.height() != camara.alto_imagen) {
+      throw std::invalid_argument("la imagen de salida no es del tamaño de la cámara");
+    }
+    // escena con objetos añadidos sin build_bvh: se renderiza una copia reconstruida
+    if (not escena.up_to_date()) {
+      render_image_stream(escena.rebuilt(), config, camara, salida, stats);
+      return;
+    }
+    // la imagen de cada contexto no se usa: los píxeles van a las franjas
+    ImageSOA sin_uso(1, 1);
+    int const lado     = lado_tesela(config);
+    int const ancho    = camara.ancho_imagen;
+    auto const paso    = 3 * static_cast<std::size_t>(ancho);
+    auto const franjas = static_cast<std::size_t>((camara.alto_imagen + lado - 1) / lado);
+    PostProcess const post(config);
+    oneapi::tbb::enumerable_thread_specific<TileBuffer> buffers;
+    parallel_for_tiles(franjas, config, [&](oneapi::tbb::blocked_range<std::size_t> const & r) {
+      RenderContext ctx{escena, config, camara, sin_uso};
+      TileBuffer & buffer = buffers.local();
+      // canales de la tesela tras el postproceso
+      auto const max_tesela = static_cast<std::size_t>(lado) * static_cast<std::size_t>(lado);
+      std::vector<float> tmp(max_tesela);
+      std::vector<std::uint8_t> r8(max_tesela);
+      std::vector<std::uint8_t> g8(max_tesela);
+      std::vector<std::uint8_t> b8(max_tesela);
+      for (std::size_t i = r.begin(); i != r.end(); ++i) {
+        RowBand franja;
+        franja.fila0 = static_cast<int>(i) * lado;
+        franja.filas = std::min(lado, camara.alto_imagen - franja.fila0);
+        franja.rgb.resize(paso * static_cast<std::size_t>(franja.filas));
+        for (int col0 = 0; col0 < ancho; col0 += lado) {
+          Tile const t{franja.fila0, col0, franja.filas, std::min(lado, ancho - col0)};
+          calcular_tesela(t, buffer, ctx);
+          std::size_t const n = buffer.r.size();
+          std::span<float> const color{tmp.data(), n};
+          post.apply(buffer.r, buffer.muestras, color, std::span{r8.data(), n});
+          post.apply(buffer.g, buffer.muestras, color, std::span{g8.data(), n});
+          post.apply(buffer.b, buffer.muestras, color, std::span{b8.data(), n});
+          for (int f = 0; f < t.filas; ++f) {
+            for (int c = 0; c < t.cols; ++c) {
+              std::size_t const j =
+                  static_cast<std::size_t>(f) * static_cast<std::size_t>(t.cols) +
+                  static_cast<std::size_t>(c);
+              std::size_t const k = static_cast<std::size_t>(f) * paso +
+                                    3 * static_cast<std::size_t>(col0 + c);
+              franja.rgb[k]       = r8[j];
+              franja.rgb[k + 1]   = g8[j];
+              franja.rgb[k + 2]   = b8[j];
+            }
+          }
+        }
+        salida.push(std::move(franja));
+      }
+      if (stats != nullptr) {
+        stats->muestras += ctx.muestras;
+        stats->rebotes  += ctx.rebotes;
+      }
+    });
+  }
+
+}  // namespace render
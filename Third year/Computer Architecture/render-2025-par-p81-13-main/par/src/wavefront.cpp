@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <atomic>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <image_par.hpp>
+#include <intersection.hpp>
+#include <limits>
+#include <material.hpp>
+#include <optional>
+#include <ray.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector.hpp>
+#include <vector>
+#include <wavefront.hpp>
+
+// includes de TBB
+#include <oneapi/tbb/parallel_for.h>
+
+namespace render {
+
+  namespace {
+
+    // Caminos de cada tarea de los parallel_for; también es la unidad de la compactación
+    constexpr std::size_t chunk_size = 4'096;
+    // Caminos por lote, para acotar la memoria de las colas
+    constexpr std::size_t max_batch_paths = std::size_t{1} << 20;
+    constexpr std::uint32_t no_material   = std::numeric_limits<std::uint32_t>::max();
+
+    // Resultado de la etapa de extensión para cada rayo de la cola
+    struct HitQueue {
+      std::vector<std::uint8_t> hit;
+      std::vector<double> px, py, pz;
+      std::vector<double> nx, ny, nz;
+      // índice en Scene::material_table, o no_material si el material no existe
+      std::vector<std::uint32_t> mat;
+
+      void resize(std::size_t n) {
+        hit.resize(n);
+        for (auto * v : {&px, &py, &pz, &nx, &ny, &nz}) {
+          v->resize(n);
+        }
+        mat.resize(n);
+      }
+    };
+
+    // Color final de cada camino del lote
+    struct PathColors {
+      std::vector<double> r, g, b;
+
+      void reset(std::size_t n) {
+        for (auto * v : {&r, &g, &b}) {
+          v->assign(n, 0.0);
+        }
+      }
+    };
+
+    // Llama a f(inicio, fin, bloque) en paralelo para cada bloque de chunk_size elementos de
+    // [0, n)
+    template <typename F>
+    void for_each_chunk(std::size_t n, F && f) {
+      std::size_t const chunks = (n + chunk_size - 1) / chunk_size;
+      oneapi::tbb::parallel_for(std::size_t{0}, chunks, [&](std::size_t c) {
+        f(c * chunk_size, std::min(n, (c + 1) * chunk_size), c);
+      });
+    }
+
+    ray ray_at(PathQueue const & q, std::size_t i) {
+      ray r;
+      r.origin    = vector{q.ox[i], q.oy[i], q.oz[i]};
+      r.direction = vector{q.dx[i], q.dy[i], q.dz[i]};
+      return r;
+    }
+
+    void set_ray(PathQueue & q, std::size_t i, ray const & r) {
+      q.ox[i] = r.origin.x;
+      q.oy[i] = r.origin.y;
+      q.oz[i] = r.origin.z;
+      q.dx[i] = r.direction.x;
+      q.dy[i] = r.direction.y;
+      q.dz[i] = r.direction.z;
+    }
+
+    void set_throughput(PathQueue & q, std::size_t i, vector const & t) {
+      q.tr[i] = t.x;
+      q.tg[i] = t.y;
+      q.tb[i] = t.z;
+    }
+
+    vector throughput_at(PathQueue const & q, std::size_t i) {
+      return vector{q.tr[i], q.tg[i], q.tb[i]};
+    }
+
+    void copy_path(PathQueue const & from, std::size_t i, PathQueue & to, std::size_t j) {
+      to.ox[j]   = from.ox[i];
+      to.oy[j]   = from.oy[i];
+      to.oz[j]   = from.oz[i];
+      to.dx[j]   = from.dx[i];
+      to.dy[j]   = from.dy[i];
+      to.dz[j]   = from.dz[i];
+      to.tr[j]   = from.tr[i];
+      to.tg[j]   = from.tg[i];
+      to.tb[j]   = from.tb[i];
+      to.path[j] = from.path[i];
+    }
+
+    // Estado del render compartido por las etapas
+    struct Wavefront {
+      Scene const & escena;
+      Config const & config;
+      Camera & camara;
+      PathQueue cur, next;
+      HitQueue hits;
+      PathColors colors;
+      std::vector<std::uint8_t> alive;
+      std::vector<std::size_t> counts;
+      RenderStats * stats;
+      Shading sombreado;
+      // Píxeles del lote [pix0, pix1), sus muestras y los que aún no han convergido
+      std::size_t pix0 = 0;
+      std::size_t pix1 = 0;
+      std::vector<EstadisticasPixel> estadisticas{};
+      std::vector<std::size_t> activos{};
+      // En la pasada en curso el camino p es la muestra first_sample + p % pass_samples del píxel
+      // activos[p / pass_samples]
+      std::size_t first_sample = 0;
+      std::size_t pass_samples = 0;
+
+      [[nodiscard]] std::size_t pixel_of(std::uint32_t path) const {
+        return activos[path / pass_samples];
+      }
+
+      [[nodiscard]] std::uint32_t sample_of(std::uint32_t path) const {
+        return static_cast<std::uint32_t>(first_sample + path % pass_samples);
+      }
+
+      // Empieza el lote de píxeles [p0, p1): todos activos y sin muestras
+      void start_batch(std::size_t p0, std::size_t p1) {
+        pix0 = p0;
+        pix1 = p1;
+        estadisticas.assign(p1 - p0, EstadisticasPixel{});
+        activos.resize(p1 - p0);
+        for (std::size_t i = 0; i < activos.size(); ++i) {
+          activos[i] = p0 + i;
+        }
+      }
+
+      // Generación: un rayo de cámara para cada una de las muestras [first, first + count) de
+      // cada píxel activo
+      void generate(std::size_t first, std::size_t count) {
+        std::size_t cols = static_cast<std::size_t>(camara.ancho_imagen);
+        first_sample     = first;
+        pass_samples     = count;
+        cur.resize(activos.size() * count);
+        colors.reset(cur.size());
+        if (stats != nullptr) {
+          stats->muestras += cur.size();
+        }
+        for_each_chunk(cur.size(), [&](std::size_t b, std::size_t e, std::size_t) {
+          for (std::size_t i = b; i < e; ++i) {
+            auto const path       = static_cast<std::uint32_t>(i);
+            std::size_t const pix = pixel_of(path);
+            double u              = 0.0;
+            double v              = 0.0;
+            desplazamiento_muestra(pix, sample_of(path), config, u, v);
+            set_ray(cur, i,
+                    camara.generar_ray(static_cast<int>(pix / cols), static_cast<int>(pix % cols),
+                                       u, v));
+            set_throughput(cur, i, vector{1.0, 1.0, 1.0});
+            cur.path[i] = static_cast<std::uint32_t>(i);
+          }
+        });
+      }
+
+      // Extensión: impacto más cercano de cada rayo de la cola
+      void extend() {
+        hits.resize(cur.size());
+        for_each_chunk(cur.size(), [&](std::size_t b, std::size_t e, std::size_t) {
+          for (std::size_t i = b; i < e; ++i) {
+            std::optional<Intersection> const h = escena.intersect(ray_at(cur, i));
+            hits.hit[i]                         = h.has_value() ? 1 : 0;
+            if (h) {
+              hits.px[i]  = h->punto_interseccion.x;
+              hits.py[i]  = h->punto_interseccion.y;
+              hits.pz[i]  = h->punto_interseccion.z;
+              hits.nx[i]  = h->vector_normal.x;
+              hits.ny[i]  = h->vector_normal.y;
+              hits.nz[i]  = h->vector_normal.z;
+              hits.mat[i] = h->material < escena.material_table.size() ? h->material : no_material;
+            }
+          }
+        });
+      }
+
+      // Fallo: los rayos que salen de la escena terminan su camino con el color del fondo
+      void miss() {
+        for_each_chunk(cur.size(), [&](std::size_t b, std::size_t e, std::size_t) {
+          for (std::size_t i = b; i < e; ++i) {
+            if (hits.hit[i] == 0) {
+              vector const c =
+                  vector::mul(throughput_at(cur, i), soa_calcular_fondo(ray_at(cur, i), config));
+              colors.r[cur.path[i]] = c.x;
+              colors.g[cur.path[i]] = c.y;
+              colors.b[cur.path[i]] = c.z;
+            }
+          }
+        });
+      }
+
+      // Sombreado: los caminos siguen en la siguiente cola; los impactos sin material aportan
+      // negro, como en soa_calcular_color. `rebote` es el número de rebotes de los caminos tras
+      // esta etapa, para la ruleta rusa.
+      void shade(int rebote) {
+        next.resize(cur.size());
+        alive.assign(cur.size(), 0);
+        if (sombreado == Shading::per_hit) {
+          shade_per_hit(rebote);
+        } else {
+          shade_binned(rebote);
+        }
+        compact();
+      }
+
+      // Mismo flujo de materiales que la muestra del camino i en soa_color_impacto
+      [[nodiscard]] Sampler material_rng(std::size_t i, int rebote) const {
+        return Sampler(config.sampler, config.material_rng_seed, pixel_of(cur.path[i]),
+                       sample_of(cur.path[i]),
+                       static_cast<std::uint32_t>(rebote) * dimensiones_por_rebote);
+      }
+
+      // El camino i sigue desde su impacto en la dirección dispersada salvo que lo corte la
+      // ruleta rusa
+      void continue_path(std::size_t i, vector const & direccion, vector const & atenuacion,
+                         int rebote, Sampler & rng) {
+        vector throughput = vector::mul(throughput_at(cur, i), atenuacion);
+        if (not sobrevive_ruleta_rusa(throughput, rebote, config, rng)) {
+          return;
+        }
+        set_ray(next, i, ray(vector{hits.px[i], hits.py[i], hits.pz[i]}, direccion));
+        set_throughput(next, i, throughput);
+        next.path[i] = cur.path[i];
+        alive[i]     = 1;
+      }
+
+      // Una llamada virtual a Material::scatter por impacto, con los materiales mezclados
+      void shade_per_hit(int rebote) {
+        for_each_chunk(cur.size(), [&](std::size_t b, std::size_t e, std::size_t) {
+          std::size_t sombreados = 0;
+          for (std::size_t i = b; i < e; ++i) {
+            if (hits.hit[i] == 0 or hits.mat[i] == no_material) {
+              continue;
+            }
+            Sampler rng                  = material_rng(i, rebote);
+            auto const [direccion, aten] = escena.material_table[hits.mat[i]]->scatter(
+                vector{cur.dx[i], cur.dy[i], cur.dz[i]},
+                vector{hits.nx[i], hits.ny[i], hits.nz[i]}, rng);
+            continue_path(i, direccion, aten, rebote, rng);
+            ++sombreados;
+          }
+          if (stats != nullptr) {
+            stats->rebotes += sombreados;
+          }
+        });
+      }
+
+      // En cada bloque de la cola los impactos se agrupan por material con una ordenación por
+      // recuento y cada grupo se dispersa con una sola llamada a Material::scatter_batch.
+      // Agrupar por bloques y no en toda la cola mantiene en caché las lecturas y escrituras
+      // indirectas.
+      void shade_binned(int rebote) {
+        std::size_t const num_mats = escena.material_table.size();
+        for_each_chunk(cur.size(), [&](std::size_t b, std::size_t e, std::size_t) {
+          std::vector<std::size_t> start(num_mats + 1, 0);
+          for (std::size_t i = b; i < e; ++i) {
+            if (hits.hit[i] != 0 and hits.mat[i] != no_material) {
+              start[hits.mat[i] + 1]++;
+            }
+          }
+          for (std::size_t m = 0; m < num_mats; ++m) {
+            start[m + 1] += start[m];
+          }
+          std::vector<std::uint32_t> order(start[num_mats]);
+          std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+          for (std::size_t i = b; i < e; ++i) {
+            if (hits.hit[i] != 0 and hits.mat[i] != no_material) {
+              order[pos[hits.mat[i]]++] = static_cast<std::uint32_t>(i);
+            }
+          }
+          ScatterBatch batch;
+          for (std::size_t m = 0; m < num_mats; ++m) {
+            if (start[m + 1] == start[m]) {
+              continue;
+            }
+            batch.resize(start[m + 1] - start[m]);
+            for (std::size_t j = 0; j < batch.size(); ++j) {
+              std::uint32_t const i = order[start[m] + j];
+              batch.in_x[j]         = cur.dx[i];
+              batch.in_y[j]         = cur.dy[i];
+              batch.in_z[j]         = cur.dz[i];
+              batch.n_x[j]          = hits.nx[i];
+              batch.n_y[j]          = hits.ny[i];
+              batch.n_z[j]          = hits.nz[i];
+              batch.rng[j]          = material_rng(i, rebote);
+            }
+            escena.material_table[m]->scatter_batch(batch);
+            for (std::size_t j = 0; j < batch.size(); ++j) {
+              continue_path(order[start[m] + j],
+                            vector{batch.out_x[j], batch.out_y[j], batch.out_z[j]},
+                            vector{batch.att_r[j], batch.att_g[j], batch.att_b[j]}, rebote,
+                            batch.rng[j]);
+            }
+          }
+          if (stats != nullptr) {
+            stats->rebotes += start[num_mats];
+          }
+        });
+      }
+
+      // Quita de la cola los caminos terminados: recuento por bloque, desplazamientos y copia en
+      // paralelo
+      void compact() {
+        std::size_t const n = cur.size();
+        counts.assign((n + chunk_size - 1) / chunk_size, 0);
+        for_each_chunk(n, [&](std::size_t b, std::size_t e, std::size_t c) {
+          counts[c] = static_cast<std::size_t>(
+              std::count(alive.begin() + static_cast<std::ptrdiff_t>(b),
+                         alive.begin() + static_cast<std::ptrdiff_t>(e), std::uint8_t{1}));
+        });
+        std::vector<std::size_t> offsets(counts.size());
+        std::size_t total = 0;
+        for (std::size_t c = 0; c < counts.size(); ++c) {
+          offsets[c]  = total;
+          total      += counts[c];
+        }
+        cur.resize(total);
+        for_each_chunk(n, [&](std::size_t b, std::size_t e, std::size_t c) {
+          std::size_t out = offsets[c];
+          for (std::size_t i = b; i < e; ++i) {
+            if (alive[i] != 0) {
+              copy_path(next, i, cur, out++);
+            }
+          }
+        });
+      }
+
+      // Añade las muestras de la pasada a cada píxel activo, en el orden de las muestras, y quita
+      // de los activos los que han convergido
+      void resolve() {
+        oneapi::tbb::parallel_for(std::size_t{0}, activos.size(), [&](std::size_t k) {
+          EstadisticasPixel & est = estadisticas[activos[k] - pix0];
+          for (std::size_t s = 0; s < pass_samples; ++s) {
+            std::size_t const p = k * pass_samples + s;
+            est.anadir(vector{colors.r[p], colors.g[p], colors.b[p]});
+          }
+        });
+        std::erase_if(activos,
+                      [&](std::size_t pix) { return estadisticas[pix - pix0].convergido(config); });
+      }
+
+      // Escribe en la imagen de acumulación los píxeles del lote
+      void write(AccumImageSOA & acum) {
+        std::size_t cols = static_cast<std::size_t>(camara.ancho_imagen);
+        oneapi::tbb::parallel_for(pix0, pix1, [&](std::size_t pix) {
+          EstadisticasPixel const & est = estadisticas[pix - pix0];
+          acum.set_pixel(static_cast<int>(pix % cols), static_cast<int>(pix / cols),
+                         static_cast<float>(est.suma.x), static_cast<float>(est.suma.y),
+                         static_cast<float>(est.suma.z), static_cast<std::uint32_t>(est.muestras));
+        });
+      }
+    };
+
+  }  // namespace
+
+  Engine parse_engine(std::string const & name) {
+    if (name == "recursive") {
+      return Engine::recursive;
+    }
+    if (name == "wavefront") {
+      return Engine::wavefront;
+    }
+    throw std::invalid_argument("unknown render engine: " + name);
+  }
+
+  void PathQueue::resize(std::size_t n) {
+    for (auto * v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb}) {
+      v->resize(n);
+    }
+    path.resize(n);
+  }
+
+  void render_image_wavefront(Scene const & escena, Config const & config, Camera & camara,
+                              AccumImageSOA & acum, RenderStats * stats, Shading sombreado) {
+    if (acum.width() != camara.ancho_imagen or acum.height() != camara.alto_imagen) {
+      throw std::invalid_argument("la imagen de acumulación no es del tamaño de la cámara");
+    }
+    // escena con objetos añadidos sin build_bvh: se renderiza una copia reconstruida
+    if (not escena.up_to_date()) {
+      render_image_wavefront(escena.rebuilt(), config, camara, acum, stats, sombreado);
+      return;
+    }
+    Wavefront wf{escena, config, camara, {}, {}, {}, {}, {}, {}, stats, sombreado};
+    auto const pixels = static_cast<std::size_t>(camara.ancho_imagen) *
+                        static_cast<std::size_t>(camara.alto_imagen);
+    auto const spp    = static_cast<std::size_t>(config.samples_per_pixel);
+    auto const pasada = static_cast<std::size_t>(muestras_por_pasada(config));
+    // píxeles por lote
+    std::size_t const batch = std::max<std::size_t>(1, max_batch_paths / pasada);
+    // las etapas son parallel_for unidimensionales por bloques propios; del config sólo se
+    // aplican los hilos
+    con_hilos(config, [&] {
+      for (std::size_t pix0 = 0; pix0 < pixels; pix0 += batch) {
+        wf.start_batch(pix0, std::min(pixels, pix0 + batch));
+        for (std::size_t first = 0; first < spp and not wf.activos.empty(); first += pasada) {
+          wf.generate(first, std::min(pasada, spp - first));
+          for (int profundidad = config.max_depth; profundidad > 0 and wf.cur.size() > 0;
+               --profundidad) {
+            wf.extend();
+            wf.miss();
+            // en el último rebote los caminos que siguen aportan negro
+            if (profundidad > 1) {
+              wf.shade(config.max_depth - profundidad + 1);
+            }
+          }
+          wf.resolve();
+        }
+        wf.write(acum);
+      }
+    });
+  }
+
+  ImageSOA render_image_wavefront(Scene const & escena, Config const & config, Camera & camara,
+                                  ImageSOA & img, RenderStats * stats, Shading sombreado) {
+    if (img.width() < camara.ancho_imagen or img.height() < camara.alto_imagen) {
+      throw std::out_of_range("image smaller than the camera");
+    }
+    AccumImageSOA acum(camara.ancho_imagen, camara.alto_imagen);
+    render_image_wavefront(escena, config, camara, acum, stats, sombreado);
+    quantize(acum, config, img);
+    return img;
+  }
+
+}  // namespace render
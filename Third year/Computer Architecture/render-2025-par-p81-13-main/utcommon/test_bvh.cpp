@@ -0,0 +1,180 @@
+#include <aabb.hpp>
+#include <bvh.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <material.hpp>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::expect_same_hit;
+  using test_helpers::fill_random_scene;
+
+  // Rayos aleatorios, incluidos algunos paralelos a los ejes
+  std::vector<render::ray> random_rays(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-25.0, 25.0);
+    std::uniform_real_distribution<double> dir(-1.0, 1.0);
+    std::vector<render::ray> rays;
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const o{pos(rng), pos(rng), pos(rng)};
+      render::vector d{dir(rng), dir(rng), dir(rng)};
+      if (i % 10 == 0) {
+        d = render::vector{0.0, 0.0, 1.0};
+      } else if (i % 10 == 1) {
+        d = render::vector{1.0, 0.0, 0.0};
+      }
+      rays.emplace_back(o, d);
+    }
+    return rays;
+  }
+
+  bool contains(render::AABB const & outer, render::AABB const & inner) {
+    return outer.min.x <= inner.min.x and outer.min.y <= inner.min.y and
+           outer.min.z <= inner.min.z and outer.max.x >= inner.max.x and
+           outer.max.y >= inner.max.y and outer.max.z >= inner.max.z;
+  }
+
+}  // namespace
+
+// BVH vacía: sin nodos y sin primitivas
+TEST(test_bvh, ConstruccionVacia) {
+  render::BVH bvh;
+  bvh.build({});
+  EXPECT_TRUE(bvh.empty());
+  EXPECT_EQ(bvh.size(), 0U);
+}
+
+// Cada primitiva aparece una sola vez y las cajas de los nodos contienen a sus hijos
+TEST(test_bvh, EstructuraValida) {
+  Scene scene;
+  fill_random_scene(scene, 300, 7);
+  scene.build_bvh();
+  auto const & nodes = scene.bvh.nodes();
+  auto const & idx   = scene.bvh.indices();
+  ASSERT_EQ(idx.size(), scene.objects.size());
+
+  std::vector<int> seen(scene.objects.size(), 0);
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    auto const & n = nodes[i];
+    if (n.is_leaf()) {
+      for (std::uint32_t k = n.first; k < n.first + n.count; ++k) {
+        seen[idx[k]]++;
+        EXPECT_TRUE(contains(n.bounds, scene.objects[idx[k]]->bounds()));
+      }
+    } else {
+      EXPECT_TRUE(contains(n.bounds, nodes[i + 1].bounds));
+      EXPECT_TRUE(contains(n.bounds, nodes[n.first].bounds));
+    }
+  }
+  for (int const s : seen) {
+    EXPECT_EQ(s, 1);
+  }
+}
+
+// La caja del cilindro contiene los bordes de ambas tapas
+TEST(test_bvh, CajaCilindroContieneTapas) {
+  render::vector const axis{1.0, 2.0, -0.5};
+  render::Cylinder const cyl(render::vector{1.0, -2.0, 3.0}, 0.75, axis, "m");
+  render::AABB const box = cyl.bounds();
+  render::vector const e = render::vector::normalize(axis);
+  // base ortonormal del plano de las tapas
+  render::vector const u = render::vector::normalize(render::vector::crossp(e, {0.0, 0.0, 1.0}));
+  render::vector const v = render::vector::crossp(e, u);
+  for (double const side : {-0.5, 0.5}) {
+    render::vector const cap =
+        render::vector::add(cyl.center, render::vector::muld(axis, side));
+    for (int k = 0; k < 64; ++k) {
+      double const a        = k * 2.0 * std::numbers::pi / 64.0;
+      render::vector const p = render::vector::add(
+          cap, render::vector::add(render::vector::muld(u, 0.75 * std::cos(a)),
+                                   render::vector::muld(v, 0.75 * std::sin(a))));
+      EXPECT_TRUE(contains(box, render::AABB{p, p}));
+    }
+  }
+}
+
+// La BVH devuelve exactamente el mismo impacto que el recorrido lineal
+TEST(test_bvh, MismoImpactoQueRecorridoLineal) {
+  Scene scene;
+  fill_random_scene(scene, 500, 42);
+  scene.build_bvh();
+  ASSERT_EQ(scene.bvh.size(), scene.objects.size());
+
+  int hits = 0;
+  for (auto const & r : random_rays(3'000, 99)) {
+    auto const fast = scene.intersect(r);
+    auto const ref  = scene.intersect_linear(r);
+    expect_same_hit(fast, ref);
+    if (ref) {
+      ++hits;
+    }
+  }
+  EXPECT_GT(hits, 100);
+}
+
+// Con objetos coincidentes, gana el de menor índice como en el recorrido lineal
+TEST(test_bvh, EmpateDevuelveMenorIndice) {
+  Scene scene;
+  scene.materials["a"] = std::make_unique<Matte>("a", render::vector{1.0, 0.0, 0.0});
+  scene.materials["b"] = std::make_unique<Matte>("b", render::vector{0.0, 1.0, 0.0});
+  for (int i = 0; i < 8; ++i) {
+    scene.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 1.0, i == 0 ? "a" : "b"));
+  }
+  scene.build_bvh();
+  render::ray const r(render::vector{0.0, 0.0, -5.0}, render::vector{0.0, 0.0, 1.0});
+  auto const hit = scene.intersect(r);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(scene.materialById(hit->material), scene.materialByName("a"));
+}
+
+// Si se añaden objetos tras construir la BVH, intersect sigue viendo todos los objetos
+TEST(test_bvh, BVHDesactualizadaUsaRecorridoLineal) {
+  Scene scene;
+  fill_random_scene(scene, 10, 3);
+  scene.build_bvh();
+  scene.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 100.0}, 1.0, "a"));
+  render::ray const r(render::vector{0.0, 0.0, 90.0}, render::vector{0.0, 0.0, 1.0});
+  auto const hit = scene.intersect(r);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_NEAR(hit->lambda, 9.0, 1e-9);
+}
+
+// La construcción paralela produce exactamente el mismo árbol que la construcción en serie
+TEST(test_bvh, ConstruccionParalelaIgualASerie) {
+  Scene scene;
+  fill_random_scene(scene, 60'000, 11);
+  std::vector<render::AABB> bounds;
+  for (auto const & obj : scene.objects) {
+    bounds.push_back(obj->bounds());
+  }
+  render::BVH serial;
+  render::BVH parallel;
+  serial.build(bounds, false);
+  parallel.build(bounds, true);
+
+  ASSERT_EQ(serial.nodes().size(), parallel.nodes().size());
+  EXPECT_EQ(serial.indices(), parallel.indices());
+  for (std::size_t i = 0; i < serial.nodes().size(); ++i) {
+    auto const & a = serial.nodes()[i];
+    auto const & b = parallel.nodes()[i];
+    ASSERT_EQ(a.first, b.first);
+    ASSERT_EQ(a.count, b.count);
+    EXPECT_EQ(a.bounds.min.x, b.bounds.min.x);
+    EXPECT_EQ(a.bounds.max.z, b.bounds.max.z);
+  }
+  EXPECT_EQ(serial.sah_cost(), parallel.sah_cost());
+}
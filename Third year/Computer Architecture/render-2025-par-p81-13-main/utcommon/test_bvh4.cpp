@@ -0,0 +1,140 @@
+#include <aabb.hpp>
+#include <accelerator.hpp>
+#include <array>
+#include <bvh.hpp>
+#include <bvh4.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <material.hpp>
+#include <memory>
+#include <random>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::expect_same_hit;
+  using test_helpers::fill_random_scene;
+
+}  // namespace
+
+// Los nodos están alineados a línea de caché
+TEST(test_bvh4, NodosAlineados) {
+  Scene scene;
+  fill_random_scene(scene, 200, 5);
+  scene.build_bvh();
+  ASSERT_FALSE(scene.bvh4.empty());
+  EXPECT_EQ(alignof(render::BVH4Node), 64U);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(scene.bvh4.nodes().data()) % 64, 0U);
+}
+
+// Todas las primitivas son alcanzables exactamente una vez desde la raíz
+TEST(test_bvh4, CadaPrimitivaUnaVez) {
+  Scene scene;
+  fill_random_scene(scene, 500, 8);
+  scene.build_bvh();
+  auto const & nodes = scene.bvh4.nodes();
+  std::vector<int> seen(scene.objects.size(), 0);
+  std::vector<std::uint32_t> pending{0};
+  while (not pending.empty()) {
+    auto const & n = nodes[pending.back()];
+    pending.pop_back();
+    ASSERT_GE(n.num_children, 2U);
+    ASSERT_LE(n.num_children, 4U);
+    for (std::size_t i = 0; i < n.num_children; ++i) {
+      if (n.count[i] == 0) {
+        pending.push_back(n.child[i]);
+      } else {
+        for (std::uint32_t p = n.child[i]; p < n.child[i] + n.count[i]; ++p) {
+          seen[scene.bvh4.indices()[p]]++;
+        }
+      }
+    }
+  }
+  for (int const s : seen) {
+    EXPECT_EQ(s, 1);
+  }
+}
+
+// El test de los cuatro hijos (SIMD o escalar) coincide con el test de slabs de AABB
+TEST(test_bvh4, TestHijosIgualQueEscalar) {
+  Scene scene;
+  fill_random_scene(scene, 300, 13);
+  scene.build_bvh();
+  std::mt19937_64 rng(17);
+  std::uniform_real_distribution<double> pos(-25.0, 25.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  for (int k = 0; k < 2'000; ++k) {
+    render::ray const r(render::vector{pos(rng), pos(rng), pos(rng)},
+                        render::vector{dir(rng), k % 7 == 0 ? 0.0 : dir(rng), dir(rng)});
+    render::RayBoxData const rd{
+      r.origin, {1.0 / r.direction.x, 1.0 / r.direction.y, 1.0 / r.direction.z}
+    };
+    for (auto const & n : scene.bvh4.nodes()) {
+      std::array<double, 4> t_entry{};
+      double const t_max  = 30.0;
+      unsigned const mask = render::BVH4::intersect_children(n, rd, t_max, t_entry);
+      for (std::size_t i = 0; i < 4; ++i) {
+        if (i >= n.num_children) {
+          EXPECT_EQ(mask & (1U << i), 0U);
+          continue;
+        }
+        render::AABB const box{
+          {n.min_x[i], n.min_y[i], n.min_z[i]},
+          {n.max_x[i], n.max_y[i], n.max_z[i]}
+        };
+        double const ref = box.entry(rd.origin, rd.inv_dir, 0.0, t_max);
+        bool const hit   = (mask & (1U << i)) != 0U;
+        ASSERT_EQ(hit, ref != std::numeric_limits<double>::infinity());
+        if (hit) {
+          EXPECT_EQ(t_entry[i], ref);
+        }
+      }
+    }
+  }
+}
+
+// La BVH ancha devuelve el mismo impacto que el recorrido lineal
+TEST(test_bvh4, MismoImpactoQueRecorridoLineal) {
+  Scene scene;
+  fill_random_scene(scene, 800, 21);
+  scene.build_bvh();
+  scene.accelerator = render::Accelerator::bvh4;
+  std::mt19937_64 rng(3);
+  std::uniform_real_distribution<double> pos(-25.0, 25.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  int hits = 0;
+  for (int k = 0; k < 3'000; ++k) {
+    render::ray const r(render::vector{pos(rng), pos(rng), pos(rng)},
+                        render::vector{dir(rng), dir(rng), dir(rng)});
+    render::TraversalStats stats;
+    auto const fast = scene.intersect(r, &stats);
+    auto const ref  = scene.intersect_linear(r);
+    expect_same_hit(fast, ref);
+    if (ref) {
+      ++hits;
+    }
+    EXPECT_LE(stats.primitives, scene.objects.size());
+  }
+  EXPECT_GT(hits, 100);
+}
+
+// Escena de un único objeto: la BVH es una sola hoja
+TEST(test_bvh4, UnSoloObjeto) {
+  Scene scene;
+  scene.materials["m"] = std::make_unique<Matte>("m", render::vector{0.5, 0.5, 0.5});
+  scene.objects.push_back(std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 1.0, "m"));
+  scene.build_bvh();
+  scene.accelerator = render::Accelerator::bvh4;
+  render::ray const r(render::vector{0.0, 0.0, -5.0}, render::vector{0.0, 0.0, 1.0});
+  auto const hit = scene.intersect(r);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_NEAR(hit->lambda, 4.0, 1e-12);
+}
@@ -0,0 +1,85 @@
+#include <accelerator.hpp>
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <material.hpp>
+#include <memory>
+#include <random>
+#include <ray.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::expect_same_hit;
+  using test_helpers::fill_random_scene;
+
+}  // namespace
+
+// Cada tipo de primitiva va a sus propios arrays y conserva el índice del objeto
+TEST(test_compiled_scene, SeparaPorTipo) {
+  Scene scene;
+  fill_random_scene(scene, 10, 1, 10.0);
+  scene.build_bvh();
+  auto const & cs = scene.compiled;
+  ASSERT_EQ(cs.size(), 10U);
+  ASSERT_EQ(cs.spheres().size(), 5U);
+  ASSERT_EQ(cs.cylinders().size(), 5U);
+  for (std::size_t s = 0; s < cs.spheres().size(); ++s) {
+    std::uint32_t const obj = cs.spheres().obj_id[s];
+    EXPECT_EQ(obj % 2, 1U);
+    EXPECT_EQ(cs.spheres().cx[s], scene.objects[obj]->center.x);
+    EXPECT_EQ(cs.spheres().r2[s], scene.objects[obj]->radius * scene.objects[obj]->radius);
+  }
+  for (std::size_t s = 0; s < cs.cylinders().size(); ++s) {
+    std::uint32_t const obj = cs.cylinders().obj_id[s];
+    EXPECT_EQ(obj % 2, 0U);
+    EXPECT_EQ(cs.cylinders().mat_id[s], scene.objects[obj]->material_id);
+  }
+  for (std::size_t s = 0; s < cs.spheres().size(); ++s) {
+    EXPECT_EQ(cs.spheres().mat_id[s], scene.objects[cs.spheres().obj_id[s]]->material_id);
+  }
+}
+
+// Los bucles por tipo dan los mismos impactos que las llamadas virtuales a collision, con
+// todas las estructuras de aceleración
+TEST(test_compiled_scene, MismoImpactoQueObjetos) {
+  Scene scene;
+  fill_random_scene(scene, 400, 77, 10.0);
+  scene.build_bvh();
+  std::mt19937_64 rng(5);
+  std::uniform_real_distribution<double> pos(-15.0, 15.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  for (int k = 0; k < 2'000; ++k) {
+    render::ray const r(render::vector{pos(rng), pos(rng), pos(rng)},
+                        render::vector{dir(rng), dir(rng), dir(rng)});
+    auto const ref = scene.intersect_linear(r);
+    for (auto const accel :
+         {render::Accelerator::linear, render::Accelerator::bvh2, render::Accelerator::bvh4}) {
+      scene.accelerator = accel;
+      expect_same_hit(scene.intersect(r), ref);
+    }
+  }
+}
+
+// Rayos a lo largo del eje del cilindro: el impacto es en las tapas y la normal se reconstruye
+TEST(test_compiled_scene, ImpactoEnTapas) {
+  Scene scene;
+  scene.materials["m"] = std::make_unique<Matte>("m", render::vector{0.5, 0.5, 0.5});
+  scene.objects.push_back(std::make_unique<render::Cylinder>(
+      render::vector{0.0, 0.0, 0.0}, 1.0, render::vector{0.0, 0.0, 2.0}, "m"));
+  scene.build_bvh();
+  scene.accelerator = render::Accelerator::linear;
+  for (double const dz : {1.0, -1.0}) {
+    render::ray const r(render::vector{0.2, 0.1, -5.0 * dz}, render::vector{0.0, 0.0, dz});
+    auto const hit = scene.intersect(r);
+    expect_same_hit(hit, scene.intersect_linear(r));
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->lambda, 4.0);
+    EXPECT_DOUBLE_EQ(hit->vector_normal.z, -dz);
+  }
+}
@@ -794,3 +794,245 @@ TEST(test_config, invalid_material_rng_seed_type) {
               "Error: Invalid value for key");
   std::filesystem::remove(path);
 }
+
+// Prueba de carga de accelerator
+TEST(test_config, load_accelerator) {
+  std::string const path = "/tmp/test_config_accelerator.txt";
+  std::ofstream ofs(path);
+  ofs << "accelerator: bvh2\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.accelerator, render::Accelerator::bvh4);
+  cfg.load_config(path);
+  EXPECT_EQ(cfg.accelerator, render::Accelerator::bvh2);
+  EXPECT_EQ(cfg.seen_keys().at("accelerator:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// Pruebas de valores inválidos para diferentes claves
+TEST(test_config, invalid_accelerator) {
+  std::string const path = "/tmp/test_config_accelerator_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "accelerator: kdtree\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+}
+
+// Prueba de carga del tamaño de paquete
+TEST(test_config, load_packet_size) {
+  std::string const path = "/tmp/test_config_packet_size.txt";
+  std::ofstream ofs(path);
+  ofs << "packet_size: 4\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.packet_size, 1);
+  cfg.load_config(path);
+  EXPECT_EQ(cfg.packet_size, 4);
+  EXPECT_EQ(cfg.seen_keys().at("packet_size:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// Sólo se admiten paquetes de 1, 2, 4 u 8 píxeles de lado
+TEST(test_config, invalid_packet_size) {
+  std::string const path = "/tmp/test_config_packet_size_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "packet_size: 3\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+}
+
+// Prueba de carga de la profundidad de la ruleta rusa
+TEST(test_config, load_russian_roulette_depth) {
+  std::string const path = "/tmp/test_config_rr.txt";
+  std::ofstream ofs(path);
+  ofs << "russian_roulette_depth: 3\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.russian_roulette_depth, 0);
+  cfg.load_config(path);
+  EXPECT_EQ(cfg.russian_roulette_depth, 3);
+  EXPECT_EQ(cfg.seen_keys().at("russian_roulette_depth:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// La profundidad de la ruleta rusa no puede ser negativa
+TEST(test_config, invalid_russian_roulette_depth) {
+  std::string const path = "/tmp/test_config_rr_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "russian_roulette_depth: -1\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+}
+
+// Prueba de carga de sampler
+TEST(test_config, load_sampler) {
+  std::string const path = "/tmp/test_config_sampler.txt";
+  std::ofstream ofs(path);
+  ofs << "sampler: sobol\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.sampler, render::SamplerKind::random);
+  cfg.load_config(path);
+  EXPECT_EQ(cfg.sampler, render::SamplerKind::sobol);
+  EXPECT_EQ(cfg.seen_keys().at("sampler:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// Sólo se admiten los muestreadores conocidos
+TEST(test_config, invalid_sampler) {
+  std::string const path = "/tmp/test_config_sampler_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "sampler: halton\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+}
+
+// Prueba de carga de los parámetros del muestreo adaptativo
+TEST(test_config, load_adaptive_sampling) {
+  std::string const path = "/tmp/test_config_adaptive.txt";
+  std::ofstream ofs(path);
+  ofs << "adaptive_threshold: 0.05\n";
+  ofs << "adaptive_min_samples: 16\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.adaptive_threshold, 0.0);
+  EXPECT_EQ(cfg.adaptive_min_samples, 8);
+  cfg.load_config(path);
+  EXPECT_DOUBLE_EQ(cfg.adaptive_threshold, 0.05);
+  EXPECT_EQ(cfg.adaptive_min_samples, 16);
+  EXPECT_EQ(cfg.seen_keys().at("adaptive_threshold:"), 1);
+  EXPECT_EQ(cfg.seen_keys().at("adaptive_min_samples:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// El umbral no puede ser negativo ni infinito o NaN
+TEST(test_config, invalid_adaptive_threshold) {
+  std::string const path = "/tmp/test_config_adaptive_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "adaptive_threshold: -0.1\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+  EXPECT_EXIT(cfg.set_option("adaptive_threshold", "nan"),
+              ::testing::ExitedWithCode(EXIT_FAILURE), "Error: Invalid value for key");
+  EXPECT_EXIT(cfg.set_option("adaptive_threshold", "inf"),
+              ::testing::ExitedWithCode(EXIT_FAILURE), "Error: Invalid value for key");
+}
+
+// La pasada mínima necesita al menos dos muestras para estimar la varianza
+TEST(test_config, invalid_adaptive_min_samples) {
+  std::string const path = "/tmp/test_config_adaptive_min_bad.txt";
+  std::ofstream ofs(path);
+  ofs << "adaptive_min_samples: 1\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EXIT(cfg.load_config(path), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  std::filesystem::remove(path);
+}
+
+// Prueba de carga del reparto del trabajo entre hilos
+TEST(test_config, load_scheduling) {
+  std::string const path = "/tmp/test_config_scheduling.txt";
+  std::ofstream ofs(path);
+  ofs << "threads: 6\n";
+  ofs << "tile_size: 16\n";
+  ofs << "partitioner: affinity\n";
+  ofs.close();
+
+  Config cfg;
+  EXPECT_EQ(cfg.threads, 0);
+  EXPECT_EQ(cfg.tile_size, 8);
+  EXPECT_EQ(cfg.partitioner, render::Partitioner::simple);
+  cfg.load_config(path);
+  EXPECT_EQ(cfg.threads, 6);
+  EXPECT_EQ(cfg.tile_size, 16);
+  EXPECT_EQ(cfg.partitioner, render::Partitioner::affinity);
+  EXPECT_EQ(cfg.seen_keys().at("partitioner:"), 1);
+
+  std::filesystem::remove(path);
+}
+
+// El lado de bloque debe ser positivo y el particionador uno de TBB
+TEST(test_config, invalid_scheduling) {
+  Config cfg;
+  EXPECT_EXIT(cfg.set_option("tile_size", "0"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  EXPECT_EXIT(cfg.set_option("threads", "-2"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  EXPECT_EXIT(cfg.set_option("partitioner", "static"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+}
+
+// Las opciones de la línea de órdenes usan los mismos handlers que el archivo
+TEST(test_config, set_option) {
+  Config cfg;
+  cfg.set_option("partitioner", "auto");
+  cfg.set_option("samples_per_pixel", "7");
+  EXPECT_EQ(cfg.partitioner, render::Partitioner::automatic);
+  EXPECT_EQ(cfg.samples_per_pixel, 7);
+  EXPECT_EQ(cfg.seen_keys().at("samples_per_pixel:"), 1);
+  EXPECT_EXIT(cfg.set_option("hilos", "4"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Unknown configuration key");
+}
+
+// El render por nodos NUMA se activa con on y off
+TEST(test_config, numa) {
+  Config cfg;
+  EXPECT_FALSE(cfg.numa);
+  cfg.set_option("numa", "on");
+  EXPECT_TRUE(cfg.numa);
+  cfg.set_option("numa", "off");
+  EXPECT_FALSE(cfg.numa);
+  EXPECT_EQ(cfg.seen_keys().at("numa:"), 2);
+  EXPECT_EXIT(cfg.set_option("numa", "2"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+}
+
+// La exposición es cualquier número finito de pasos y el tone mapping uno de los operadores
+TEST(test_config, exposure_tone_map) {
+  Config cfg;
+  EXPECT_EQ(cfg.exposure, 0.0);
+  EXPECT_EQ(cfg.tone_map, render::ToneMap::none);
+  cfg.set_option("exposure", "-1.5");
+  cfg.set_option("tone_map", "aces");
+  EXPECT_EQ(cfg.exposure, -1.5);
+  EXPECT_EQ(cfg.tone_map, render::ToneMap::aces);
+  cfg.set_option("tone_map", "reinhard");
+  EXPECT_EQ(cfg.tone_map, render::ToneMap::reinhard);
+  EXPECT_EQ(cfg.seen_keys().at("tone_map:"), 2);
+  EXPECT_EXIT(cfg.set_option("exposure", "inf"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+  EXPECT_EXIT(cfg.set_option("tone_map", "filmic"), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "Error: Invalid value for key");
+}
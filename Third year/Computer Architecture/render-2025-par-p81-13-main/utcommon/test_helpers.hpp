@@ -0,0 +1,60 @@
+#ifndef RENDER_UTCOMMON_TEST_HELPERS_HPP
+#define RENDER_UTCOMMON_TEST_HELPERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <intersection.hpp>
+#include <material.hpp>
+#include <memory>
+#include <optional>
+#include <random>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+
+namespace test_helpers {
+
+  // Escena aleatoria dentro del cubo [-lado, lado]^3: los objetos pares son cilindros de eje
+  // cualquiera y los impares esferas; uno de cada cinco usa el material metálico "b" y el resto el
+  // mate "a"
+  inline void fill_random_scene(Scene & scene, std::size_t n, std::uint64_t seed,
+                                double lado = 20.0) {
+    scene.materials["a"] = std::make_unique<Matte>("a", render::vector{0.5, 0.5, 0.5});
+    scene.materials["b"] = std::make_unique<Metal>("b", render::vector{0.9, 0.9, 0.9}, 0.1);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-lado, lado);
+    std::uniform_real_distribution<double> rad(0.2, 1.5);
+    std::uniform_real_distribution<double> axis(-2.0, 2.0);
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const c{pos(rng), pos(rng), pos(rng)};
+      char const * const m = i % 5 == 0 ? "b" : "a";
+      if (i % 2 == 0) {
+        scene.objects.push_back(std::make_unique<render::Cylinder>(
+            c, rad(rng), render::vector{axis(rng), axis(rng), axis(rng)}, m));
+      } else {
+        scene.objects.push_back(std::make_unique<render::Sphere>(c, rad(rng), m));
+      }
+    }
+  }
+
+  // Dos impactos son el mismo bit a bit: distancia, punto, normal y material
+  inline void expect_same_hit(std::optional<render::Intersection> const & fast,
+                              std::optional<render::Intersection> const & ref) {
+    ASSERT_EQ(fast.has_value(), ref.has_value());
+    if (ref) {
+      EXPECT_EQ(fast->lambda, ref->lambda);
+      EXPECT_EQ(fast->punto_interseccion.x, ref->punto_interseccion.x);
+      EXPECT_EQ(fast->punto_interseccion.y, ref->punto_interseccion.y);
+      EXPECT_EQ(fast->punto_interseccion.z, ref->punto_interseccion.z);
+      EXPECT_EQ(fast->vector_normal.x, ref->vector_normal.x);
+      EXPECT_EQ(fast->vector_normal.y, ref->vector_normal.y);
+      EXPECT_EQ(fast->vector_normal.z, ref->vector_normal.z);
+      EXPECT_EQ(fast->material, ref->material);
+    }
+  }
+
+}  // namespace test_helpers
+
+#endif
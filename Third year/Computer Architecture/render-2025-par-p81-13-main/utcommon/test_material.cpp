@@ -2,8 +2,10 @@
 #include <cmath>
 #include <cstddef>
 #include <gtest/gtest.h>
+#include <initializer_list>
 #include <material.hpp>
 #include <numbers>
+#include <sampler.hpp>
 #include <random>
 #include <tuple>
 #include <vector.hpp>
@@ -35,7 +37,7 @@ namespace {
 //clase de test para materiales
 class MaterialTest : public ::testing::Test {
 protected:
-  std::mt19937_64 rng{123'456'789ULL};
+  render::Sampler rng{render::SamplerKind::random, 123'456'789ULL, 0, 0};
 
   Matte matte_gray{"matte_gray", render::vector(0.5, 0.5, 0.5)};
   Matte matte_colored{"matte_colored", render::vector(0.8, 0.3, 0.1)};
@@ -512,8 +514,8 @@ TEST_F(MaterialTest, metal_fuzz_clamped_to_valid_range) {
 
 // Verificar reproducibilidad con la misma semilla
 TEST_F(MaterialTest, reproducibility_with_same_seed) {
-  std::mt19937_64 rng1{42};
-  std::mt19937_64 rng2{42};
+  render::Sampler rng1{render::SamplerKind::random, 42, 0, 0};
+  render::Sampler rng2{render::SamplerKind::random, 42, 0, 0};
 
   render::vector const in_dir = render::vector::normalize(render::vector(0.3, -0.7, 0.5));
   render::vector const normal(0.0, 1.0, 0.0);
@@ -523,3 +525,42 @@ TEST_F(MaterialTest, reproducibility_with_same_seed) {
 
   ExpectVectorNear(dir1, dir2, 1e-12);
 }
+
+// El lote da exactamente lo mismo que scatter impacto a impacto con los mismos muestreadores
+// (de los dos tipos), también a través de la llamada virtual de la clase base
+TEST_F(MaterialTest, scatter_batch_same_as_scatter) {
+  std::mt19937_64 gen{7};
+  std::uniform_real_distribution<double> ud(-1.0, 1.0);
+  ScatterBatch batch;
+  batch.resize(100);
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    batch.in_x[i] = ud(gen);
+    batch.in_y[i] = ud(gen);
+    batch.in_z[i] = ud(gen) - 1.5;
+    batch.n_x[i]  = ud(gen);
+    batch.n_y[i]  = ud(gen) + 1.5;
+    batch.n_z[i]  = ud(gen);
+  }
+  auto const kind = [](std::size_t i) {
+    return i % 2 == 0 ? render::SamplerKind::random : render::SamplerKind::sobol;
+  };
+  for (Material const * m : std::initializer_list<Material const *>{&matte_colored, &metal_fuzzy,
+                                                                     &glass}) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      batch.rng[i] = render::Sampler{kind(i), 99, i, 0};
+    }
+    m->scatter_batch(batch);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      render::Sampler rng_single{kind(i), 99, i, 0};
+      auto const [dir, att] =
+          m->scatter(render::vector{batch.in_x[i], batch.in_y[i], batch.in_z[i]},
+                     render::vector{batch.n_x[i], batch.n_y[i], batch.n_z[i]}, rng_single);
+      EXPECT_EQ(batch.out_x[i], dir.x);
+      EXPECT_EQ(batch.out_y[i], dir.y);
+      EXPECT_EQ(batch.out_z[i], dir.z);
+      EXPECT_EQ(batch.att_r[i], att.x);
+      EXPECT_EQ(batch.att_g[i], att.y);
+      EXPECT_EQ(batch.att_b[i], att.z);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <philox.hpp>
+#include <random>
+
+// Vectores de prueba de Philox4x32-10 de la biblioteca Random123
+TEST(test_philox, VectoresConocidos) {
+  using Words = std::array<std::uint32_t, 4>;
+  EXPECT_EQ(render::philox4x32({0, 0, 0, 0}, {0, 0}),
+            (Words{0x6627'e8d5, 0xe169'c58d, 0xbc57'ac4c, 0x9b00'dbd8}));
+  EXPECT_EQ(render::philox4x32({0xffff'ffff, 0xffff'ffff, 0xffff'ffff, 0xffff'ffff},
+                               {0xffff'ffff, 0xffff'ffff}),
+            (Words{0x408f'276d, 0x41c8'3b0e, 0xa20b'c7c6, 0x6d54'51fd}));
+  EXPECT_EQ(render::philox4x32({0x243f'6a88, 0x85a3'08d3, 0x1319'8a2e, 0x0370'7344},
+                               {0xa409'3822, 0x299f'31d0}),
+            (Words{0xd16c'fe09, 0x94fd'cceb, 0x5001'e420, 0x2412'6ea1}));
+}
+
+// Saltar a una dimensión da los mismos números que avanzar hasta ella
+TEST(test_philox, SeekIgualQueAvanzar) {
+  render::Philox secuencial(7, 1'234, 3);
+  std::array<std::uint64_t, 9> numeros{};
+  for (auto & n : numeros) {
+    n = secuencial();
+  }
+  for (std::uint32_t d = 0; d < numeros.size(); ++d) {
+    render::Philox directo(7, 1'234, 3, d);
+    EXPECT_EQ(directo(), numeros[d]);
+    render::Philox saltado(7, 1'234, 3);
+    (void) saltado();
+    saltado.seek(d);
+    EXPECT_EQ(saltado(), numeros[d]);
+  }
+}
+
+// Cada semilla, píxel y muestra da un flujo distinto
+TEST(test_philox, FlujosDistintos) {
+  std::uint64_t const base = render::Philox(1, 2, 3)();
+  EXPECT_NE(render::Philox(2, 2, 3)(), base);
+  EXPECT_NE(render::Philox(1, 3, 3)(), base);
+  EXPECT_NE(render::Philox(1, 2, 4)(), base);
+  EXPECT_NE(render::Philox(1, 2 + (std::uint64_t{1} << 32U), 3)(), base);
+  EXPECT_EQ(render::Philox(1, 2, 3)(), base);
+}
+
+// Sirve como generador de las distribuciones estándar
+TEST(test_philox, DistribucionUniforme) {
+  render::Philox rng(5, 0, 0);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  constexpr int n = 100'000;
+  double suma     = 0.0;
+  for (int i = 0; i < n; ++i) {
+    double const u = dist(rng);
+    ASSERT_GE(u, 0.0);
+    ASSERT_LT(u, 1.0);
+    suma += u;
+  }
+  EXPECT_NEAR(suma / n, 0.5, 0.01);
+}
+
+// Los números del generador son las dos mitades de cada bloque de Philox4x32-10
+TEST(test_philox, GeneradorUsaLosBloques) {
+  render::Philox rng(0x299f'31d0'a409'3822, 0x85a3'08d3'243f'6a88, 0x1319'8a2e, 0);
+  for (std::uint32_t bloque = 0; bloque < 5; ++bloque) {
+    auto const w = render::philox4x32({0x243f'6a88, 0x85a3'08d3, 0x1319'8a2e, bloque},
+                                      {0xa409'3822, 0x299f'31d0});
+    EXPECT_EQ(rng(), (std::uint64_t{w[0]} << 32U) | w[1]);
+    EXPECT_EQ(rng(), (std::uint64_t{w[2]} << 32U) | w[3]);
+  }
+}
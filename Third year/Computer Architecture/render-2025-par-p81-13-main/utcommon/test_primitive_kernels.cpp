@@ -0,0 +1,174 @@
+#include <compiled_scene.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <object.hpp>
+#include <primitive_kernels.hpp>
+#include <random>
+#include <ray.hpp>
+#include <simd.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+
+namespace {
+
+  using Objects = std::vector<std::unique_ptr<render::Object3D>>;
+
+  Objects random_spheres(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-8.0, 8.0);
+    std::uniform_real_distribution<double> rad(0.2, 2.0);
+    Objects objects;
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const c{pos(rng), pos(rng), pos(rng)};
+      objects.push_back(std::make_unique<render::Sphere>(c, rad(rng), "m"));
+    }
+    return objects;
+  }
+
+  // Cilindros de ejes aleatorios; los primeros tienen el eje z para que los rayos paralelos al
+  // eje den en las tapas
+  Objects random_cylinders(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-8.0, 8.0);
+    std::uniform_real_distribution<double> rad(0.2, 2.0);
+    std::uniform_real_distribution<double> axis(-3.0, 3.0);
+    Objects objects;
+    for (std::size_t i = 0; i < n; ++i) {
+      render::vector const c{pos(rng), pos(rng), pos(rng)};
+      render::vector const a =
+          i % 4 == 0 ? render::vector{0.0, 0.0, axis(rng)}
+                     : render::vector{axis(rng), axis(rng), axis(rng)};
+      objects.push_back(std::make_unique<render::Cylinder>(c, rad(rng), a, "m"));
+    }
+    return objects;
+  }
+
+  // Referencia: llamadas a collision con el criterio de Scene::intersect_linear
+  render::NearestHit reference_nearest(Objects const & objects, render::ray const & r) {
+    render::NearestHit best;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+      auto const hit = objects[i]->collision(r);
+      if (hit and hit->lambda > render::CompiledScene::min_lambda and
+          hit->lambda < best.lambda) {
+        best = render::NearestHit{hit->lambda, static_cast<std::uint32_t>(i)};
+      }
+    }
+    return best;
+  }
+
+  std::vector<render::SimdLevel> supported_levels() {
+    std::vector<render::SimdLevel> levels;
+    for (auto const level :
+         {render::SimdLevel::scalar, render::SimdLevel::avx2, render::SimdLevel::avx512}) {
+      if (render::simd_supported(level)) {
+        levels.push_back(level);
+      }
+    }
+    return levels;
+  }
+
+}  // namespace
+
+// Todos los niveles soportados dan el mismo impacto que Sphere::collision, también con tamaños
+// que no son múltiplo de la anchura del vector y con rayos que salen de dentro de las esferas
+TEST(test_primitive_kernels, EsferasIgualQueEscalar) {
+  std::mt19937_64 rng(31);
+  std::uniform_real_distribution<double> pos(-12.0, 12.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  for (std::size_t const n : {1U, 3U, 4U, 7U, 8U, 13U, 64U, 257U}) {
+    Objects const objects = random_spheres(n, n);
+    render::CompiledScene cs;
+    cs.build(objects);
+    for (int k = 0; k < 500; ++k) {
+      render::ray const r(render::vector{pos(rng), pos(rng), pos(rng)},
+                          render::vector{dir(rng), dir(rng), dir(rng)});
+      render::NearestHit const ref = reference_nearest(objects, r);
+      for (auto const level : supported_levels()) {
+        render::NearestHit const hit = render::nearest_sphere(cs.spheres(), r, level);
+        ASSERT_EQ(hit.slot, ref.slot) << render::simd_level_name(level) << " n=" << n;
+        ASSERT_EQ(hit.lambda, ref.lambda) << render::simd_level_name(level) << " n=" << n;
+      }
+    }
+  }
+}
+
+// Esferas repetidas: gana la de menor posición en cualquier carril
+TEST(test_primitive_kernels, EmpateDevuelveMenorPosicion) {
+  Objects objects;
+  for (int i = 0; i < 19; ++i) {
+    double const x = i < 6 ? 50.0 : 0.0;
+    objects.push_back(std::make_unique<render::Sphere>(render::vector{x, 0.0, 0.0}, 1.0, "m"));
+  }
+  render::CompiledScene cs;
+  cs.build(objects);
+  render::ray const r(render::vector{0.0, 0.0, -5.0}, render::vector{0.0, 0.0, 1.0});
+  for (auto const level : supported_levels()) {
+    render::NearestHit const hit = render::nearest_sphere(cs.spheres(), r, level);
+    EXPECT_EQ(hit.slot, 6U) << render::simd_level_name(level);
+    EXPECT_EQ(hit.lambda, 4.0) << render::simd_level_name(level);
+  }
+}
+
+// Sin esferas o sin impacto no hay resultado
+TEST(test_primitive_kernels, SinImpacto) {
+  render::CompiledScene cs;
+  render::ray const r(render::vector{0.0, 0.0, 0.0}, render::vector{0.0, 0.0, 1.0});
+  EXPECT_FALSE(render::nearest_sphere(cs.spheres(), r).found());
+  Objects const objects = random_spheres(40, 3);
+  cs.build(objects);
+  render::ray const away(render::vector{0.0, 0.0, 100.0}, render::vector{0.0, 0.0, 1.0});
+  for (auto const level : supported_levels()) {
+    EXPECT_FALSE(render::nearest_sphere(cs.spheres(), away, level).found());
+  }
+}
+
+// Cilindros: mismo impacto que Cylinder::collision en todos los niveles, y la misma superficie
+// (lateral o tapa) que la versión escalar
+TEST(test_primitive_kernels, CilindrosIgualQueEscalar) {
+  std::mt19937_64 rng(41);
+  std::uniform_real_distribution<double> pos(-12.0, 12.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  for (std::size_t const n : {1U, 5U, 8U, 11U, 64U, 131U}) {
+    Objects const objects = random_cylinders(n, n + 100);
+    render::CompiledScene cs;
+    cs.build(objects);
+    for (int k = 0; k < 500; ++k) {
+      // uno de cada cuatro rayos va paralelo al eje z
+      render::vector const d = k % 4 == 0 ? render::vector{0.0, 0.0, dir(rng)}
+                                          : render::vector{dir(rng), dir(rng), dir(rng)};
+      render::ray const r(render::vector{pos(rng), pos(rng), pos(rng)}, d);
+      render::NearestHit const ref    = reference_nearest(objects, r);
+      render::NearestHit const scalar =
+          render::nearest_cylinder(cs.cylinders(), r, render::SimdLevel::scalar);
+      for (auto const level : supported_levels()) {
+        render::NearestHit const hit = render::nearest_cylinder(cs.cylinders(), r, level);
+        ASSERT_EQ(hit.slot, ref.slot) << render::simd_level_name(level) << " n=" << n;
+        ASSERT_EQ(hit.lambda, ref.lambda) << render::simd_level_name(level) << " n=" << n;
+        ASSERT_EQ(hit.surface, scalar.surface) << render::simd_level_name(level) << " n=" << n;
+      }
+    }
+  }
+}
+
+// Rayo a lo largo del eje: impacto en la tapa inferior desde cualquier carril
+TEST(test_primitive_kernels, CilindroImpactoEnTapa) {
+  Objects objects;
+  for (int i = 0; i < 9; ++i) {
+    double const x = i == 8 ? 0.0 : 10.0 + i;
+    objects.push_back(std::make_unique<render::Cylinder>(
+        render::vector{x, 0.0, 0.0}, 0.5, render::vector{0.0, 0.0, 2.0}, "m"));
+  }
+  render::CompiledScene cs;
+  cs.build(objects);
+  render::ray const r(render::vector{0.0, 0.0, -5.0}, render::vector{0.0, 0.0, 1.0});
+  for (auto const level : supported_levels()) {
+    render::NearestHit const hit = render::nearest_cylinder(cs.cylinders(), r, level);
+    EXPECT_EQ(hit.slot, 8U) << render::simd_level_name(level);
+    EXPECT_EQ(hit.lambda, 4.0) << render::simd_level_name(level);
+    EXPECT_EQ(hit.surface, render::HitSurface::bottom_cap) << render::simd_level_name(level);
+  }
+}
@@ -0,0 +1,117 @@
+#include <accelerator.hpp>
+#include <array>
+#include <bvh.hpp>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <material.hpp>
+#include <memory>
+#include <optional>
+#include <random>
+#include <ray.hpp>
+#include <ray_packet.hpp>
+#include <scene.hpp>
+#include <span>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::expect_same_hit;
+
+  // Esferas en una caja delante de la cámara por defecto
+  void fill_spheres(Scene & scene, std::size_t n, std::uint64_t seed) {
+    scene.materials["a"] = std::make_unique<Matte>("a", render::vector{0.5, 0.5, 0.5});
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> pos(-6.0, 6.0);
+    std::uniform_real_distribution<double> rad(0.2, 1.2);
+    for (std::size_t i = 0; i < n; ++i) {
+      scene.objects.push_back(std::make_unique<render::Sphere>(
+          render::vector{pos(rng), pos(rng), pos(rng)}, rad(rng), "a"));
+    }
+    scene.build_bvh();
+  }
+
+}  // namespace
+
+// Paquetes de rayos primarios de 2x2, 4x4 y 8x8 píxeles dan los mismos impactos que el
+// recorrido rayo a rayo
+TEST(test_ray_packet, MismoImpactoQueRayoARayo) {
+  Scene scene;
+  fill_spheres(scene, 300, 5);
+  scene.accelerator = render::Accelerator::bvh2;
+  Config cfg;
+  cfg.image_width = 64;
+  render::Camera cam(cfg);
+  std::mt19937_64 rng(9);
+  std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+  for (int lado : {2, 4, 8}) {
+    for (int fila0 = 0; fila0 + lado <= cam.alto_imagen; fila0 += lado) {
+      for (int col0 = 0; col0 + lado <= cam.ancho_imagen; col0 += lado) {
+        std::vector<render::ray> rays;
+        for (int f = fila0; f < fila0 + lado; ++f) {
+          for (int c = col0; c < col0 + lado; ++c) {
+            rays.push_back(cam.generar_ray(f, c, jitter(rng), jitter(rng)));
+          }
+        }
+        std::vector<std::optional<render::Intersection>> hits(rays.size());
+        scene.intersect_packet(rays, hits);
+        for (std::size_t i = 0; i < rays.size(); ++i) {
+          expect_same_hit(hits[i], scene.intersect(rays[i]));
+        }
+      }
+    }
+  }
+}
+
+// Sin origen común no hay test conjunto, pero el resultado sigue siendo el mismo
+TEST(test_ray_packet, RayosNoCoherentes) {
+  Scene scene;
+  fill_spheres(scene, 200, 6);
+  std::mt19937_64 rng(3);
+  std::uniform_real_distribution<double> u(-20.0, 20.0);
+  std::array<render::ray, render::max_packet_rays> rays{};
+  for (auto & r : rays) {
+    render::vector const o{u(rng), u(rng), u(rng)};
+    r = render::ray(o, render::vector::sub(render::vector{u(rng), u(rng), u(rng)}, o));
+  }
+  std::array<render::PrimHit, render::max_packet_rays> hits{};
+  render::closest_hits_packet(scene.bvh, scene.compiled, rays, hits);
+  for (std::size_t i = 0; i < rays.size(); ++i) {
+    render::PrimHit best;
+    scene.bvh.traverse(
+        rays[i], best.lambda,
+        [&](std::uint32_t idx) { scene.compiled.test(idx, rays[i], best); });
+    EXPECT_EQ(hits[i].lambda, best.lambda);
+    EXPECT_EQ(hits[i].obj, best.obj);
+  }
+}
+
+// El test conjunto descarta para todo el paquete los nodos que ningún rayo corta
+TEST(test_ray_packet, PaqueteVisitaMenosNodos) {
+  Scene scene;
+  fill_spheres(scene, 500, 7);
+  scene.accelerator = render::Accelerator::bvh2;
+  Config cfg;
+  cfg.image_width = 64;
+  render::Camera cam(cfg);
+  std::vector<render::ray> rays;
+  for (int f = 20; f < 28; ++f) {
+    for (int c = 20; c < 28; ++c) {
+      rays.push_back(cam.generar_ray(f, c, 0.0, 0.0));
+    }
+  }
+  render::TraversalStats packet_stats;
+  std::vector<std::optional<render::Intersection>> hits(rays.size());
+  scene.intersect_packet(rays, hits, &packet_stats);
+  render::TraversalStats single_stats;
+  for (auto const & r : rays) {
+    (void) scene.intersect(r, &single_stats);
+  }
+  EXPECT_GT(packet_stats.nodes, 0U);
+  EXPECT_LT(packet_stats.nodes, single_stats.nodes);
+}
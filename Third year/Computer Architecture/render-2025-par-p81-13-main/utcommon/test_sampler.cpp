@@ -0,0 +1,136 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <philox.hpp>
+#include <sampler.hpp>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  // Número de puntos de cada caja elemental de volumen 2^-m (2^a x 2^(m-a) cajas) para las
+  // primeras 2^m muestras de las dimensiones `d0` y `d1` de un muestreador Sobol
+  bool es_red_0m2(std::uint64_t pixel, std::uint32_t d0, std::uint32_t d1, std::uint32_t m) {
+    std::uint32_t const n = std::uint32_t{1} << m;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> puntos;
+    for (std::uint32_t s = 0; s < n; ++s) {
+      render::Sampler sampler(render::SamplerKind::sobol, 5, pixel, s, d0);
+      std::uint64_t const x = sampler();
+      sampler.seek(d1);
+      puntos.emplace_back(x, sampler());
+    }
+    for (std::uint32_t a = 0; a <= m; ++a) {
+      std::set<std::pair<std::uint64_t, std::uint64_t>> cajas;
+      for (auto const & [x, y] : puntos) {
+        cajas.emplace(a == 0 ? 0 : x >> (64 - a), a == m ? 0 : y >> (64 - (m - a)));
+      }
+      if (cajas.size() != n) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+}  // namespace
+
+// Primeros puntos de las dimensiones 0 y 1 de Sobol: van der Corput y 1/2, 3/4, 1/4...
+TEST(test_sampler, PuntosDeSobol) {
+  std::array<std::uint32_t, 4> const dim0{0, 0x8000'0000, 0x4000'0000, 0xC000'0000};
+  std::array<std::uint32_t, 4> const dim1{0, 0x8000'0000, 0xC000'0000, 0x4000'0000};
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(render::sobol_point(i, 0), dim0[i]);
+    EXPECT_EQ(render::sobol_point(i, 1), dim1[i]);
+  }
+  EXPECT_EQ(render::sobol_table[2][2], 0x6000'0000U);
+}
+
+// El barajado de Owen es una permutación que conserva los prefijos: dos valores con los mismos
+// k bits altos siguen compartiendo k bits altos
+TEST(test_sampler, BarajadoConservaPrefijos) {
+  std::set<std::uint32_t> imagen;
+  for (std::uint32_t x = 0; x < 4'096; ++x) {
+    imagen.insert(render::owen_scramble(x << 20U, 77) >> 20U);
+    EXPECT_EQ(render::owen_scramble(x << 20U, 77) >> 20U,
+              render::owen_scramble((x << 20U) | 0x000F'FFFFU, 77) >> 20U);
+  }
+  EXPECT_EQ(imagen.size(), 4'096U);
+}
+
+// Las primeras 2^m muestras de un píxel son una red (0, m, 2) en las dos primeras dimensiones de
+// cada grupo, con cualquier semilla de píxel
+TEST(test_sampler, MuestrasEstratificadas) {
+  for (std::uint64_t pixel : {0ULL, 1ULL, 123'456ULL}) {
+    for (std::uint32_t m = 1; m <= 6; ++m) {
+      EXPECT_TRUE(es_red_0m2(pixel, 0, 1, m)) << "pixel " << pixel << " m " << m;
+      EXPECT_TRUE(es_red_0m2(pixel, 16, 17, m)) << "pixel " << pixel << " m " << m;
+    }
+  }
+}
+
+// Saltar a una dimensión da el mismo número que avanzar hasta ella
+TEST(test_sampler, SeekIgualQueAvanzar) {
+  for (auto const kind : {render::SamplerKind::random, render::SamplerKind::sobol}) {
+    render::Sampler secuencial(kind, 3, 42, 7);
+    for (std::uint32_t d = 0; d < 20; ++d) {
+      std::uint64_t const x = secuencial();
+      render::Sampler saltado(kind, 3, 42, 7);
+      saltado.seek(d);
+      EXPECT_EQ(saltado(), x);
+    }
+  }
+}
+
+// Con SamplerKind::random los números son los de Philox
+TEST(test_sampler, AleatorioEsPhilox) {
+  render::Sampler sampler(render::SamplerKind::random, 9, 10, 11);
+  render::Philox philox(9, 10, 11);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(sampler(), philox());
+  }
+}
+
+// Píxeles distintos tienen barajados distintos: las muestras no se repiten entre píxeles
+TEST(test_sampler, PixelesDecorrelados) {
+  render::Sampler a(render::SamplerKind::sobol, 1, 0, 3);
+  render::Sampler b(render::SamplerKind::sobol, 1, 1, 3);
+  int iguales = 0;
+  for (int d = 0; d < 32; ++d) {
+    iguales += a() == b() ? 1 : 0;
+  }
+  EXPECT_EQ(iguales, 0);
+}
+
+// La media de muchas muestras de cada dimensión es la de una uniforme en [0, 1)
+TEST(test_sampler, DistribucionUniforme) {
+  for (std::uint32_t d = 0; d < 8; ++d) {
+    double suma = 0.0;
+    for (std::uint32_t s = 0; s < 1'024; ++s) {
+      render::Sampler sampler(render::SamplerKind::sobol, 2, 99, s, d);
+      double const u = render::unit_double(sampler());
+      ASSERT_GE(u, 0.0);
+      ASSERT_LT(u, 1.0);
+      suma += u;
+    }
+    EXPECT_NEAR(suma / 1'024.0, 0.5, 0.01);
+  }
+}
+
+// La conversión a double usa los 53 bits altos y no depende de la biblioteca estándar: los
+// números de cada muestreador son siempre estos
+TEST(test_sampler, ConversionUniformeValoresConocidos) {
+  EXPECT_EQ(render::unit_double(0), 0.0);
+  EXPECT_EQ(render::unit_double(0x7FF), 0.0);
+  EXPECT_EQ(render::unit_double(std::uint64_t{1} << 63U), 0.5);
+  EXPECT_EQ(render::unit_double(~std::uint64_t{0}), 1.0 - 0x1p-53);
+
+  render::Sampler philox(render::SamplerKind::random, 7, 11, 3);
+  EXPECT_EQ(render::uniform_double(philox, -1.0, 1.0), 0x1.840934d31a5eep-1);
+  EXPECT_EQ(render::uniform_double(philox, -1.0, 1.0), -0x1.c2a2cd7025cp-1);
+  EXPECT_EQ(render::uniform_double(philox, -1.0, 1.0), -0x1.7a99a0ca4a4ap-1);
+  render::Sampler sobol(render::SamplerKind::sobol, 7, 11, 3);
+  EXPECT_EQ(render::uniform_double(sobol, -1.0, 1.0), -0x1.ad0ecc7b615ecp-2);
+  EXPECT_EQ(render::uniform_double(sobol, -1.0, 1.0), -0x1.1feeb18cab3ccp-1);
+  EXPECT_EQ(render::uniform_double(sobol, -1.0, 1.0), -0x1.e77a6e28c62d4p-2);
+}
@@ -3,8 +3,11 @@
 #include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <material.hpp>
+#include <memory>
 #include <ray.hpp>
 #include <scene.hpp>
+#include <sphere.hpp>
 #include <string>
 #include <system_error>
 
@@ -374,7 +377,7 @@ TEST(test_intersect_scene, Intersect_SeleccionaElMasCercano) {
   }
   auto const & hit = res.value();
   EXPECT_NEAR(hit.lambda, 4.0, 1e-6);  // coincide con la esfera en z=0
-  EXPECT_EQ(hit.nombre_material, "a");
+  EXPECT_EQ(scene.materialById(hit.material), scene.materialByName("a"));
 
   std::filesystem::remove(path);
 }
@@ -403,3 +406,101 @@ TEST(test_intersect_scene, Intersect_RayoEmpiezaDentroSeleccionaSalida) {
 
   std::filesystem::remove(path);
 }
+
+// Los materiales se numeran de forma densa por orden de nombre y cada objeto guarda el suyo
+TEST(test_load_scene, material_ids) {
+  Scene scene;
+  std::string const path = "/tmp/test_load_scene_ids.txt";
+  std::ofstream ofs(path);
+  ofs << "matte: zz 1 0 0\n"
+         "metal: aa 0.8 0.8 0.8 0.0\n"
+         "refractive: mm 1.5\n"
+         "sphere: 0 0 0 1 zz\n"
+         "sphere: 0 0 5 1 aa\n";
+  ofs.close();
+
+  EXPECT_NO_THROW(scene.load_scene(path));
+  ASSERT_EQ(scene.material_table.size(), 3U);
+  EXPECT_EQ(scene.material_ids.at("aa"), 0U);
+  EXPECT_EQ(scene.material_ids.at("mm"), 1U);
+  EXPECT_EQ(scene.material_ids.at("zz"), 2U);
+  for (auto const & [name, id] : scene.material_ids) {
+    EXPECT_EQ(scene.materialById(id), scene.materialByName(name));
+  }
+  EXPECT_EQ(scene.materialById(3), nullptr);
+  EXPECT_EQ(scene.objects[0]->material_id, 2U);
+  EXPECT_EQ(scene.objects[1]->material_id, 0U);
+
+  render::ray r;
+  r.origin    = render::vector{0.0, 0.0, -5.0};
+  r.direction = render::vector{0.0, 0.0, 1.0};
+  auto const hit = scene.intersect(r);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(scene.materialById(hit->material), scene.materialByName("zz"));
+
+  std::filesystem::remove(path);
+}
+
+// La réplica es independiente del original (otros objetos y BVH) e interseca igual, con los
+// mismos materiales
+TEST(test_intersect_scene, Replica_IntersecaIgual) {
+  Scene scene;
+  std::string const path = "/tmp/test_scene_replica.txt";
+  std::ofstream ofs(path);
+  ofs << "matte: a 1 0 0\n"
+         "metal: b 0.8 0.8 0.8 0.0\n"
+         "sphere: 0 0 0 1 a\n"
+         "sphere: 0 0 5 1 b\n"
+         "cylinder: 3 0 0 0.5 0 2 0 b\n";
+  ofs.close();
+  EXPECT_NO_THROW(scene.load_scene(path));
+
+  Scene const copia = scene.replica();
+  ASSERT_EQ(copia.objects.size(), scene.objects.size());
+  EXPECT_NE(copia.objects[0].get(), scene.objects[0].get());
+  EXPECT_EQ(copia.objects[2]->material_id, scene.objects[2]->material_id);
+  EXPECT_EQ(copia.accelerator, scene.accelerator);
+  for (double const x : {0.0, 0.5, 3.0, 3.4}) {
+    render::ray r;
+    r.origin    = render::vector{x, 0.0, -5.0};
+    r.direction = render::vector{0.0, 0.0, 1.0};
+    auto const a = scene.intersect(r);
+    auto const b = copia.intersect(r);
+    ASSERT_EQ(a.has_value(), b.has_value());
+    if (a) {
+      EXPECT_EQ(a->lambda, b->lambda);
+      EXPECT_EQ(copia.materialById(b->material), scene.materialById(a->material));
+    }
+  }
+
+  std::filesystem::remove(path);
+}
+
+// Un objeto añadido tras build_bvh se interseca con el recorrido lineal y su material se busca
+// por nombre; la copia reconstruida lo tiene ya en la escena compilada
+TEST(test_intersect_scene, ObjetoAnadidoTrasBuildBvh) {
+  Scene scene;
+  scene.materials["a"] = std::make_unique<Matte>("a", render::vector{1.0, 0.0, 0.0});
+  scene.materials["b"] = std::make_unique<Matte>("b", render::vector{0.0, 1.0, 0.0});
+  scene.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 5.0}, 1.0, "a"));
+  scene.build_bvh();
+  scene.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 1.0, "b"));
+  EXPECT_FALSE(scene.up_to_date());
+
+  render::ray r;
+  r.origin    = render::vector{0.0, 0.0, -5.0};
+  r.direction = render::vector{0.0, 0.0, 1.0};
+  auto const hit = scene.intersect(r);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_NEAR(hit->lambda, 4.0, 1e-6);
+  EXPECT_EQ(scene.materialById(hit->material), scene.materialByName("b"));
+
+  Scene const copia = scene.rebuilt();
+  EXPECT_TRUE(copia.up_to_date());
+  auto const hit_copia = copia.intersect(r);
+  ASSERT_TRUE(hit_copia.has_value());
+  EXPECT_EQ(hit_copia->lambda, hit->lambda);
+  EXPECT_EQ(copia.materialById(hit_copia->material), scene.materialByName("b"));
+}
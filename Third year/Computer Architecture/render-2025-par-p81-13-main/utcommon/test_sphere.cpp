@@ -24,7 +24,8 @@ TEST(test_sphere, RayoGolpeaCentro) {
   EXPECT_NEAR(hit.punto_interseccion.x, 0.0, 1e-9);
   EXPECT_NEAR(hit.punto_interseccion.y, 0.0, 1e-9);
   EXPECT_NEAR(hit.punto_interseccion.z, -1.0, 1e-9);
-  EXPECT_EQ(hit.nombre_material, "test_material");
+  // sin escena el material no tiene identificador asignado
+  EXPECT_EQ(hit.material, render::Intersection::no_material);
 }
 
 // Apunta hacia un punto fuera de la esfera
@@ -0,0 +1,197 @@
+#include <accelerator.hpp>
+#include <atomic>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cylinder.hpp>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <material.hpp>
+#include <memory>
+#include <new>
+#include <random>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+
+// Este ejecutable sustituye el operator new global para contar las reservas de memoria; va en
+// su propio target (utpar_alloc) para no afectar al resto de tests
+
+namespace {
+
+  std::atomic<std::uint64_t> reservas{0};
+
+  void * reservar(std::size_t n) {
+    reservas.fetch_add(1, std::memory_order_relaxed);
+    if (void * p = std::malloc(n == 0 ? 1 : n)) {
+      return p;
+    }
+    throw std::bad_alloc();
+  }
+
+  void * reservar_alineado(std::size_t n, std::align_val_t al) {
+    reservas.fetch_add(1, std::memory_order_relaxed);
+    auto const a = static_cast<std::size_t>(al);
+    if (void * p = std::aligned_alloc(a, (n + a - 1) / a * a)) {
+      return p;
+    }
+    throw std::bad_alloc();
+  }
+
+}  // namespace
+
+void * operator new(std::size_t n) {
+  return reservar(n);
+}
+
+void * operator new[](std::size_t n) {
+  return reservar(n);
+}
+
+void * operator new(std::size_t n, std::align_val_t al) {
+  return reservar_alineado(n, al);
+}
+
+void * operator new[](std::size_t n, std::align_val_t al) {
+  return reservar_alineado(n, al);
+}
+
+void operator delete(void * p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void * p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void * p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void * p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void * p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+  // Escena de referencia: esferas y cilindros con los tres tipos de material
+  void escena_referencia(Scene & escena) {
+    escena.materials["mate"] = std::make_unique<Matte>("mate", render::vector{0.7, 0.3, 0.3});
+    escena.materials["metal"] =
+        std::make_unique<Metal>("metal", render::vector{0.8, 0.8, 0.8}, 0.2);
+    escena.materials["vidrio"] = std::make_unique<Refractive>("vidrio", 1.5);
+    char const * const nombres[] = {"mate", "metal", "vidrio"};
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> pos(-3.0, 3.0);
+    for (int i = 0; i < 30; ++i) {
+      render::vector const c{pos(rng), pos(rng), pos(rng) - 8.0};
+      char const * const m = nombres[i % 3];
+      if (i % 4 == 0) {
+        escena.objects.push_back(
+            std::make_unique<render::Cylinder>(c, 0.5, render::vector{0.0, 1.0, 0.0}, m));
+      } else {
+        escena.objects.push_back(std::make_unique<render::Sphere>(c, 0.6, m));
+      }
+    }
+    escena.build_bvh();
+  }
+
+  Config config_referencia(int muestras) {
+    Config cfg;
+    cfg.image_width       = 32;
+    cfg.samples_per_pixel = muestras;
+    cfg.max_depth         = 6;
+    cfg.camera_position   = render::vector{0.0, 0.0, 4.0};
+    cfg.camera_target     = render::vector{0.0, 0.0, -8.0};
+    return cfg;
+  }
+
+  // Reservas hechas al renderizar la escena de referencia con `muestras` muestras por píxel
+  std::uint64_t reservas_render(int muestras, std::uint64_t & pixeles) {
+    Scene escena;
+    escena_referencia(escena);
+    Config const cfg = config_referencia(muestras);
+    render::Camera cam(cfg);
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    pixeles = static_cast<std::uint64_t>(cam.ancho_imagen) *
+              static_cast<std::uint64_t>(cam.alto_imagen);
+    std::uint64_t const antes = reservas.load();
+    render::render_image_soa(escena, cfg, cam, img);
+    return reservas.load() - antes;
+  }
+
+}  // namespace
+
+// El bucle de muestras de un píxel no reserva memoria, con cualquier estructura de aceleración
+TEST(RenderAlloc, CalcularPixelSinReservas) {
+  for (auto const acc : {render::Accelerator::linear, render::Accelerator::bvh2,
+                         render::Accelerator::bvh4}) {
+    Scene escena;
+    escena_referencia(escena);
+    escena.accelerator = acc;
+    Config const cfg   = config_referencia(8);
+    render::Camera cam(cfg);
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    render::RenderContext ctx{escena, cfg, cam, img};
+    std::uint64_t const antes = reservas.load();
+    for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+      for (int col = 0; col < cam.ancho_imagen; ++col) {
+        render::calcular_pixel_soa(fila, col, ctx);
+      }
+    }
+    EXPECT_EQ(reservas.load() - antes, 0U);
+  }
+}
+
+// Los paquetes de rayos primarios tampoco reservan memoria
+TEST(RenderAlloc, CalcularPaqueteSinReservas) {
+  Scene escena;
+  escena_referencia(escena);
+  escena.accelerator = render::Accelerator::bvh2;
+  Config cfg         = config_referencia(8);
+  cfg.packet_size    = 8;
+  render::Camera cam(cfg);
+  ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+  render::RenderContext ctx{escena, cfg, cam, img};
+  std::uint64_t const antes = reservas.load();
+  for (int fila = 0; fila < cam.alto_imagen; fila += cfg.packet_size) {
+    for (int col = 0; col < cam.ancho_imagen; col += cfg.packet_size) {
+      render::calcular_paquete_soa(fila, col, ctx);
+    }
+  }
+  EXPECT_EQ(reservas.load() - antes, 0U);
+}
+
+// Las reservas del render completo (lista de teselas, imagen de acumulación, buffer de tesela de
+// cada hilo, bloques de quantize y tareas de TBB) no dependen del número de muestras
+TEST(RenderAlloc, RenderSinReservasPorMuestra) {
+  std::uint64_t pixeles = 0;
+  // la primera vez se crean los hilos de TBB
+  (void) reservas_render(1, pixeles);
+  std::uint64_t const una       = reservas_render(1, pixeles);
+  std::uint64_t const dieciseis = reservas_render(16, pixeles);
+  // el reparto de bloques entre hilos puede cambiar algo de una ejecución a otra; una reserva
+  // por píxel o por muestra añadiría cientos
+  constexpr std::uint64_t holgura = 16;
+  EXPECT_LE(dieciseis, una + holgura);
+  EXPECT_GT(pixeles, 10 * holgura);
+}
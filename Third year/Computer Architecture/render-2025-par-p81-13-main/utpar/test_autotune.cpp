@@ -0,0 +1,45 @@
+#include <autotune.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <partitioner.hpp>
+#include <scene.hpp>
+#include <set>
+#include <tuple>
+
+// El autotuner prueba todos los particionadores con cada lado de bloque y ordena por tiempo
+TEST(Autotune, OrdenadoDelMasRapidoAlMasLento) {
+  Scene const escena;
+  Config cfg;
+  cfg.image_width = 16;
+  auto const resultados = render::autotune(escena, cfg, 1, 1);
+  ASSERT_FALSE(resultados.empty());
+  EXPECT_EQ(resultados.size() % 3, 0U);
+  for (std::size_t i = 1; i < resultados.size(); ++i) {
+    EXPECT_LE(resultados[i - 1].seconds, resultados[i].seconds);
+    EXPECT_GT(resultados[i].threads, 0);
+  }
+}
+
+// Los lados que se redondean al mismo lado de tesela se prueban una sola vez, con el efectivo
+TEST(Autotune, LadosEfectivosSinRepetir) {
+  Scene const escena;
+  Config cfg;
+  cfg.image_width       = 16;
+  cfg.packet_size       = 8;
+  auto const resultados = render::autotune(escena, cfg, 1, 1);
+  std::set<std::tuple<int, int, render::Partitioner>> vistas;
+  std::set<int> lados;
+  for (render::TuneResult const & r : resultados) {
+    EXPECT_EQ(r.tile_size % cfg.packet_size, 0);
+    EXPECT_TRUE(vistas.emplace(r.threads, r.tile_size, r.partitioner).second);
+    lados.insert(r.tile_size);
+  }
+  EXPECT_EQ(lados, (std::set<int>{8, 16, 32, 64}));
+}
+
+TEST(Autotune, NombresDeParticionadores) {
+  EXPECT_EQ(render::partitioner_name(render::Partitioner::simple), "simple");
+  EXPECT_EQ(render::partitioner_name(render::Partitioner::automatic), "auto");
+  EXPECT_EQ(render::partitioner_name(render::Partitioner::affinity), "affinity");
+}
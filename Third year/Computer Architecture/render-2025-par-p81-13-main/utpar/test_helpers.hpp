@@ -0,0 +1,76 @@
+#ifndef RENDER_UTPAR_TEST_HELPERS_HPP
+#define RENDER_UTPAR_TEST_HELPERS_HPP
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <material.hpp>
+#include <memory>
+#include <pixel.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector.hpp>
+
+namespace test_helpers {
+
+  // Escena de prueba sin build_bvh: esfera mate de radio 3 en el origen y esfera metálica de
+  // radio 2 a un lado
+  inline void montar_escena_prueba(Scene & escena) {
+    escena.materials["mate"]  = std::make_unique<Matte>("mate", render::vector{0.7, 0.4, 0.2});
+    escena.materials["metal"] =
+        std::make_unique<Metal>("metal", render::vector{0.8, 0.8, 0.9}, 0.3);
+    escena.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 3.0, "mate"));
+    escena.objects.push_back(
+        std::make_unique<render::Sphere>(render::vector{5.0, -1.0, 1.0}, 2.0, "metal"));
+  }
+
+  // La escena de prueba lista para renderizar
+  inline void escena_prueba(Scene & escena) {
+    montar_escena_prueba(escena);
+    escena.build_bvh();
+  }
+
+  // Las dos imágenes coinciden píxel a píxel
+  inline void esperar_iguales(ImageSOA const & a, ImageSOA const & b) {
+    ASSERT_EQ(a.width(), b.width());
+    ASSERT_EQ(a.height(), b.height());
+    for (int y = 0; y < a.height(); ++y) {
+      for (int x = 0; x < a.width(); ++x) {
+        EXPECT_EQ(a.get_pixel(x, y), b.get_pixel(x, y)) << "píxel (" << x << ", " << y << ")";
+      }
+    }
+  }
+
+  // Fichero en el directorio temporal con un nombre propio del test y del proceso, que se borra
+  // al salir del ámbito aunque el test falle
+  class FicheroTemporal {
+  public:
+    explicit FicheroTemporal(std::string const & extension) {
+      ::testing::TestInfo const * const test =
+          ::testing::UnitTest::GetInstance()->current_test_info();
+      path_ = std::filesystem::temp_directory_path() /
+              (std::string(test->test_suite_name()) + "_" + test->name() + "_" +
+               std::to_string(::getpid()) + extension);
+    }
+
+    FicheroTemporal(FicheroTemporal const &)             = delete;
+    FicheroTemporal & operator=(FicheroTemporal const &) = delete;
+
+    ~FicheroTemporal() {
+      std::error_code error;
+      std::filesystem::remove(path_, error);
+    }
+
+    [[nodiscard]] std::filesystem::path const & path() const noexcept { return path_; }
+
+  private:
+    std::filesystem::path path_;
+  };
+
+}  // namespace test_helpers
+
+#endif
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <gtest/gtest.h>
 #include <image_par.hpp>
 #include <pixel.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 // Prueba el constructor y la verificación de las dimensiones (ancho y alto)
 TEST(ImageSOA, ConstructorYDimensiones) {
@@ -88,3 +95,174 @@ TEST(ImageSOA, EscribirPPMOrden2x2) {
   EXPECT_LT(p2, p3);  // Fin de la primera fila antes del inicio de la segunda
   EXPECT_LT(p3, p4);  // (0,1) antes que (1,1)
 }
+
+// Un bloque se copia fila a fila desde canales con filas más largas que el bloque
+TEST(ImageSOA, SetBlockCopiaPorFilas) {
+  ImageSOA img(4, 3);
+  // bloque de 2x2 en (1, 1) desde filas de 3 elementos
+  std::vector<std::uint8_t> const r{1, 2, 0, 3, 4};
+  std::vector<std::uint8_t> const g{5, 6, 0, 7, 8};
+  std::vector<std::uint8_t> const b{9, 10, 0, 11, 12};
+  img.set_block(1, 1, 2, 2, 3, r, g, b);
+  EXPECT_EQ(img.get_pixel(1, 1), (Pixel{1, 5, 9}));
+  EXPECT_EQ(img.get_pixel(2, 1), (Pixel{2, 6, 10}));
+  EXPECT_EQ(img.get_pixel(1, 2), (Pixel{3, 7, 11}));
+  EXPECT_EQ(img.get_pixel(2, 2), (Pixel{4, 8, 12}));
+  EXPECT_EQ(img.get_pixel(0, 1), (Pixel{0, 0, 0}));
+  EXPECT_EQ(img.get_pixel(3, 2), (Pixel{0, 0, 0}));
+}
+
+// Un bloque que se sale de la imagen o con canales cortos no se copia
+TEST(ImageSOA, SetBlockFueraDeRango) {
+  ImageSOA img(4, 3);
+  std::vector<std::uint8_t> const c(16, 1);
+  EXPECT_THROW(img.set_block(3, 0, 2, 1, 2, c, c, c), std::out_of_range);
+  EXPECT_THROW(img.set_block(0, 2, 1, 2, 1, c, c, c), std::out_of_range);
+  std::vector<std::uint8_t> const corto(3, 1);
+  EXPECT_THROW(img.set_block(0, 0, 2, 2, 2, corto, corto, corto), std::invalid_argument);
+}
+
+// El P3 en paralelo es idéntico al de operator<<, también con valores de una, dos y tres cifras
+// y con más filas que un bloque
+TEST(ImageSOA, P3ParaleloIgualQueP3) {
+  ImageSOA img(7, 37);
+  for (int y = 0; y < img.height(); ++y) {
+    for (int x = 0; x < img.width(); ++x) {
+      img.set_pixel(x, y, Pixel{(x * 37 + y) % 256, y * 7, x});
+    }
+  }
+  std::ostringstream p3;
+  img.write_ppm_p3(p3);
+  std::ostringstream paralelo;
+  img.write_ppm_p3_parallel(paralelo);
+  EXPECT_EQ(paralelo.str(), p3.str());
+}
+
+// El P6 lleva la cabecera y un byte por canal en orden row-major
+TEST(ImageSOA, EscribirP6) {
+  ImageSOA img(2, 1);
+  img.set_pixel(0, 0, Pixel{1, 2, 3});
+  img.set_pixel(1, 0, Pixel{255, -4, 300});
+  std::ostringstream os;
+  img.write(os, ImageFormat::p6);
+  std::string const esperado = std::string("P6\n2 1\n255\n") + '\x01' + '\x02' + '\x03' +
+                               '\xff' + '\x00' + '\xff';
+  EXPECT_EQ(os.str(), esperado);
+}
+
+// Nombres de los formatos de salida
+TEST(ImageSOA, ParseImageFormat) {
+  EXPECT_EQ(parse_image_format("p3"), ImageFormat::p3);
+  EXPECT_EQ(parse_image_format("p6"), ImageFormat::p6);
+  EXPECT_EQ(parse_image_format("pfm"), ImageFormat::pfm);
+  EXPECT_EQ(parse_image_format("exr"), ImageFormat::exr);
+  EXPECT_FALSE(hdr_format(ImageFormat::p6));
+  EXPECT_TRUE(hdr_format(ImageFormat::exr));
+  EXPECT_THROW((void) parse_image_format("png"), std::invalid_argument);
+}
+
+// Un byte por canal: los valores fuera de 0-255 se saturan
+TEST(ImageSOA, SetPixelSatura) {
+  ImageSOA img(1, 1);
+  img.set_pixel(0, 0, Pixel{-4, 128, 300});
+  EXPECT_EQ(img.get_pixel(0, 0), (Pixel{0, 128, 255}));
+}
+
+// La imagen de acumulación guarda sumas y muestras por canales, por píxel o por bloques
+TEST(AccumImageSOA, SetPixelYSetBlock) {
+  AccumImageSOA acum(3, 2);
+  EXPECT_EQ(acum.width(), 3);
+  EXPECT_EQ(acum.height(), 2);
+  EXPECT_EQ(acum.samples()[4], 0U);
+  acum.set_pixel(2, 0, 1.5F, 2.5F, 3.5F, 4);
+  std::vector<float> const r{0.5F, 1.0F};
+  std::vector<float> const g{2.0F, 3.0F};
+  std::vector<float> const b{4.0F, 5.0F};
+  std::vector<std::uint32_t> const n{6, 7};
+  acum.set_block(0, 1, 2, 1, 2, r, g, b, n);
+  EXPECT_EQ(acum.r()[2], 1.5F);
+  EXPECT_EQ(acum.b()[2], 3.5F);
+  EXPECT_EQ(acum.samples()[2], 4U);
+  EXPECT_EQ(acum.r()[4], 1.0F);
+  EXPECT_EQ(acum.g()[3], 2.0F);
+  EXPECT_EQ(acum.samples()[4], 7U);
+  EXPECT_THROW(acum.set_pixel(3, 0, 0.0F, 0.0F, 0.0F, 1), std::out_of_range);
+  EXPECT_THROW(acum.set_block(2, 1, 2, 1, 2, r, g, b, n), std::out_of_range);
+  EXPECT_THROW(AccumImageSOA(0, 1), std::invalid_argument);
+}
+
+namespace {
+
+  // Valor de tipo T guardado en little-endian a partir de la posición `pos`
+  template <typename T>
+  T leer_le(std::string const & bytes, std::size_t pos) {
+    std::array<char, sizeof(T)> b{};
+    std::memcpy(b.data(), bytes.data() + pos, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+      std::ranges::reverse(b);
+    }
+    return std::bit_cast<T>(b);
+  }
+
+  // Imagen de 2x2 con sumas de varias muestras y un píxel sin muestras
+  AccumImageSOA acum_prueba() {
+    AccumImageSOA acum(2, 2);
+    acum.set_pixel(0, 0, 1.0F, 2.0F, 3.0F, 2);
+    acum.set_pixel(1, 0, 4.0F, 8.0F, 12.0F, 4);
+    acum.set_pixel(0, 1, 0.5F, 0.25F, 3.0F, 1);
+    return acum;
+  }
+
+}  // namespace
+
+// PFM: cabecera con escala negativa (little-endian) y la media en float de abajo arriba
+TEST(AccumImageSOA, EscribirPFM) {
+  std::ostringstream os;
+  acum_prueba().write(os, ImageFormat::pfm);
+  std::string const bytes    = os.str();
+  std::string const cabecera = "PF\n2 2\n-1.0\n";
+  ASSERT_EQ(bytes.size(), cabecera.size() + 4U * 3U * sizeof(float));
+  EXPECT_EQ(bytes.substr(0, cabecera.size()), cabecera);
+  std::size_t const datos = cabecera.size();
+  // primero la fila de abajo (y = 1)
+  EXPECT_EQ(leer_le<float>(bytes, datos), 0.5F);
+  EXPECT_EQ(leer_le<float>(bytes, datos + 8), 3.0F);
+  EXPECT_EQ(leer_le<float>(bytes, datos + 12), 0.0F);
+  EXPECT_EQ(leer_le<float>(bytes, datos + 24), 0.5F);
+  EXPECT_EQ(leer_le<float>(bytes, datos + 40), 2.0F);
+  EXPECT_EQ(leer_le<float>(bytes, datos + 44), 3.0F);
+}
+
+// OpenEXR: número mágico, versión, tabla de offsets y líneas con los canales B, G y R
+TEST(AccumImageSOA, EscribirEXR) {
+  std::ostringstream os;
+  acum_prueba().write(os, ImageFormat::exr);
+  std::string const bytes = os.str();
+  EXPECT_EQ(leer_le<std::int32_t>(bytes, 0), 20'000'630);
+  EXPECT_EQ(leer_le<std::int32_t>(bytes, 4), 2);
+  EXPECT_NE(bytes.find("channels"), std::string::npos);
+  EXPECT_NE(bytes.find("dataWindow"), std::string::npos);
+  // cada línea: y, tamaño y 2 píxeles x 3 canales en float
+  std::size_t const linea = 8U + 2U * 3U * sizeof(float);
+  std::size_t const tabla = bytes.size() - 2U * linea - 2U * sizeof(std::uint64_t);
+  auto const fila0        = static_cast<std::size_t>(leer_le<std::uint64_t>(bytes, tabla));
+  auto const fila1        = static_cast<std::size_t>(leer_le<std::uint64_t>(bytes, tabla + 8));
+  EXPECT_EQ(fila0, tabla + 16);
+  EXPECT_EQ(fila1, fila0 + linea);
+  EXPECT_EQ(leer_le<std::int32_t>(bytes, fila1), 1);
+  EXPECT_EQ(leer_le<std::int32_t>(bytes, fila1 + 4), 24);
+  // B de los dos píxeles, G y R
+  EXPECT_EQ(leer_le<float>(bytes, fila0 + 8), 1.5F);
+  EXPECT_EQ(leer_le<float>(bytes, fila0 + 12), 3.0F);
+  EXPECT_EQ(leer_le<float>(bytes, fila0 + 20), 2.0F);
+  EXPECT_EQ(leer_le<float>(bytes, fila0 + 24), 0.5F);
+  EXPECT_EQ(leer_le<float>(bytes, fila1 + 16), 0.25F);
+  EXPECT_EQ(leer_le<float>(bytes, fila1 + 12), 0.0F);
+}
+
+// Cada imagen sólo escribe sus formatos: 8 bits en PPM y float en PFM u OpenEXR
+TEST(AccumImageSOA, FormatoEquivocadoLanza) {
+  std::ostringstream os;
+  EXPECT_THROW(acum_prueba().write(os, ImageFormat::p3), std::invalid_argument);
+  EXPECT_THROW(ImageSOA(1, 1).write(os, ImageFormat::pfm), std::invalid_argument);
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <material.hpp>
+#include <memory>
+#include <numa.hpp>
+#include <pixel.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::escena_prueba;
+
+}  // namespace
+
+// Siempre hay al menos un nodo con algún hilo, y con config.threads se reparten esos hilos
+TEST(Numa, NodosConHilos) {
+  Config cfg;
+  std::vector<render::NumaNode> const nodos = render::numa_nodes(cfg);
+  ASSERT_FALSE(nodos.empty());
+  for (render::NumaNode const & nodo : nodos) {
+    EXPECT_GE(nodo.threads, 1);
+  }
+  cfg.threads = 1;
+  for (render::NumaNode const & nodo : render::numa_nodes(cfg)) {
+    EXPECT_EQ(nodo.threads, 1);
+  }
+}
+
+// Las teselas se reparten en tramos consecutivos proporcionales a los hilos de cada nodo
+TEST(Numa, SplitTiles) {
+  std::vector<render::NumaNode> const nodos{
+    {0, 3},
+    {1, 1}
+  };
+  EXPECT_EQ(render::split_tiles(100, nodos), (std::vector<std::size_t>{0, 75, 100}));
+  EXPECT_EQ(render::split_tiles(1, nodos), (std::vector<std::size_t>{0, 0, 1}));
+  std::vector<render::NumaNode> const uno{
+    {-1, 4}
+  };
+  EXPECT_EQ(render::split_tiles(7, uno), (std::vector<std::size_t>{0, 7}));
+}
+
+// Los hilos pedidos se reparten en proporción a los de cada nodo y nunca se pasan del total,
+// aunque haya menos hilos que nodos
+TEST(Numa, SplitThreads) {
+  std::vector<render::NumaNode> const nodos{
+    {0, 8},
+    {1, 8},
+    {2, 8},
+    {3, 8}
+  };
+  for (int const hilos : {1, 2, 3, 4, 6, 32, 40}) {
+    std::vector<render::NumaNode> const reparto = render::split_threads(nodos, hilos);
+    int suma = 0;
+    for (render::NumaNode const & nodo : reparto) {
+      EXPECT_GE(nodo.threads, 1);
+      suma += nodo.threads;
+    }
+    EXPECT_EQ(suma, hilos);
+    EXPECT_EQ(reparto.size(), static_cast<std::size_t>(std::min(hilos, 4)));
+  }
+  std::vector<render::NumaNode> const desiguales{
+    {0, 12},
+    {1, 4}
+  };
+  std::vector<render::NumaNode> const reparto = render::split_threads(desiguales, 8);
+  ASSERT_EQ(reparto.size(), 2U);
+  EXPECT_EQ(reparto[0].threads, 6);
+  EXPECT_EQ(reparto[1].threads, 2);
+}
+
+// El render por nodos da la misma imagen y el mismo trabajo que el normal
+TEST(Numa, MismaImagenQueRenderImageSOA) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 24;
+  cfg.samples_per_pixel = 4;
+  render::Camera cam(cfg);
+  for (int const lado : {1, 4}) {
+    cfg.packet_size = lado;
+    cfg.numa        = false;
+    ImageSOA normal(cam.ancho_imagen, cam.alto_imagen);
+    render::RenderStats stats_normal;
+    (void) render::render_image_soa(escena, cfg, cam, normal, &stats_normal);
+
+    cfg.numa = true;
+    ImageSOA numa(cam.ancho_imagen, cam.alto_imagen);
+    render::RenderStats stats_numa;
+    (void) render::render_image_soa(escena, cfg, cam, numa, &stats_numa);
+    EXPECT_EQ(stats_numa.muestras, stats_normal.muestras);
+    for (int y = 0; y < cam.alto_imagen; ++y) {
+      for (int x = 0; x < cam.ancho_imagen; ++x) {
+        Pixel const p = normal.get_pixel(x, y);
+        Pixel const q = numa.get_pixel(x, y);
+        EXPECT_EQ(p.r, q.r);
+        EXPECT_EQ(p.g, q.g);
+        EXPECT_EQ(p.b, q.b);
+      }
+    }
+  }
+}
@@ -0,0 +1,172 @@
+#include <bit>
+#include <camera.hpp>
+#include <cmath>
+#include <config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <limits>
+#include <material.hpp>
+#include <memory>
+#include <pixel.hpp>
+#include <postprocess.hpp>
+#include <random>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <simd.hpp>
+#include <sphere.hpp>
+#include <stdexcept>
+#include <tone_map.hpp>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  std::vector<render::SimdLevel> supported_levels() {
+    std::vector<render::SimdLevel> levels;
+    for (auto const level :
+         {render::SimdLevel::scalar, render::SimdLevel::avx2, render::SimdLevel::avx512}) {
+      if (render::simd_supported(level)) {
+        levels.push_back(level);
+      }
+    }
+    return levels;
+  }
+
+  // Colores de 0 a 2 y casos límite: cero, negativos, infinito y NaN
+  std::vector<float> colores_prueba(std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0F, 2.0F);
+    std::vector<float> colores{0.0F, -0.0F, -1.0F, 1.0F, std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN(),
+                               std::numeric_limits<float>::denorm_min()};
+    while (colores.size() < n) {
+      float const c = dist(rng);
+      // muchos valores oscuros, donde la gamma cambia de nivel más deprisa
+      colores.push_back(colores.size() % 2 == 0 ? c : c * c * c * c * 0.01F);
+    }
+    return colores;
+  }
+
+}  // namespace
+
+// La tabla de umbrales da el nivel de std::pow en todos los niveles SIMD, también justo en los
+// umbrales y con tamaños que no son múltiplo de la anchura del vector
+TEST(PostProcess, CuantizacionIgualQueReferencia) {
+  for (double const gamma : {2.2, 1.0, 1.8, 0.45}) {
+    Config cfg;
+    cfg.gamma = gamma;
+    std::vector<float> colores = colores_prueba(1'001, 5);
+    // los colores donde cambia cada nivel y los anteriores
+    for (int k = 1; k < 256; ++k) {
+      float desde = 0.0F;
+      float hasta = 1.0F;
+      while (std::nextafter(desde, 1.0F) < hasta) {
+        float const medio = std::bit_cast<float>(
+            (std::bit_cast<std::uint32_t>(desde) + std::bit_cast<std::uint32_t>(hasta)) / 2);
+        (render::PostProcess::quantize_reference(medio, gamma) < k ? desde : hasta) = medio;
+      }
+      colores.push_back(desde);
+      colores.push_back(hasta);
+    }
+    for (auto const level : supported_levels()) {
+      render::PostProcess const post(cfg, level);
+      std::vector<std::uint8_t> niveles(colores.size());
+      post.quantize(colores, niveles);
+      for (std::size_t i = 0; i < colores.size(); ++i) {
+        EXPECT_EQ(niveles[i], render::PostProcess::quantize_reference(colores[i], gamma))
+            << render::simd_level_name(level) << " gamma " << gamma << " color " << colores[i];
+      }
+    }
+  }
+}
+
+// Exposición y tone mapping vectoriales dan los mismos float que los escalares
+TEST(PostProcess, EtapasVectorialesIgualQueEscalar) {
+  std::mt19937_64 rng(17);
+  std::uniform_real_distribution<float> dist(0.0F, 40.0F);
+  std::uniform_int_distribution<std::uint32_t> muestras_dist(0, 64);
+  std::size_t const n = 53;
+  std::vector<float> suma(n);
+  std::vector<std::uint32_t> muestras(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    suma[i]     = dist(rng);
+    muestras[i] = i % 7 == 0 ? 0 : muestras_dist(rng);
+  }
+  for (auto const operador :
+       {render::ToneMap::none, render::ToneMap::reinhard, render::ToneMap::aces}) {
+    for (double const exposicion : {0.0, -1.5, 2.0}) {
+      Config cfg;
+      cfg.tone_map = operador;
+      cfg.exposure = exposicion;
+      render::PostProcess const escalar(cfg, render::SimdLevel::scalar);
+      std::vector<float> esperado(n);
+      escalar.expose(suma, muestras, esperado);
+      escalar.tone_map(esperado);
+      for (auto const level : supported_levels()) {
+        render::PostProcess const post(cfg, level);
+        std::vector<float> color(n);
+        post.expose(suma, muestras, color);
+        post.tone_map(color);
+        for (std::size_t i = 0; i < n; ++i) {
+          EXPECT_EQ(color[i], esperado[i]) << render::simd_level_name(level) << " " << i;
+        }
+      }
+    }
+  }
+}
+
+// Valores conocidos de cada etapa
+TEST(PostProcess, ExposicionYToneMap) {
+  Config cfg;
+  cfg.exposure = 1.0;
+  EXPECT_EQ(render::PostProcess::exposure_scale(cfg), 2.0F);
+  EXPECT_EQ(render::PostProcess::expose_value(6.0F, 3, 2.0F), 4.0F);
+  EXPECT_EQ(render::PostProcess::expose_value(6.0F, 0, 2.0F), 0.0F);
+  EXPECT_EQ(render::PostProcess::tone_map_value(render::ToneMap::none, 3.0F), 3.0F);
+  EXPECT_EQ(render::PostProcess::tone_map_value(render::ToneMap::reinhard, 1.0F), 0.5F);
+  EXPECT_EQ(render::PostProcess::tone_map_value(render::ToneMap::aces, 0.0F), 0.0F);
+  EXPECT_NEAR(render::PostProcess::tone_map_value(render::ToneMap::aces, 1e6F), 2.51F / 2.43F,
+              1e-5F);
+  EXPECT_EQ(render::PostProcess::quantize_reference(1.0F, 2.2), 255);
+  EXPECT_EQ(render::PostProcess::quantize_reference(4.0F, 2.2), 255);
+
+  // una suma de 2 con 4 muestras es 0.5; con un paso de exposición, 1
+  cfg.gamma = 1.0;
+  render::PostProcess const post(cfg);
+  EXPECT_EQ(post.pixel(2.0F, 1.0F, 0.0F, 4), (Pixel{255, 127, 0}));
+  std::vector<float> const corto(3);
+  std::vector<std::uint32_t> const muestras(4);
+  std::vector<float> salida(3);
+  EXPECT_THROW(post.expose(corto, muestras, salida), std::invalid_argument);
+}
+
+// quantize pasa la imagen de acumulación por las etapas vectoriales y da el color de
+// color_pixel con cualquier exposición y operador
+TEST(PostProcess, QuantizeIgualQueColorPixel) {
+  Scene escena;
+  test_helpers::escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 24;
+  cfg.samples_per_pixel = 3;
+  render::Camera cam(cfg);
+  AccumImageSOA acum(cam.ancho_imagen, cam.alto_imagen);
+  render::render_image_accum(escena, cfg, cam, acum);
+  for (auto const operador :
+       {render::ToneMap::none, render::ToneMap::reinhard, render::ToneMap::aces}) {
+    cfg.tone_map = operador;
+    cfg.exposure = operador == render::ToneMap::none ? 0.0 : 1.5;
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    render::quantize(acum, cfg, img);
+    for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+      for (int col = 0; col < cam.ancho_imagen; ++col) {
+        auto const i = static_cast<std::size_t>(fila * cam.ancho_imagen + col);
+        EXPECT_EQ(img.get_pixel(col, fila),
+                  render::color_pixel(acum.r()[i], acum.g()[i], acum.b()[i],
+                                      acum.samples()[i], cfg));
+      }
+    }
+  }
+}
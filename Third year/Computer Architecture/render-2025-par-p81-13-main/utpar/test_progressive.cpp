@@ -0,0 +1,184 @@
+#include <camera.hpp>
+#include <config.hpp>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <material.hpp>
+#include <memory>
+#include <partitioner.hpp>
+#include <pixel.hpp>
+#include <progressive.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector.hpp>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::escena_prueba;
+  using test_helpers::esperar_iguales;
+
+}  // namespace
+
+// Varias pasadas, píxel a píxel o por paquetes y con o sin muestreo adaptativo, dan la misma
+// imagen que un render con todas las muestras
+TEST(Progressive, PasadasIgualQueRenderCompleto) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width          = 20;
+  cfg.samples_per_pixel    = 8;
+  cfg.adaptive_min_samples = 2;
+  render::Camera cam(cfg);
+  for (int const lado : {1, 4}) {
+    for (double const umbral : {0.0, 0.3}) {
+      cfg.packet_size        = lado;
+      cfg.adaptive_threshold = umbral;
+      ImageSOA completa(cam.ancho_imagen, cam.alto_imagen);
+      (void) render::render_image_soa(escena, cfg, cam, completa);
+
+      render::ProgressiveBuffer buffer(cam.ancho_imagen, cam.alto_imagen);
+      render::RenderStats stats;
+      for (int const hasta : {3, 6, 8}) {
+        render::render_progressive_pass(escena, cfg, cam, buffer, hasta, &stats);
+        EXPECT_EQ(buffer.muestras, hasta);
+      }
+      ImageSOA progresiva(cam.ancho_imagen, cam.alto_imagen);
+      buffer.write(cfg, progresiva);
+      esperar_iguales(completa, progresiva);
+      if (umbral == 0.0) {
+        EXPECT_EQ(stats.muestras, 8U * static_cast<unsigned>(cam.ancho_imagen * cam.alto_imagen));
+      }
+    }
+  }
+}
+
+// Con affinity las pasadas comparten el reparto de teselas (TileAffinity) y la imagen sigue
+// siendo la del render completo
+TEST(Progressive, PasadasConAfinidadCompartida) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 20;
+  cfg.samples_per_pixel = 6;
+  cfg.tile_size         = 4;
+  cfg.threads           = 2;
+  cfg.partitioner       = render::Partitioner::affinity;
+  render::Camera cam(cfg);
+  ImageSOA completa(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(escena, cfg, cam, completa);
+
+  render::TileAffinity afinidad;
+  render::ProgressiveBuffer buffer(cam.ancho_imagen, cam.alto_imagen);
+  for (int const hasta : {2, 4, 6}) {
+    EXPECT_TRUE(render::render_progressive_pass(escena, cfg, cam, buffer, hasta, nullptr, nullptr,
+                                                &afinidad));
+  }
+  ImageSOA progresiva(cam.ancho_imagen, cam.alto_imagen);
+  buffer.write(cfg, progresiva);
+  esperar_iguales(completa, progresiva);
+
+  // y también entre renders completos
+  for (int i = 0; i < 2; ++i) {
+    ImageSOA otra(cam.ancho_imagen, cam.alto_imagen);
+    (void) render::render_image_soa(escena, cfg, cam, otra, nullptr, &afinidad);
+    esperar_iguales(completa, otra);
+  }
+}
+
+// Reanudar desde un checkpoint y subir las muestras da lo mismo que no haberse parado
+TEST(Progressive, CheckpointYReanudacion) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 16;
+  cfg.samples_per_pixel = 4;
+  render::Camera cam(cfg);
+  render::ProgressiveBuffer buffer(cam.ancho_imagen, cam.alto_imagen);
+  render::render_progressive_pass(escena, cfg, cam, buffer, 4);
+  std::stringstream checkpoint;
+  render::write_checkpoint(checkpoint, cfg, escena, buffer);
+
+  // otra ejecución: más muestras y otra gamma no invalidan el checkpoint
+  Config mas            = cfg;
+  mas.samples_per_pixel = 10;
+  mas.gamma             = 1.8;
+  render::ProgressiveBuffer reanudado = render::read_checkpoint(checkpoint, mas, escena);
+  EXPECT_EQ(reanudado.muestras, 4);
+  EXPECT_EQ(reanudado.at(3, 5).muestras, 4);
+  EXPECT_EQ(reanudado.at(3, 5).suma.x, buffer.at(3, 5).suma.x);
+  EXPECT_EQ(reanudado.at(3, 5).m2, buffer.at(3, 5).m2);
+  render::render_progressive_pass(escena, mas, cam, reanudado, 10);
+
+  ImageSOA completa(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(escena, mas, cam, completa);
+  ImageSOA progresiva(cam.ancho_imagen, cam.alto_imagen);
+  reanudado.write(mas, progresiva);
+  esperar_iguales(completa, progresiva);
+}
+
+// Una pasada cancelada se deja a medias sin dar por hechas sus muestras; el plazo cancela solo
+TEST(Progressive, PasadaCancelada) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width = 16;
+  render::Camera cam(cfg);
+  render::ProgressiveBuffer buffer(cam.ancho_imagen, cam.alto_imagen);
+  render::CancelToken sin_plazo;
+  EXPECT_TRUE(render::render_progressive_pass(escena, cfg, cam, buffer, 2, nullptr, &sin_plazo));
+  EXPECT_EQ(buffer.muestras, 2);
+
+  render::CancelToken vencido(render::CancelToken::clock::now());
+  EXPECT_TRUE(vencido.cancelled());
+  render::RenderStats stats;
+  EXPECT_FALSE(render::render_progressive_pass(escena, cfg, cam, buffer, 4, &stats, &vencido));
+  EXPECT_EQ(buffer.muestras, 2);
+  EXPECT_EQ(stats.muestras, 0U);
+
+  sin_plazo.cancel();
+  EXPECT_FALSE(render::render_progressive_pass(escena, cfg, cam, buffer, 4, &stats, &sin_plazo));
+  EXPECT_EQ(buffer.at(0, 0).muestras, 2);
+}
+
+// Un checkpoint de otro render (otro config u otra escena), dañado o cortado no se carga
+TEST(Progressive, CheckpointInvalido) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width = 8;
+  render::Camera cam(cfg);
+  render::ProgressiveBuffer const buffer(cam.ancho_imagen, cam.alto_imagen);
+  std::stringstream checkpoint;
+  render::write_checkpoint(checkpoint, cfg, escena, buffer);
+  std::string const bytes = checkpoint.str();
+  std::istringstream valido(bytes);
+  EXPECT_NO_THROW((void) render::read_checkpoint(valido, cfg, escena));
+
+  Config otra_semilla       = cfg;
+  otra_semilla.ray_rng_seed = 7;
+  std::istringstream a(bytes);
+  EXPECT_THROW((void) render::read_checkpoint(a, otra_semilla, escena), std::runtime_error);
+
+  // la misma escena con un objeto movido o un material cambiado es otro render
+  Scene movida;
+  escena_prueba(movida);
+  movida.objects[1]->center.x = 5.5;
+  std::istringstream b(bytes);
+  EXPECT_THROW((void) render::read_checkpoint(b, cfg, movida), std::runtime_error);
+  Scene otro_material;
+  escena_prueba(otro_material);
+  otro_material.materials["metal"] =
+      std::make_unique<Metal>("metal", render::vector{0.8, 0.8, 0.9}, 0.4);
+  std::istringstream c(bytes);
+  EXPECT_THROW((void) render::read_checkpoint(c, cfg, otro_material), std::runtime_error);
+
+  std::istringstream cortado(bytes.substr(0, bytes.size() - 1));
+  EXPECT_THROW((void) render::read_checkpoint(cortado, cfg, escena), std::runtime_error);
+
+  std::istringstream otro_fichero("P3\n8 4\n255\n");
+  EXPECT_THROW((void) render::read_checkpoint(otro_fichero, cfg, escena), std::runtime_error);
+}
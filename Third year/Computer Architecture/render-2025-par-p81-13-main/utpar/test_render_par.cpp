@@ -1,15 +1,37 @@
+#include <accelerator.hpp>
 #include <algorithm>
+#include <array>
 #include <camera.hpp>
+#include <chrono>
 #include <cmath>
 #include <config.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <gtest/gtest.h>
 #include <image_par.hpp>  // Usamos ImageSOA
+#include <material.hpp>
+#include <memory>
+#include <partitioner.hpp>
 #include <pixel.hpp>
-#include <random>
 #include <ray.hpp>
 #include <render-par.hpp>  // Incluimos render-soa.hpp
+#include <sampler.hpp>
 #include <scene.hpp>
+#include <set>
+#include <sphere.hpp>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector.hpp>
+#include <vector>
+#include <wavefront.hpp>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/global_control.h>
+#include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/task_arena.h>
+#include "test_helpers.hpp"
 
 // Comprueba que el constructor de RenderContext inicializa los punteros correctamente.
 TEST(RenderSOA, RenderContextConstructorInitializesPointers) {
@@ -17,10 +39,7 @@ TEST(RenderSOA, RenderContextConstructorInitializesPointers) {
   Config const cfg;
   render::Camera camara(cfg);
   ImageSOA img(1, 1);
-  std::mt19937_64 rgen(123);
-  std::mt19937_64 mgen(456);
-
-  render::RenderContext const ctx{escena, cfg, camara, img, rgen, mgen};
+  render::RenderContext const ctx{escena, cfg, camara, img};
 
   // Los miembros públicos usados en el código son 'escena' y 'config'
   EXPECT_EQ(ctx.escena, &escena);
@@ -35,9 +54,7 @@ TEST(RenderSOA, SoaCalcularColor_DepthZeroReturnsBlack) {
   Config const cfg;
   render::Camera camara(cfg);
   ImageSOA img(1, 1);
-  std::mt19937_64 rgen(1);
-  std::mt19937_64 mgen(2);
-  render::RenderContext ctx{escena, cfg, camara, img, rgen, mgen};
+  render::RenderContext ctx{escena, cfg, camara, img};
 
   render::ray r;
   r.direction = render::vector{0.0, 0.0, 1.0};
@@ -58,9 +75,7 @@ TEST(RenderSOA, SoaCalcularColor_NoIntersectionReturnsBackground) {
 
   render::Camera camara(cfg);
   ImageSOA img(1, 1);
-  std::mt19937_64 rgen(11);
-  std::mt19937_64 mgen(22);
-  render::RenderContext ctx{escena, cfg, camara, img, rgen, mgen};
+  render::RenderContext ctx{escena, cfg, camara, img};
 
   render::ray r;
   r.direction = render::vector{0.0, 1.0, 0.0};  // apunta hacia arriba
@@ -181,3 +196,418 @@ TEST(RenderSOA, SoaCalcularFondo_NormalizesDirection) {
   EXPECT_DOUBLE_EQ(a.y, b.y);
   EXPECT_DOUBLE_EQ(a.z, b.z);
 }
+
+// Un paquete de píxeles da la misma imagen que sus píxeles uno a uno: los números aleatorios
+// sólo dependen del píxel y la muestra, no del orden en que se sombrean las muestras
+TEST(RenderSOA, CalcularPaqueteIgualQuePixelAPixel) {
+  Scene escena;
+  escena.materials["vidrio"] = std::make_unique<Refractive>("vidrio", 1.5);
+  escena.materials["mate"]   = std::make_unique<Matte>("mate", render::vector{0.5, 0.7, 0.3});
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 4.0, "vidrio"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{-5.0, 0.0, 2.0}, 2.0, "mate"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{5.0, 2.0, 3.0}, 2.0, "vidrio"));
+  escena.build_bvh();
+  escena.accelerator = render::Accelerator::bvh2;
+  Config cfg;
+  cfg.image_width       = 16;
+  cfg.samples_per_pixel = 4;
+  cfg.max_depth         = 3;
+  render::Camera cam(cfg);
+  ASSERT_EQ(cam.alto_imagen, 9);
+
+  // paquete completo y paquete recortado por el borde inferior de la imagen
+  for (auto [lado, fila0, col0] : {std::array{4, 0, 4}, std::array{8, 8, 8}}) {
+    cfg.packet_size = lado;
+    ImageSOA por_paquete(cam.ancho_imagen, cam.alto_imagen);
+    ImageSOA por_pixel(cam.ancho_imagen, cam.alto_imagen);
+    render::RenderContext ctx_a{escena, cfg, cam, por_paquete};
+    render::RenderContext ctx_b{escena, cfg, cam, por_pixel};
+    render::calcular_paquete_soa(fila0, col0, ctx_a);
+    int const fila_fin = std::min(fila0 + lado, cam.alto_imagen);
+    int const col_fin  = std::min(col0 + lado, cam.ancho_imagen);
+    for (int fila = fila0; fila < fila_fin; ++fila) {
+      for (int col = col0; col < col_fin; ++col) {
+        render::calcular_pixel_soa(fila, col, ctx_b);
+      }
+    }
+    for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+      for (int col = 0; col < cam.ancho_imagen; ++col) {
+        Pixel const a = por_paquete.get_pixel(col, fila);
+        Pixel const b = por_pixel.get_pixel(col, fila);
+        EXPECT_EQ(a.r, b.r);
+        EXPECT_EQ(a.g, b.g);
+        EXPECT_EQ(a.b, b.b);
+      }
+    }
+  }
+}
+
+// El render por paquetes cubre también los píxeles de los bordes
+TEST(RenderSOA, RenderImageSOA_PaquetesCubrenLaImagen) {
+  Scene const escena;
+  Config cfg;
+  cfg.image_width       = 10;
+  cfg.samples_per_pixel = 1;
+  cfg.packet_size       = 4;
+  render::Camera cam(cfg);
+  ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(escena, cfg, cam, img);
+  for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+    for (int col = 0; col < cam.ancho_imagen; ++col) {
+      // el fondo nunca es negro
+      Pixel const p = img.get_pixel(col, fila);
+      EXPECT_GT(p.r + p.g + p.b, 0);
+    }
+  }
+}
+
+// Sin ruleta rusa, o antes de la profundidad configurada, el camino siempre sigue
+TEST(RenderSOA, RuletaRusa_SoloDesdeLaProfundidadConfigurada) {
+  Config cfg;
+  render::Sampler rng(render::SamplerKind::random, 3, 0, 0);
+  render::vector t{0.0, 0.0, 0.0};
+  EXPECT_TRUE(render::sobrevive_ruleta_rusa(t, 10, cfg, rng));
+  cfg.russian_roulette_depth = 2;
+  EXPECT_TRUE(render::sobrevive_ruleta_rusa(t, 1, cfg, rng));
+  // sin reflectancia acumulada el camino termina siempre
+  EXPECT_FALSE(render::sobrevive_ruleta_rusa(t, 2, cfg, rng));
+  // con reflectancia 1 sigue siempre y no cambia el throughput
+  t = render::vector{1.0, 0.2, 0.2};
+  EXPECT_TRUE(render::sobrevive_ruleta_rusa(t, 5, cfg, rng));
+  EXPECT_DOUBLE_EQ(t.x, 1.0);
+  EXPECT_DOUBLE_EQ(t.y, 0.2);
+}
+
+// La ruleta rusa reduce los rebotes por muestra sin cambiar el color medio (estimador sin sesgo)
+TEST(RenderSOA, RuletaRusa_MenosRebotesMismaMedia) {
+  Scene escena;
+  escena.materials["gris"] = std::make_unique<Matte>("gris", render::vector{0.5, 0.5, 0.5});
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, 0.0, 0.0}, 2.0, "gris"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, -102.0, 0.0}, 100.0, "gris"));
+  escena.build_bvh();
+  Config cfg;
+  cfg.max_depth = 30;
+  render::Camera cam(cfg);
+  ImageSOA img(1, 1);
+  constexpr int muestras = 40'000;
+  auto media = [&](int profundidad_ruleta, std::uint64_t & rebotes) {
+    cfg.russian_roulette_depth = profundidad_ruleta;
+    render::RenderContext ctx{escena, cfg, cam, img};
+    render::ray const r(render::vector{0.0, 0.0, -10.0}, render::vector{0.0, -0.25, 1.0});
+    render::vector suma{0.0, 0.0, 0.0};
+    for (int i = 0; i < muestras; ++i) {
+      ctx.empezar_muestra(0, static_cast<std::uint32_t>(i));
+      suma = render::vector::add(suma, render::soa_calcular_color(r, cfg.max_depth, ctx));
+    }
+    rebotes = ctx.rebotes;
+    return render::vector::divd(suma, muestras);
+  };
+  std::uint64_t rebotes_sin = 0;
+  std::uint64_t rebotes_con = 0;
+  render::vector const sin_ruleta = media(0, rebotes_sin);
+  render::vector const con_ruleta = media(1, rebotes_con);
+  EXPECT_LT(rebotes_con, rebotes_sin);
+  EXPECT_NEAR(con_ruleta.x, sin_ruleta.x, 0.03 * sin_ruleta.x);
+  EXPECT_NEAR(con_ruleta.z, sin_ruleta.z, 0.03 * sin_ruleta.z);
+}
+
+// La imagen no depende del número de hilos, del tamaño de paquete ni del motor, con cualquier
+// muestreador y con muestreo adaptativo
+TEST(RenderSOA, RenderImageSOA_DeterministaConCualquierNumeroDeHilos) {
+  // la escena de prueba con una esfera de vidrio más, para los tres materiales
+  Scene escena;
+  test_helpers::montar_escena_prueba(escena);
+  escena.materials["vidrio"] = std::make_unique<Refractive>("vidrio", 1.5);
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{-5.0, 1.0, 2.0}, 2.0, "vidrio"));
+  escena.build_bvh();
+  Config cfg;
+  cfg.image_width       = 24;
+  cfg.samples_per_pixel = 4;
+  cfg.max_depth            = 6;
+  cfg.adaptive_min_samples = 2;
+  render::Camera cam(cfg);
+  auto render_con = [&](int hilos, int lado, bool wavefront) {
+    Config c      = cfg;
+    c.packet_size = lado;
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    oneapi::tbb::task_arena arena(hilos);
+    arena.execute([&] {
+      if (wavefront) {
+        (void) render::render_image_wavefront(escena, c, cam, img);
+      } else {
+        (void) render::render_image_soa(escena, c, cam, img);
+      }
+    });
+    return img;
+  };
+  for (auto const & [muestreador, umbral] :
+       {std::pair{render::SamplerKind::random, 0.0}, std::pair{render::SamplerKind::sobol, 0.0},
+        std::pair{render::SamplerKind::random, 0.3}}) {
+    cfg.sampler               = muestreador;
+    cfg.adaptive_threshold    = umbral;
+    ImageSOA const referencia = render_con(1, 1, false);
+    for (ImageSOA const & img : {render_con(4, 1, false), render_con(3, 4, false),
+                                 render_con(1, 1, true), render_con(4, 1, true)}) {
+      for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+        for (int col = 0; col < cam.ancho_imagen; ++col) {
+          Pixel const a = referencia.get_pixel(col, fila);
+          Pixel const b = img.get_pixel(col, fila);
+          EXPECT_EQ(a.r, b.r);
+          EXPECT_EQ(a.g, b.g);
+          EXPECT_EQ(a.b, b.b);
+        }
+      }
+    }
+  }
+}
+
+// Las estadísticas de Welford dan la media y la varianza de la luminancia; sin umbral el píxel
+// nunca se da por terminado
+TEST(RenderSOA, EstadisticasPixel_MediaYVarianza) {
+  render::EstadisticasPixel est;
+  for (double const l : {0.1, 0.4, 0.2, 0.9, 0.4}) {
+    est.anadir(render::vector{l, l, l});
+  }
+  EXPECT_EQ(est.muestras, 5);
+  EXPECT_DOUBLE_EQ(est.suma.x, 2.0);
+  EXPECT_NEAR(est.media, 0.4, 1e-12);
+  // varianza muestral 0.095
+  EXPECT_NEAR(est.m2 / 4.0, 0.095, 1e-12);
+  Config cfg;
+  EXPECT_FALSE(est.convergido(cfg));
+  // semianchura 1.96 * sqrt(0.095 / 5) = 0.27, un 67.5 % de la media
+  cfg.adaptive_threshold = 0.7;
+  EXPECT_TRUE(est.convergido(cfg));
+  cfg.adaptive_threshold = 0.6;
+  EXPECT_FALSE(est.convergido(cfg));
+}
+
+// Con muestreo adaptativo los píxeles del fondo paran tras la primera pasada y la imagen es
+// casi la misma que con todas las muestras
+TEST(RenderSOA, MuestreoAdaptativo_MenosMuestrasMismaImagen) {
+  Scene escena;
+  test_helpers::escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 32;
+  cfg.samples_per_pixel = 64;
+  render::Camera cam(cfg);
+  auto const pixeles = static_cast<std::uint64_t>(cam.ancho_imagen * cam.alto_imagen);
+  ImageSOA completa(cam.ancho_imagen, cam.alto_imagen);
+  render::RenderStats stats_completa;
+  (void) render::render_image_soa(escena, cfg, cam, completa, &stats_completa);
+  EXPECT_EQ(stats_completa.muestras, pixeles * 64);
+
+  cfg.adaptive_threshold = 0.05;
+  ImageSOA adaptativa(cam.ancho_imagen, cam.alto_imagen);
+  render::RenderStats stats_adaptativa;
+  (void) render::render_image_soa(escena, cfg, cam, adaptativa, &stats_adaptativa);
+  EXPECT_GE(stats_adaptativa.muestras, pixeles * 8);
+  EXPECT_LT(stats_adaptativa.muestras, stats_completa.muestras / 3);
+  double diferencia = 0.0;
+  for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+    for (int col = 0; col < cam.ancho_imagen; ++col) {
+      Pixel const a  = completa.get_pixel(col, fila);
+      Pixel const b  = adaptativa.get_pixel(col, fila);
+      diferencia    += std::abs(a.r - b.r) + std::abs(a.g - b.g) + std::abs(a.b - b.b);
+    }
+  }
+  EXPECT_LT(diferencia / (3.0 * static_cast<double>(pixeles)), 2.0);
+}
+
+// Las teselas cubren la imagen una vez, recortadas en los bordes, y siguen la curva Z
+TEST(RenderSOA, MortonTiles_CubrenLaImagenEnOrdenZ) {
+  std::vector<render::Tile> const teselas = render::morton_tiles(10, 7, 4);
+  ASSERT_EQ(teselas.size(), 6U);
+  std::vector<int> cubierto(70, 0);
+  for (render::Tile const & t : teselas) {
+    for (int f = t.fila0; f < t.fila0 + t.filas; ++f) {
+      for (int c = t.col0; c < t.col0 + t.cols; ++c) {
+        cubierto.at(static_cast<std::size_t>(f * 10 + c))++;
+      }
+    }
+  }
+  EXPECT_TRUE(std::ranges::all_of(cubierto, [](int n) { return n == 1; }));
+  // (0,0), (1,0), (0,1), (1,1) en la rejilla de teselas y después la columna 2
+  std::vector<std::pair<int, int>> esquinas;
+  for (render::Tile const & t : teselas) {
+    esquinas.emplace_back(t.col0, t.fila0);
+  }
+  std::vector<std::pair<int, int>> const esperado{
+    {0, 0}, {4, 0}, {0, 4}, {4, 4}, {8, 0}, {8, 4}
+  };
+  EXPECT_EQ(esquinas, esperado);
+  EXPECT_EQ(teselas.back().cols, 2);
+  EXPECT_EQ(teselas.back().filas, 3);
+}
+
+// El arena de un reparto se reutiliza mientras no cambien los hilos; si cambian, el arena y el
+// reparto son nuevos
+TEST(RenderSOA, TileAffinity_ConservaArenaYReparto) {
+  render::TileAffinity afinidad;
+  oneapi::tbb::task_arena const * const arena             = &afinidad.arena(0, 2);
+  oneapi::tbb::affinity_partitioner const * const reparto = &afinidad.reparto(0);
+  EXPECT_EQ(arena->max_concurrency(), 2);
+  EXPECT_EQ(&afinidad.arena(0, 2), arena);
+  EXPECT_EQ(&afinidad.reparto(0), reparto);
+  EXPECT_NE(&afinidad.reparto(1), reparto);
+  EXPECT_EQ(&afinidad.reparto(0), reparto);
+
+  EXPECT_EQ(afinidad.arena(0, 3).max_concurrency(), 3);
+  EXPECT_NE(&afinidad.reparto(0), reparto);
+}
+
+// Con affinity y el mismo TileAffinity, un segundo parallel_for_tiles da a cada hilo las
+// teselas que calculó en el primero
+TEST(RenderSOA, ParallelForTiles_AfinidadRepiteElReparto) {
+  // hilos trabajadores aunque la máquina tenga menos núcleos
+  oneapi::tbb::global_control const limite(oneapi::tbb::global_control::max_allowed_parallelism,
+                                           4);
+  Config cfg;
+  cfg.threads             = 4;
+  cfg.partitioner         = render::Partitioner::affinity;
+  constexpr std::size_t n = 64;
+  render::TileAffinity afinidad;
+  auto hilo_de_cada_tesela = [&] {
+    std::vector<std::thread::id> hilo(n);
+    render::parallel_for_tiles(
+        n, cfg,
+        [&](oneapi::tbb::blocked_range<std::size_t> const & r) {
+          for (std::size_t i = r.begin(); i != r.end(); ++i) {
+            hilo[i] = std::this_thread::get_id();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+          }
+        },
+        &afinidad);
+    return hilo;
+  };
+  // la primera vez los hilos trabajadores aún se están uniendo al arena
+  (void) hilo_de_cada_tesela();
+  std::vector<std::thread::id> const primero = hilo_de_cada_tesela();
+  std::vector<std::thread::id> const segundo = hilo_de_cada_tesela();
+  EXPECT_GT(std::set<std::thread::id>(primero.begin(), primero.end()).size(), 1U);
+  std::size_t repetidas = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    repetidas += primero[i] == segundo[i] ? 1U : 0U;
+  }
+  // el robo de tareas puede mover alguna
+  EXPECT_GE(repetidas, n * 3 / 4);
+}
+
+// El lado de las teselas, el particionador y los hilos no cambian la imagen
+TEST(RenderSOA, RenderImageSOA_IgualConCualquierTesela) {
+  Scene escena;
+  test_helpers::escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 30;
+  cfg.samples_per_pixel = 2;
+  render::Camera cam(cfg);
+  ImageSOA referencia(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(escena, cfg, cam, referencia);
+  using render::Partitioner;
+  for (auto const & [lado, paquete, particionador] :
+       {std::tuple{1, 1, Partitioner::simple}, std::tuple{3, 1, Partitioner::automatic},
+        std::tuple{16, 4, Partitioner::affinity}, std::tuple{5, 4, Partitioner::simple}}) {
+    Config c      = cfg;
+    c.tile_size   = lado;
+    c.packet_size = paquete;
+    c.partitioner = particionador;
+    c.threads     = 3;
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    (void) render::render_image_soa(escena, c, cam, img);
+    for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+      for (int col = 0; col < cam.ancho_imagen; ++col) {
+        EXPECT_EQ(referencia.get_pixel(col, fila), img.get_pixel(col, fila));
+      }
+    }
+  }
+}
+
+// La imagen de acumulación guarda la suma lineal y las muestras de cada píxel; cuantizarla da la
+// imagen de render_image_soa y cada píxel el color de color_pixel
+TEST(RenderSOA, RenderImageAccum_QuantizeIgualQueRenderImageSOA) {
+  Scene escena;
+  test_helpers::escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 20;
+  cfg.samples_per_pixel = 3;
+  render::Camera cam(cfg);
+  ImageSOA referencia(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(escena, cfg, cam, referencia);
+
+  AccumImageSOA acum(cam.ancho_imagen, cam.alto_imagen);
+  render::render_image_accum(escena, cfg, cam, acum);
+  ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+  render::quantize(acum, cfg, img);
+  for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+    for (int col = 0; col < cam.ancho_imagen; ++col) {
+      auto const i = static_cast<std::size_t>(fila * cam.ancho_imagen + col);
+      EXPECT_EQ(acum.samples()[i], 3U);
+      EXPECT_EQ(img.get_pixel(col, fila), referencia.get_pixel(col, fila));
+      EXPECT_EQ(img.get_pixel(col, fila),
+                render::color_pixel(acum.r()[i], acum.g()[i], acum.b()[i], 3, cfg));
+    }
+  }
+  ImageSOA pequena(cam.ancho_imagen - 1, cam.alto_imagen);
+  EXPECT_THROW(render::quantize(acum, cfg, pequena), std::out_of_range);
+  AccumImageSOA otra(cam.ancho_imagen + 1, cam.alto_imagen);
+  EXPECT_THROW(render::render_image_accum(escena, cfg, cam, otra), std::invalid_argument);
+}
+
+// Una escena montada a mano sin build_bvh se renderiza igual que con la escena reconstruida
+// (los materiales no se pierden en el recorrido lineal) y no se modifica
+TEST(RenderSOA, EscenaSinBuildBvhIgualQueConstruida) {
+  Scene construida;
+  test_helpers::escena_prueba(construida);
+  Scene sin_construir;
+  test_helpers::montar_escena_prueba(sin_construir);
+  Config cfg;
+  cfg.image_width       = 20;
+  cfg.samples_per_pixel = 2;
+  render::Camera cam(cfg);
+  ImageSOA referencia(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(construida, cfg, cam, referencia);
+  ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(sin_construir, cfg, cam, img);
+  ImageSOA wavefront(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_wavefront(sin_construir, cfg, cam, wavefront);
+  EXPECT_FALSE(sin_construir.up_to_date());
+  EXPECT_TRUE(sin_construir.material_table.empty());
+  // las esferas se ven (ni fondo ni negro)
+  Scene const vacia;
+  ImageSOA fondo(cam.ancho_imagen, cam.alto_imagen);
+  (void) render::render_image_soa(vacia, cfg, cam, fondo);
+  int con_color = 0;
+  for (int fila = 0; fila < cam.alto_imagen; ++fila) {
+    for (int col = 0; col < cam.ancho_imagen; ++col) {
+      Pixel const p = img.get_pixel(col, fila);
+      EXPECT_EQ(p, referencia.get_pixel(col, fila));
+      EXPECT_EQ(wavefront.get_pixel(col, fila), referencia.get_pixel(col, fila));
+      if (p != fondo.get_pixel(col, fila) and p.r + p.g + p.b > 0) {
+        ++con_color;
+      }
+    }
+  }
+  EXPECT_GT(con_color, 0);
+}
+
+// El desplazamiento de anti-aliasing de una muestra es siempre el mismo, con cualquier
+// biblioteca estándar
+TEST(RenderSOA, DesplazamientoMuestraValoresConocidos) {
+  Config cfg;
+  cfg.ray_rng_seed = 19;
+  double u         = 0.0;
+  double v         = 0.0;
+  render::desplazamiento_muestra(5, 2, cfg, u, v);
+  EXPECT_EQ(u, 0x1.cc1c5a51921f8p-3);
+  EXPECT_EQ(v, 0x1.839ce8c81f7b4p-2);
+  cfg.sampler = render::SamplerKind::sobol;
+  render::desplazamiento_muestra(5, 2, cfg, u, v);
+  EXPECT_EQ(u, 0x1.fee055acea9fap-2);
+  EXPECT_EQ(v, -0x1.c1c4cc6f4413p-4);
+}
@@ -0,0 +1,91 @@
+#include <camera.hpp>
+#include <config.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <iterator>
+#include <material.hpp>
+#include <memory>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <stream.hpp>
+#include <string>
+#include <vector.hpp>
+#include <vector>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::escena_prueba;
+  using test_helpers::FicheroTemporal;
+
+  std::string leer_fichero(std::filesystem::path const & path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  }
+
+}  // namespace
+
+// El fichero escrito en streaming es el mismo P6 que el de la imagen completa, también con una
+// cola de una sola franja y teselas que no dividen la imagen
+TEST(Stream, IgualQueRenderImageSOAEnP6) {
+  Scene escena;
+  escena_prueba(escena);
+  Config cfg;
+  cfg.image_width       = 30;
+  cfg.samples_per_pixel = 2;
+  render::Camera cam(cfg);
+  FicheroTemporal const fichero(".ppm");
+  for (int const lado : {1, 4}) {
+    cfg.packet_size = lado;
+    cfg.tile_size   = 8;
+    ImageSOA img(cam.ancho_imagen, cam.alto_imagen);
+    render::RenderStats stats_img;
+    (void) render::render_image_soa(escena, cfg, cam, img, &stats_img);
+    std::ostringstream p6;
+    img.write_ppm_p6(p6);
+
+    render::RenderStats stats;
+    {
+      render::P6StreamWriter salida(fichero.path().string(), cam.ancho_imagen, cam.alto_imagen,
+                                    1);
+      render::render_image_stream(escena, cfg, cam, salida, &stats);
+      salida.finish();
+    }
+    EXPECT_EQ(leer_fichero(fichero.path()), p6.str());
+    EXPECT_EQ(stats.muestras, stats_img.muestras);
+  }
+}
+
+// Las franjas se escriben en su posición aunque lleguen desordenadas
+TEST(Stream, FranjasDesordenadas) {
+  FicheroTemporal const fichero(".ppm");
+  {
+    render::P6StreamWriter salida(fichero.path().string(), 1, 3);
+    salida.push(render::RowBand{2, 1, {7, 8, 9}});
+    salida.push(render::RowBand{0, 2, {1, 2, 3, 4, 5, 6}});
+    salida.finish();
+  }
+  EXPECT_EQ(leer_fichero(fichero.path()),
+            std::string("P6\n1 3\n255\n\x01\x02\x03\x04\x05\x06\x07\x08\x09"));
+}
+
+// Una franja fuera de la imagen o de otro ancho no se encola
+TEST(Stream, FranjaInvalida) {
+  FicheroTemporal const fichero(".ppm");
+  {
+    render::P6StreamWriter salida(fichero.path().string(), 2, 2);
+    EXPECT_THROW(salida.push(render::RowBand{1, 2, std::vector<unsigned char>(12)}),
+                 std::invalid_argument);
+    EXPECT_THROW(salida.push(render::RowBand{0, 1, std::vector<unsigned char>(3)}),
+                 std::invalid_argument);
+    salida.finish();
+  }
+  // el fichero ya escrito no es un directorio, así que nada puede crearse dentro de él
+  EXPECT_THROW(render::P6StreamWriter((fichero.path() / "existe.ppm").string(), 2, 2),
+               std::runtime_error);
+}
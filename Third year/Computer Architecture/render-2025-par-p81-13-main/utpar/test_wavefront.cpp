@@ -0,0 +1,119 @@
+#include <camera.hpp>
+#include <config.hpp>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <image_par.hpp>
+#include <material.hpp>
+#include <memory>
+#include <pixel.hpp>
+#include <render-par.hpp>
+#include <scene.hpp>
+#include <sphere.hpp>
+#include <stdexcept>
+#include <vector.hpp>
+#include <wavefront.hpp>
+#include "test_helpers.hpp"
+
+namespace {
+
+  using test_helpers::esperar_iguales;
+
+}  // namespace
+
+// Nombres de motor válidos e inválidos
+TEST(Wavefront, ParseEngine) {
+  EXPECT_EQ(render::parse_engine("recursive"), render::Engine::recursive);
+  EXPECT_EQ(render::parse_engine("wavefront"), render::Engine::wavefront);
+  EXPECT_THROW((void) render::parse_engine("gpu"), std::invalid_argument);
+}
+
+// Todas las componentes de la cola cambian de tamaño a la vez
+TEST(Wavefront, PathQueueResize) {
+  render::PathQueue q;
+  q.resize(10);
+  EXPECT_EQ(q.size(), 10U);
+  EXPECT_EQ(q.ox.size(), 10U);
+  EXPECT_EQ(q.tb.size(), 10U);
+}
+
+// Sin objetos cada píxel es el fondo, idéntico al del motor recursivo
+TEST(Wavefront, SinObjetosIgualQueRecursivo) {
+  Scene const escena;
+  Config cfg;
+  cfg.image_width       = 16;
+  cfg.samples_per_pixel = 4;
+  render::Camera cam(cfg);
+  ImageSOA wf(cam.ancho_imagen, cam.alto_imagen);
+  ImageSOA rec(cam.ancho_imagen, cam.alto_imagen);
+  render::render_image_wavefront(escena, cfg, cam, wf);
+  render::render_image_soa(escena, cfg, cam, rec);
+  esperar_iguales(wf, rec);
+}
+
+// Con rebotes difusos y especulares hasta la profundidad máxima la imagen es idéntica a la del
+// motor recursivo: ambos consumen los mismos números aleatorios por píxel, muestra y rebote
+TEST(Wavefront, RebotesIgualQueRecursivo) {
+  Scene escena;
+  escena.materials["mate"]  = std::make_unique<Matte>("mate", render::vector{0.7, 0.5, 0.3});
+  escena.materials["metal"] = std::make_unique<Metal>("metal", render::vector{0.9, 0.9, 0.9}, 0.2);
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{-2.0, 0.0, 0.0}, 3.0, "mate"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{3.0, 0.0, 1.0}, 2.5, "metal"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, -104.0, 0.0}, 100.0, "mate"));
+  escena.build_bvh();
+  Config cfg;
+  cfg.image_width       = 24;
+  cfg.samples_per_pixel = 16;
+  render::Camera cam(cfg);
+  ImageSOA wf(cam.ancho_imagen, cam.alto_imagen);
+  ImageSOA rec(cam.ancho_imagen, cam.alto_imagen);
+  render::render_image_wavefront(escena, cfg, cam, wf);
+  render::render_image_soa(escena, cfg, cam, rec);
+  esperar_iguales(wf, rec);
+}
+
+// El sombreado impacto a impacto da la misma imagen y los mismos rebotes que el agrupado por
+// material, también con ruleta rusa
+TEST(Wavefront, SombreadoPorImpactoIgualQueAgrupado) {
+  Scene escena;
+  escena.materials["mate"]   = std::make_unique<Matte>("mate", render::vector{0.7, 0.5, 0.3});
+  escena.materials["metal"] =
+      std::make_unique<Metal>("metal", render::vector{0.9, 0.9, 0.9}, 0.2);
+  escena.materials["vidrio"] = std::make_unique<Refractive>("vidrio", 1.5);
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{-2.0, 0.0, 0.0}, 3.0, "mate"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{3.0, 0.0, 1.0}, 2.5, "metal"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.5, 1.0, -3.0}, 1.0, "vidrio"));
+  escena.objects.push_back(
+      std::make_unique<render::Sphere>(render::vector{0.0, -104.0, 0.0}, 100.0, "mate"));
+  escena.build_bvh();
+  Config cfg;
+  cfg.image_width            = 24;
+  cfg.samples_per_pixel      = 8;
+  cfg.russian_roulette_depth = 2;
+  render::Camera cam(cfg);
+  ImageSOA agrupado(cam.ancho_imagen, cam.alto_imagen);
+  ImageSOA por_impacto(cam.ancho_imagen, cam.alto_imagen);
+  render::RenderStats stats_agrupado;
+  render::RenderStats stats_por_impacto;
+  render::render_image_wavefront(escena, cfg, cam, agrupado, &stats_agrupado);
+  render::render_image_wavefront(escena, cfg, cam, por_impacto, &stats_por_impacto,
+                                 render::Shading::per_hit);
+  esperar_iguales(agrupado, por_impacto);
+  EXPECT_EQ(stats_agrupado.rebotes.load(), stats_por_impacto.rebotes.load());
+  EXPECT_GT(stats_agrupado.rebotes.load(), 0U);
+}
+
+// Igual que render_image_soa, una imagen más pequeña que la cámara es un error
+TEST(Wavefront, ImagenPequenaLanza) {
+  Scene const escena;
+  Config cfg;
+  cfg.image_width = 4;
+  render::Camera cam(cfg);
+  ImageSOA img(1, 1);
+  EXPECT_ANY_THROW(render::render_image_wavefront(escena, cfg, cam, img));
+}